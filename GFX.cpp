@@ -4,6 +4,7 @@
 #include <cstring>
 #include <string.h>
 #include <circle/logger.h>
+#include "GFXSimd.h"
 
 LOGMODULE("CircleGFX");
 
@@ -48,6 +49,43 @@ static const char *s_texFS =
     "varying vec2 vUV;\n"
     "void main() { gl_FragColor = texture2D(uTex, vUV); }\n";
 
+// SDF glyph shader  (used by drawSdfChar): linear ramp around the 0.5 edge,
+// uGain = field units per screen pixel.  Reuses the textured-quad VS.
+static const char *s_sdfFS =
+    "precision mediump float;\n"
+    "uniform sampler2D uTex;\n"
+    "uniform vec4 uColor;\n"
+    "uniform float uGain;\n"
+    "varying vec2 vUV;\n"
+    "void main() {\n"
+    "    float d = texture2D(uTex, vUV).r - 128.0 / 255.0;\n"
+    "    gl_FragColor = vec4(uColor.rgb, uColor.a * clamp(d * uGain + 0.5, 0.0, 1.0));\n"
+    "}\n";
+
+// Particle shader  (used by drawParticles): one point per particle, tinted
+// by its vertex colour and optionally shaped by the brush texture.
+static const char *s_partVS =
+    "attribute vec2 aPos;\n"
+    "attribute vec4 aColor;\n"
+    "uniform mat4 uMVP;\n"
+    "uniform float uSize;\n"
+    "varying vec4 vColor;\n"
+    "void main() {\n"
+    "    vColor = aColor;\n"
+    "    gl_PointSize = uSize;\n"
+    "    gl_Position = uMVP * vec4(aPos, 0.0, 1.0);\n"
+    "}\n";
+
+static const char *s_partFS =
+    "precision mediump float;\n"
+    "uniform sampler2D uTex;\n"
+    "uniform float uBrush;\n"
+    "varying vec4 vColor;\n"
+    "void main() {\n"
+    "    float a = mix(1.0, texture2D(uTex, gl_PointCoord).a, uBrush);\n"
+    "    gl_FragColor = vec4(vColor.rgb, vColor.a * a);\n"
+    "}\n";
+
 // ─── ortho projection helper ─────────────────────────────────────────────────
 // Builds a column-major 4×4 orthographic matrix that maps pixel coordinates
 // (0,0) top-left → (width,height) bottom-right to NDC [-1..1].
@@ -65,13 +103,26 @@ CircleGFX::CircleGFX(CEglRenderingContext *pContext)
         m_shaderFlat(0), m_uFlatColor(0), m_uFlatMVP(0), m_vboQuad(0),
         m_shaderTex(0),  m_uTexMVP(0),    m_uTexSampler(0),
         m_scratchTex(0), m_scratchW(0),   m_scratchH(0),
+        m_shaderSdf(0),  m_uSdfMVP(0),    m_uSdfColor(0), m_uSdfGain(0), m_sdfTex(0),
+        m_shaderPart(0), m_uPartMVP(0),   m_uPartSize(0), m_uPartBrush(0), m_aPartColor(0),
+        m_vboPart(0),    m_partTex(0),    m_pPartBrush(nullptr), m_partBrushW(0), m_partBrushH(0),
+        m_pPartVerts(nullptr), m_partVertsSize(0),
         m_width(0), m_height(0),
         m_cursorX(0), m_cursorY(0),
         m_textColor(0xFFFF), m_textBgColor(0x0000),
         m_textSizeX(1), m_textSizeY(1),
-        m_textWrap(true), m_rotation(0),
+        m_textWrap(true), m_textOpaque(false), m_textDir(GFX_TEXT_RIGHT), m_textStyle(GFX_TEXT_PLAIN),
+        m_textStyleColor(0), m_textStyleA(0), m_textStyleB(0), m_rotation(0),
         m_inverted(false), m_inTransaction(false),
-        m_pFont(nullptr), m_fontSizeMultiplied(true) {
+        m_pFont(nullptr), m_fontSizeMultiplied(true),
+        m_monoAdvance(6), m_monoDetected(6), m_monoAscent(0),
+        m_pSdfFont(nullptr), m_sdfSize(0),
+        m_pTarget(nullptr), m_clip(), m_userClip(), m_userClipSet(false),
+        m_pScratch(nullptr), m_scratchSize(0), m_shadowTick(0), m_glyphTick(0),
+        m_damageEnabled(false), m_damage(), m_pending(), m_pendingValid(false),
+        m_repairing(false) {
+    memset(m_shadowCache, 0, sizeof(m_shadowCache));
+    memset(m_glyphCache, 0, sizeof(m_glyphCache));
     if (!m_pGLContext) {
         //LOGE("OpenGL context is null");
         return;
@@ -80,6 +131,7 @@ CircleGFX::CircleGFX(CEglRenderingContext *pContext)
     // Ask libgraphics for the display dimensions
     m_width  = (int16_t)m_pGLContext->GetWidth();
     m_height = (int16_t)m_pGLContext->GetHeight();
+    _resetClip();
 
     initGLResources();
 
@@ -99,7 +151,14 @@ CircleGFX::CircleGFX(CEglRenderingContext *pContext)
 }
 
 CircleGFX::~CircleGFX() {
+    _freeEffects();
     if (m_scratchTex) glDeleteTextures(1, &m_scratchTex);
+    if (m_sdfTex)     glDeleteTextures(1, &m_sdfTex);
+    if (m_shaderSdf)  glDeleteProgram(m_shaderSdf);
+    if (m_partTex)    glDeleteTextures(1, &m_partTex);
+    if (m_vboPart)    glDeleteBuffers(1, &m_vboPart);
+    if (m_shaderPart) glDeleteProgram(m_shaderPart);
+    free(m_pPartVerts);
     if (m_vboQuad)    glDeleteBuffers(1, &m_vboQuad);
     if (m_shaderFlat) glDeleteProgram(m_shaderFlat);
     if (m_shaderTex)  glDeleteProgram(m_shaderTex);
@@ -186,6 +245,28 @@ void CircleGFX::initGLResources() {
     m_uTexMVP     = glGetUniformLocation(m_shaderTex, "uMVP");
     m_uTexSampler = glGetUniformLocation(m_shaderTex, "uTex");
 
+    // ── SDF glyph program ────────────────────────────────────────────────────
+    vs = compileShader(GL_VERTEX_SHADER,   s_texVS);
+    fs = compileShader(GL_FRAGMENT_SHADER, s_sdfFS);
+    m_shaderSdf   = linkProgram(vs, fs);
+    if (m_shaderSdf) {
+        m_uSdfMVP   = glGetUniformLocation(m_shaderSdf, "uMVP");
+        m_uSdfColor = glGetUniformLocation(m_shaderSdf, "uColor");
+        m_uSdfGain  = glGetUniformLocation(m_shaderSdf, "uGain");
+    }
+
+    // ── Particle program ─────────────────────────────────────────────────────
+    vs = compileShader(GL_VERTEX_SHADER,   s_partVS);
+    fs = compileShader(GL_FRAGMENT_SHADER, s_partFS);
+    m_shaderPart  = linkProgram(vs, fs);
+    if (m_shaderPart) {
+        m_uPartMVP   = glGetUniformLocation(m_shaderPart, "uMVP");
+        m_uPartSize  = glGetUniformLocation(m_shaderPart, "uSize");
+        m_uPartBrush = glGetUniformLocation(m_shaderPart, "uBrush");
+        m_aPartColor = glGetAttribLocation (m_shaderPart, "aColor");
+        glGenBuffers(1, &m_vboPart);
+    }
+
     // ── Unit quad VBO (x,y,u,v) ──────────────────────────────────────────────
     // Two triangles forming a quad.  Actual positions are set per draw call
     // via the uniform MVP, so this is just a unit square [0..1].
@@ -264,6 +345,18 @@ void CircleGFX::drawGLRect(int16_t x, int16_t y, int16_t w, int16_t h,
     checkGLError("drawGLRect");
 }
 
+// ─── _glClip: scissor GL draws to m_clip ─────────────────────────────────────
+// For draws whose extent is not clipped on the CPU.  GL counts scissor rows
+// from the bottom of the viewport.
+void CircleGFX::_glClip(boolean on) {
+    if (!on) {
+        glDisable(GL_SCISSOR_TEST);
+        return;
+    }
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(m_clip.x, m_height - (m_clip.y + m_clip.h), m_clip.w, m_clip.h);
+}
+
 // ─── uploadAndDrawTex: GPU-accelerated RGB565 bitmap blit ────────────────────
 void CircleGFX::uploadAndDrawTex(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *pixels) {
     if (!pixels || w <= 0 || h <= 0 || !m_shaderTex) return;
@@ -343,6 +436,7 @@ static void rgb565ToFloat(uint16_t color, float &r, float &g, float &b) {
 }
 
 void CircleGFX::setPixel(int16_t x, int16_t y, uint16_t color) {
+    if (m_pTarget) { m_pTarget->setPixel(x, y, color); return; }
     if (x < 0 || x >= m_width || y < 0 || y >= m_height) return;
     float r, g, b;
     rgb565ToFloat(color, r, g, b);
@@ -350,20 +444,163 @@ void CircleGFX::setPixel(int16_t x, int16_t y, uint16_t color) {
 }
 
 uint16_t CircleGFX::getPixel(int16_t x, int16_t y) const {
+    if (m_pTarget) return m_pTarget->getPixel(x, y);
     // Reading back from GLES framebuffer is expensive; return 0 as a stub.
     (void)x; (void)y;
     return 0;
 }
 
+// ─── drawGLSdf: GPU SDF glyph ────────────────────────────────────────────────
+// The field is uploaded as a luminance texture and filtered linearly, so the
+// GPU does the resampling; the shader only turns distance into alpha.
+void CircleGFX::drawGLSdf(float x, float y, float w, float h,
+                          const uint8_t *field, int16_t fw, int16_t fh,
+                          uint16_t color, float gain) {
+    if (!field || fw <= 0 || fh <= 0 || !m_shaderSdf) return;
+
+    if (!m_sdfTex) glGenTextures(1, &m_sdfTex);
+    glBindTexture(GL_TEXTURE_2D, m_sdfTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, fw, fh, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, field);
+
+    float ortho[16];
+    buildOrtho(ortho, (float)m_width, (float)m_height);
+    float model[16] = {
+        w, 0, 0, 0,
+        0, h, 0, 0,
+        0, 0, 1, 0,
+        x, y, 0, 1
+    };
+    float mvp[16];
+    for (int col = 0; col < 4; col++)
+        for (int row = 0; row < 4; row++) {
+            mvp[col*4+row] = 0;
+            for (int k = 0; k < 4; k++)
+                mvp[col*4+row] += ortho[k*4+row] * model[col*4+k];
+        }
+
+    float r, g, b;
+    rgb565ToFloat(color, r, g, b);
+    glUseProgram(m_shaderSdf);
+    glUniformMatrix4fv(m_uSdfMVP, 1, GL_FALSE, mvp);
+    glUniform4f(m_uSdfColor, r, g, b, 1.f);
+    glUniform1f(m_uSdfGain, gain);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vboQuad);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4*sizeof(float), (void*)(2*sizeof(float)));
+
+    _glClip(true);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    _glClip(false);
+
+    glDisableVertexAttribArray(0);
+    glDisableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    checkGLError("drawGLSdf");
+}
+
+// ─── drawGLParticles: all particles in one streamed GL_POINTS draw ───────────
+// Vertices are 12 bytes: pixel-centre position as two floats, then the
+// faded colour as normalised RGBA bytes.
+void CircleGFX::drawGLParticles(const GFXParticles &particles, GFXblitMode mode, uint8_t alpha) {
+    uint32_t n = particles.count();
+    if (!n || !m_shaderPart || !m_vboPart) return;
+    if (n * 12 > m_partVertsSize) {
+        uint8_t *p = (uint8_t *)realloc(m_pPartVerts, n * 12);
+        if (!p) return;
+        m_pPartVerts    = p;
+        m_partVertsSize = n * 12;
+    }
+
+    const int32_t  *px  = particles.getX(), *py = particles.getY();
+    const uint16_t *col = particles.getColor();
+    const float     k   = 1.f / (1 << GFX_PARTICLE_FRAC);
+    uint8_t *v = m_pPartVerts;
+    for (uint32_t i = 0; i < n; i++, v += 12) {
+        float    fx = px[i] * k + 0.5f, fy = py[i] * k + 0.5f;
+        uint16_t c  = col[i];
+        memcpy(v,     &fx, 4);
+        memcpy(v + 4, &fy, 4);
+        v[8]  = (uint8_t)(((c >> 11) * 527 + 23) >> 6);
+        v[9]  = (uint8_t)((((c >> 5) & 0x3F) * 259 + 33) >> 6);
+        v[10] = (uint8_t)(((c & 0x1F) * 527 + 23) >> 6);
+        v[11] = (uint8_t)((alpha * particles.getFade(i)) >> 8);
+    }
+
+    uint8_t bw, bh;
+    const uint8_t *pBrush = particles.getBrush(&bw, &bh);
+    if (pBrush) {
+        if (!m_partTex) glGenTextures(1, &m_partTex);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_partTex);
+        if (pBrush != m_pPartBrush || bw != m_partBrushW || bh != m_partBrushH) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, bw, bh, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pBrush);
+            m_pPartBrush = pBrush;
+            m_partBrushW = bw;
+            m_partBrushH = bh;
+        }
+    }
+
+    float ortho[16];
+    buildOrtho(ortho, (float)m_width, (float)m_height);
+    glUseProgram(m_shaderPart);
+    glUniformMatrix4fv(m_uPartMVP, 1, GL_FALSE, ortho);
+    glUniform1f(m_uPartSize, pBrush ? (float)MAX(bw, bh) : 1.f);
+    glUniform1f(m_uPartBrush, pBrush ? 1.f : 0.f);
+    if (mode == GFX_BLIT_ADD) glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vboPart);
+    glBufferData(GL_ARRAY_BUFFER, n * 12, m_pPartVerts, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 12, (void*)0);
+    glEnableVertexAttribArray(m_aPartColor);
+    glVertexAttribPointer(m_aPartColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, 12, (void*)8);
+
+    _glClip(true);
+    glDrawArrays(GL_POINTS, 0, n);
+    _glClip(false);
+
+    glDisableVertexAttribArray(0);
+    glDisableVertexAttribArray(m_aPartColor);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(0);
+    checkGLError("drawGLParticles");
+}
+
 // ─── Accelerated overrides ───────────────────────────────────────────────────
 
 void CircleGFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
-    // Clamp to screen
-    if (x < 0) { w += x; x = 0; }
-    if (y < 0) { h += y; y = 0; }
-    if (x + w > m_width)  w = m_width  - x;
-    if (y + h > m_height) h = m_height - y;
+    // Clamp to the drawable area
+    if (x < m_clip.x) { w -= m_clip.x - x; x = m_clip.x; }
+    if (y < m_clip.y) { h -= m_clip.y - y; y = m_clip.y; }
+    if (x + w > m_clip.x + m_clip.w) w = m_clip.x + m_clip.w - x;
+    if (y + h > m_clip.y + m_clip.h) h = m_clip.y + m_clip.h - y;
     if (w <= 0 || h <= 0) return;
+    _touch(x, y, w, h);
+
+    if (m_pTarget) {
+        for (int16_t j = y; j < y + h; j++)
+            for (int16_t i = x; i < x + w; i++)
+                m_pTarget->setPixel(i, j, color);
+        return;
+    }
 
     float r, g, b;
     rgb565ToFloat(color, r, g, b);
@@ -371,6 +608,7 @@ void CircleGFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16
 }
 
 void CircleGFX::fillScreen(uint16_t color) {
+    if (m_pTarget) { m_pTarget->fillScreen(color); return; }
     float r, g, b;
     rgb565ToFloat(color, r, g, b);
     glClearColor(r, g, b, 1.f);
@@ -380,11 +618,17 @@ void CircleGFX::fillScreen(uint16_t color) {
 }
 
 void CircleGFX::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h) {
+    if (m_pTarget) {
+        for (int16_t j = 0; j < h; j++)
+            for (int16_t i = 0; i < w; i++)
+                writePixel(x + i, y + j, bitmap[j * w + i]);
+        return;
+    }
     uploadAndDrawTex(x, y, w, h, bitmap);
 }
 
 void CircleGFX::drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h) {
-    uploadAndDrawTex(x, y, w, h, bitmap);
+    drawRGBBitmap(x, y, (const uint16_t *)bitmap, w, h);
 }
 
 // ─── All remaining methods are identical to the framebuffer back-end ─────────
@@ -401,9 +645,19 @@ CircleGFX::CircleGFX(CScreenDevice *pScreen)
         m_cursorX(0), m_cursorY(0),
         m_textColor(0xFFFF), m_textBgColor(0x0000),
         m_textSizeX(1), m_textSizeY(1),
-        m_textWrap(true), m_rotation(0),
+        m_textWrap(true), m_textOpaque(false), m_textDir(GFX_TEXT_RIGHT), m_textStyle(GFX_TEXT_PLAIN),
+        m_textStyleColor(0), m_textStyleA(0), m_textStyleB(0), m_rotation(0),
         m_inverted(false), m_inTransaction(false),
-        m_pFont(nullptr), m_fontSizeMultiplied(true) {
+        m_pFont(nullptr), m_fontSizeMultiplied(true),
+        m_monoAdvance(6), m_monoDetected(6), m_monoAscent(0),
+        m_pSdfFont(nullptr), m_sdfSize(0),
+        m_pTarget(nullptr), m_clip(), m_userClip(), m_userClipSet(false),
+        m_pScratch(nullptr), m_scratchSize(0), m_shadowTick(0), m_glyphTick(0),
+        m_damageEnabled(false), m_damage(), m_pending(), m_pendingValid(false),
+        m_repairing(false) {
+    memset(m_shadowCache, 0, sizeof(m_shadowCache));
+    memset(m_glyphCache, 0, sizeof(m_glyphCache));
+    _initializeMultiBuffer();
     if (!m_pScreen) return;
     m_pFrameBuffer = m_pScreen->GetFrameBuffer();
     if (!m_pFrameBuffer) return;
@@ -413,16 +667,23 @@ CircleGFX::CircleGFX(CScreenDevice *pScreen)
     m_height = (int16_t)m_pFrameBuffer->GetHeight();
     m_pitch  = m_pFrameBuffer->GetPitch();
     m_pBuffer= (uint16_t *)m_pFrameBuffer->GetBuffer();
+    m_buffers[0].pData = m_pBuffer;
+    _resetClip();
 }
 
-CircleGFX::~CircleGFX() {}
+CircleGFX::~CircleGFX() {
+    _cleanupMultiBuffer();
+    _freeEffects();
+}
 
 void CircleGFX::setPixel(int16_t x, int16_t y, uint16_t color) {
+    if (m_pTarget) { m_pTarget->setPixel(x, y, color); return; }
     if (x < 0 || x >= m_width || y < 0 || y >= m_height || !m_pBuffer) return;
     m_pBuffer[y * (m_pitch / 2) + x] = color;
 }
 
 uint16_t CircleGFX::getPixel(int16_t x, int16_t y) const {
+    if (m_pTarget) return m_pTarget->getPixel(x, y);
     if (x < 0 || x >= m_width || y < 0 || y >= m_height || !m_pBuffer) return 0;
     return m_pBuffer[y * (m_pitch / 2) + x];
 }
@@ -433,7 +694,7 @@ void CircleGFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16
 }
 
 void CircleGFX::fillScreen(uint16_t color) {
-    fillRect(0, 0, m_width, m_height, color);
+    fillRect(0, 0, width(), height(), color);
 }
 
 void CircleGFX::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h) {
@@ -459,7 +720,7 @@ void CircleGFX::drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w,
 // ═════════════════════════════════════════════════════════════════════════════
 
 void CircleGFX::startWrite(void) { m_inTransaction = true;  }
-void CircleGFX::endWrite  (void) { m_inTransaction = false; }
+void CircleGFX::endWrite  (void) { m_inTransaction = false; _flushPending(); }
 
 void CircleGFX::drawPixel(int16_t x, int16_t y, uint16_t color) {
     startWrite();
@@ -468,7 +729,9 @@ void CircleGFX::drawPixel(int16_t x, int16_t y, uint16_t color) {
 }
 
 void CircleGFX::writePixel(int16_t x, int16_t y, uint16_t color) {
-    if (x < 0 || x >= m_width || y < 0 || y >= m_height) return;
+    if (x < m_clip.x || x >= m_clip.x + m_clip.w ||
+        y < m_clip.y || y >= m_clip.y + m_clip.h) return;
+    _touch(x, y, 1, 1);
     setPixel(x, y, color);
 }
 
@@ -477,10 +740,12 @@ void CircleGFX::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
 }
 
 void CircleGFX::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
-    if (y < 0 || y >= m_height) return;
-    int16_t xs = MAX(0, x);
-    int16_t xe = MIN((int16_t)m_width, (int16_t)(x + w));
-    for (int16_t i = xs; i < xe; i++) writePixel(i, y, color);
+    if (y < m_clip.y || y >= m_clip.y + m_clip.h) return;
+    int16_t xs = MAX(m_clip.x, x);
+    int16_t xe = MIN((int16_t)(m_clip.x + m_clip.w), (int16_t)(x + w));
+    if (xs >= xe) return;
+    _touch(xs, y, xe - xs, 1);
+    for (int16_t i = xs; i < xe; i++) setPixel(i, y, color);
 }
 
 void CircleGFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
@@ -627,11 +892,10 @@ void CircleGFX::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int
         if (a > b) SWAP(a,b);
         writeFastHLine(a, y, b-a+1, color);
     }
-    sa = (int32_t)dx12*(y1-y0) - (int32_t)dy12*(x1-x0);  // misuse sa as new accumulator
-    sb = (int32_t)dx02*(y1-y0);
-    // Reset sa for lower half
+    // Lower half (empty for a flat-bottomed triangle, which would divide by dy12 = 0)
     sa = 0;
-    for (int16_t y=y1; y<=y2; y++) {
+    sb = (int32_t)dx02*(y1-y0);
+    for (int16_t y=last+1; y<=y2; y++) {
         int16_t a = x1 + sa/dy12;
         int16_t b = x0 + sb/dy02;
         sa += dx12; sb += dx02;
@@ -816,9 +1080,20 @@ static const uint8_t s_font[] = {
 };
 
 void CircleGFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y) {
-    if (!m_pFont) {
+    if (!m_pFont && m_textDir != GFX_TEXT_RIGHT) {
+        // Rotated classic cell: opaque background, then the cached glyph
+        if (c < 32 || c > 126) c = '?';
+        if (!size_x) size_x = 1;
+        if (!size_y) size_y = 1;
+        const GFXcachedGlyph *g = _cachedGlyph(nullptr, c, size_x, size_y, m_textDir);
+        if (!g) return;
+        startWrite();
+        writeFillRect(x + g->xOffset, y + g->yOffset, g->w, g->h, bg);
+        endWrite();
+        _drawCachedGlyph(*g, x, y, color);
+    } else if (!m_pFont) {
         // Default 5×8 bitmap font
-        if ((x >= m_width) || (y >= m_height) ||
+        if ((x >= width()) || (y >= height()) ||
             ((x + 6 * size_x - 1) < 0) || ((y + 8 * size_y - 1) < 0))
             return;
         if (c < 32 || c > 126) c = '?';
@@ -842,29 +1117,8 @@ void CircleGFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
         }
         endWrite();
     } else {
-        // Custom GFXfont
-        if (c < m_pFont->first || c > m_pFont->last) return;
-        uint8_t ci = c - m_pFont->first;
-        const GFXglyph *glyph = &m_pFont->glyph[ci];
-        const uint8_t  *bits  =  m_pFont->bitmap + glyph->bitmapOffset;
-        int16_t gx = x + glyph->xOffset;
-        int16_t gy = y + glyph->yOffset;
-        int16_t gw = glyph->width, gh = glyph->height;
-        uint8_t bit = 0, bits8 = 0;
-        startWrite();
-        for (int16_t gy2 = 0; gy2 < gh; gy2++) {
-            for (int16_t gx2 = 0; gx2 < gw; gx2++) {
-                if (!(bit++ & 7)) bits8 = *bits++;
-                if (bits8 & 0x80) {
-                    if (size_x == 1 && size_y == 1)
-                        writePixel(gx+gx2, gy+gy2, color);
-                    else
-                        writeFillRect(gx+gx2*size_x, gy+gy2*size_y, size_x, size_y, color);
-                }
-                bits8 <<= 1;
-            }
-        }
-        endWrite();
+        // Custom GFXfont (transparent background)
+        drawGlyph(x, y, c, color, size_x, size_y);
     }
 }
 
@@ -872,128 +1126,4623 @@ void CircleGFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
     drawChar(x, y, c, color, bg, size, size); 
 }
 
+// ─── SDF text ────────────────────────────────────────────────────────────────
+// The field is resampled bilinearly to the requested size (a vertical lerp of
+// two field rows, then a horizontal gather), and the distance is turned into
+// coverage with a linear ramp one destination pixel wide around the edge.
+
+void CircleGFX::setSdfFont(const GFXsdfFont *f, uint16_t sizePx) {
+    m_pSdfFont = f;
+    m_sdfSize  = sizePx;
+}
+
+static inline int16_t sdfScaled(int32_t v, uint16_t sizePx, uint8_t base) {
+    return (int16_t)((v * sizePx + (v >= 0 ? base / 2 : -(base / 2))) / base);
+}
+
+int16_t CircleGFX::drawSdfChar(int16_t x, int16_t y, unsigned char c,
+                               uint16_t color, uint16_t sizePx) {
+    const GFXsdfFont *f = m_pSdfFont;
+    if (!f || c < f->first || c > f->last || !f->size) return 0;
+    if (!sizePx) sizePx = f->size;
+    const GFXsdfGlyph *g = &f->glyph[c - f->first];
+    int16_t adv = sdfScaled(g->xAdvance, sizePx, f->size);
+    if (!g->width || !g->height) return adv;
+
+    // Field box on screen, 16.16; inv = field samples per screen pixel
+    int32_t bx  = (int32_t)x * 65536 + (int32_t)((int64_t)g->xOffset * 65536 * sizePx / f->size);
+    int32_t by  = (int32_t)y * 65536 + (int32_t)((int64_t)g->yOffset * 65536 * sizePx / f->size);
+    int32_t inv = (int32_t)(((uint32_t)f->size << 16) / sizePx);
+    GFXrect r;
+    r.x = (int16_t)(bx >> 16);
+    r.y = (int16_t)(by >> 16);
+    r.w = (int16_t)(((bx + (int32_t)(((int64_t)g->width  << 16) * sizePx / f->size) + 0xFFFF) >> 16) - r.x);
+    r.h = (int16_t)(((by + (int32_t)(((int64_t)g->height << 16) * sizePx / f->size) + 0xFFFF) >> 16) - r.y);
+    GFXrect box = r;
+    GFXsurface dst = getDrawSurface();
+
+    if (!dst.pData) {
+#ifdef GFX_USE_OPENGL_ES
+        drawGLSdf(bx / 65536.f, by / 65536.f,
+                  g->width * (float)sizePx / f->size, g->height * (float)sizePx / f->size,
+                  f->sdf + g->sdfOffset, g->width, g->height, color,
+                  255.f / 127.f * f->spread * sizePx / f->size);
+#endif
+        return adv;
+    }
+    if (!GFXrectIntersect(box, m_clip, &r)) return adv;
+
+    // Coverage = 128 + d * K, K = spread * scale * 256 / 127 in 8.8.  The
+    // distance is clamped so d * K/2 always fits a 16-bit lane.
+    int32_t K88 = (int32_t)(((int64_t)f->spread * sizePx << 16) / (127 * f->size));
+    if (K88 > 32000) K88 = 32000;
+    if (K88 < 1)     K88 = 1;
+    int16_t   lim = (int16_t)MIN(128, 33024 / K88 + 1);
+    gfx_s16x8 k2  = (gfx_s16x8){ 0, 0, 0, 0, 0, 0, 0, 0 } + (int16_t)(K88 >> 1);
+
+    // Scratch: per-column sample index and fraction, one lerped field row,
+    // one resampled destination row
+    int16_t gw = g->width, gh = g->height;
+    uint8_t *mem = (uint8_t *)_effectScratch((size_t)r.w * 5 + (size_t)(gw + r.w) * 2 + 32);
+    if (!mem) return adv;
+    int16_t *ix   = (int16_t *)mem;
+    int16_t *vrow = ix + r.w;
+    int16_t *frow = vrow + r.w + 8;
+    uint8_t *fx   = (uint8_t *)(frow + gw + 8);
+
+    // Field coordinate of a pixel centre: (p + 0.5 - b) * inv - 0.5, clamped
+    // to the field; fractions are 7-bit so products stay in 16 bits.
+    for (int16_t i = 0; i < r.w; i++) {
+        int32_t u = (int32_t)(((int64_t)(r.x + i) * 65536 + 0x8000 - bx) * inv >> 16) - 0x8000;
+        u = MAX(0, MIN(u, ((int32_t)gw - 1) << 16));
+        ix[i] = (int16_t)(u >> 16);
+        fx[i] = (uint8_t)((u >> 9) & 0x7F);
+    }
+
+    const uint8_t *field = f->sdf + g->sdfOffset;
+    gfx_u16x8 cv = gfxSplat8(color);
+    for (int16_t j = 0; j < r.h; j++) {
+        int32_t v = (int32_t)(((int64_t)(r.y + j) * 65536 + 0x8000 - by) * inv >> 16) - 0x8000;
+        v = MAX(0, MIN(v, ((int32_t)gh - 1) << 16));
+        int16_t        y0 = (int16_t)(v >> 16);
+        int16_t        fy = (int16_t)((v >> 9) & 0x7F);
+        const uint8_t *r0 = field + (int32_t)y0 * gw;
+        const uint8_t *r1 = (y0 + 1 < gh) ? r0 + gw : r0;
+
+        // Vertical lerp of the two field rows
+        int16_t k = 0;
+        gfx_s16x8 fyv = (gfx_s16x8){ 0, 0, 0, 0, 0, 0, 0, 0 } + fy;
+        for (; k + 8 <= gw; k += 8) {
+            gfx_s16x8 a = gfxLoadU8x8(r0 + k), b = gfxLoadU8x8(r1 + k);
+            gfx_s16x8 l = a + (((b - a) * fyv) >> 7);
+            memcpy(frow + k, &l, sizeof(l));
+        }
+        for (; k < gw; k++) frow[k] = (int16_t)(r0[k] + (((r1[k] - r0[k]) * fy) >> 7));
+
+        // Horizontal gather
+        for (int16_t i = 0; i < r.w; i++) {
+            int16_t a = frow[ix[i]], b = frow[ix[i] + (ix[i] + 1 < gw)];
+            vrow[i] = (int16_t)(a + (((b - a) * fx[i]) >> 7));
+        }
+
+        // Coverage and blend, 8 pixels at a time
+        uint16_t *d = dst.pData + (int32_t)(r.y + j) * dst.stride + r.x;
+        int16_t   i = 0;
+        for (; i + 8 <= r.w; i += 8) {
+            gfx_s16x8 dv;
+            memcpy(&dv, vrow + i, sizeof(dv));
+            dv = gfxClamp8(dv - 128, (int16_t)-lim, lim);
+            gfx_s16x8 a = gfxClamp8(((dv * k2) >> 7) + 128, 0, 256);
+            gfxStore8(d + i, gfxBlend565x8(gfxLoad8(d + i), cv, (gfx_u16x8)a));
+        }
+        for (; i < r.w; i++) {
+            int32_t dd = MAX(-lim, MIN(lim, vrow[i] - 128));
+            int32_t a  = MAX(0, MIN(256, ((dd * (K88 >> 1)) >> 7) + 128));
+            d[i] = gfxBlend565(d[i], color, (uint16_t)a);
+        }
+    }
+    addDamage(r.x, r.y, r.w, r.h);
+    return adv;
+}
+
+// Next codepoint of a UTF-8 string.  A byte that does not start a valid
+// sequence is returned on its own, as Latin-1.
+static uint32_t utf8Next(const char *&p) {
+    const uint8_t *s = (const uint8_t *)p;
+    uint32_t c = s[0];
+    int      n = 0;
+    if      (c >= 0xC2 && c < 0xE0) n = 1;
+    else if ((c & 0xF0) == 0xE0)    n = 2;
+    else if (c >= 0xF0 && c < 0xF5) n = 3;
+    uint32_t cp = n ? c & (0x3Fu >> n) : c;
+    for (int k = 1; k <= n; k++) {
+        if ((s[k] & 0xC0) != 0x80) { n = 0; cp = c; break; }
+        cp = (cp << 6) | (s[k] & 0x3F);
+    }
+    p += n + 1;
+    return cp;
+}
+
 void CircleGFX::writeText(const char *text) {
+    if (m_pSdfFont) {
+        const GFXsdfFont *f = m_pSdfFont;
+        uint16_t size  = m_sdfSize ? m_sdfSize : f->size;
+        int16_t  lineH = sdfScaled(f->yAdvance, size, f->size);
+        while (*text) {
+            uint32_t c = utf8Next(text);
+            if (c == '\n') {
+                m_cursorX  = 0;
+                m_cursorY += lineH;
+            } else if (c != '\r' && c >= f->first && c <= f->last && c <= 0xFF) {
+                int16_t adv = sdfScaled(f->glyph[c - f->first].xAdvance, size, f->size);
+                if (m_textWrap && m_cursorX + adv > width()) {
+                    m_cursorX  = 0;
+                    m_cursorY += lineH;
+                }
+                m_cursorX += drawSdfChar(m_cursorX, m_cursorY, (unsigned char)c, m_textColor, size);
+            }
+        }
+        return;
+    }
+    if (m_monoAdvance && m_textDir == GFX_TEXT_RIGHT && m_textStyle == GFX_TEXT_PLAIN &&
+        getDrawSurface().pData) {
+        _writeMono(text);
+        return;
+    }
+    // Sizes apply in glyph space: the advance and line height are rotated
+    // along with the glyphs
+    int16_t lineH = m_textSizeY * (m_pFont ? m_pFont->yAdvance : 8);
     while (*text) {
-        char c = *text++;
+        uint32_t c = utf8Next(text);
         if (c == '\n') {
-            m_cursorX  = 0;
-            m_cursorY += m_textSizeY * (m_pFont ? m_pFont->yAdvance : 8);
+            _newLine(lineH);
         } else if (c != '\r') {
-            int16_t adv = m_pFont ? m_pFont->glyph[c - m_pFont->first].xAdvance : 6;
-            if (m_textWrap && (m_cursorX + m_textSizeX * adv > m_width)) {
-                m_cursorX  = 0;
-                m_cursorY += m_textSizeY * (m_pFont ? m_pFont->yAdvance : 8);
-            }
-            drawChar(m_cursorX, m_cursorY, c, m_textColor, m_textBgColor, m_textSizeX, m_textSizeY);
-            m_cursorX += m_textSizeX * adv;
+            int16_t adv = m_textSizeX * (m_monoAdvance ? m_monoAdvance : _glyphAdvance(m_pFont, c));
+            if (m_textWrap && _wrapNeeded(adv)) _newLine(lineH);
+            if (m_pFont && m_textOpaque) _fillTextCell(adv, lineH);
+            if (m_pFont)
+                drawGlyph(m_cursorX, m_cursorY, c, m_textColor, m_textSizeX, m_textSizeY);
+            else
+                drawChar(m_cursorX, m_cursorY, c > 0xFF ? '?' : (unsigned char)c,
+                         m_textColor, m_textBgColor, m_textSizeX, m_textSizeY);
+            _advanceCursor(adv);
+        }
+    }
+}
+
+// Opaque GFXfont text: the cell from the tallest ascender down one line,
+// rotated with the text direction
+void CircleGFX::_fillTextCell(int16_t adv, int16_t lineH) {
+    int16_t asc = m_monoAscent * m_textSizeY, x = m_cursorX, y = m_cursorY;
+    switch (m_textDir) {
+        case GFX_TEXT_DOWN: fillRect(x - lineH + asc + 1, y, lineH, adv, m_textBgColor); break;
+        case GFX_TEXT_LEFT: fillRect(x - adv + 1, y - lineH + asc + 1, adv, lineH, m_textBgColor); break;
+        case GFX_TEXT_UP:   fillRect(x - asc, y - adv + 1, lineH, adv, m_textBgColor); break;
+        default:            fillRect(x, y - asc, adv, lineH, m_textBgColor); break;
+    }
+}
+
+// Pen movement for the current text direction
+void CircleGFX::_advanceCursor(int16_t adv) {
+    switch (m_textDir) {
+        case GFX_TEXT_DOWN: m_cursorY += adv; break;
+        case GFX_TEXT_LEFT: m_cursorX -= adv; break;
+        case GFX_TEXT_UP:   m_cursorY -= adv; break;
+        default:            m_cursorX += adv; break;
+    }
+}
+
+void CircleGFX::_newLine(int16_t lineH) {
+    switch (m_textDir) {
+        case GFX_TEXT_DOWN: m_cursorY = 0;        m_cursorX -= lineH; break;
+        case GFX_TEXT_LEFT: m_cursorX = width();  m_cursorY -= lineH; break;
+        case GFX_TEXT_UP:   m_cursorY = height(); m_cursorX += lineH; break;
+        default:            m_cursorX = 0;        m_cursorY += lineH; break;
+    }
+}
+
+boolean CircleGFX::_wrapNeeded(int16_t adv) const {
+    switch (m_textDir) {
+        case GFX_TEXT_DOWN: return m_cursorY + adv > height();
+        case GFX_TEXT_LEFT: return m_cursorX - adv < 0;
+        case GFX_TEXT_UP:   return m_cursorY - adv < 0;
+        default:            return m_cursorX + adv > width();
+    }
+}
+
+void CircleGFX::setFont(const GFXfont *f) {
+    m_pFont        = f;
+    m_monoDetected = 6;
+    m_monoAscent   = 0;
+    if (f) {
+        // Monospaced if every glyph (and icon) advances exactly the same.
+        // The cell top sits at the tallest ascender.
+        uint32_t n   = f->last - f->first + 1;
+        uint8_t  adv = f->glyph[0].xAdvance;
+        int16_t  asc = 0;
+        boolean  mono = true;
+        for (uint32_t i = 0; i < n; i++) {
+            mono = mono && f->glyph[i].xAdvance == adv;
+            asc  = MAX(asc, -f->glyph[i].yOffset);
         }
+        for (uint32_t i = 0; f->color && i <= f->color->last - f->color->first; i++) {
+            mono = mono && f->color->glyph[i].xAdvance == adv;
+            asc  = MAX(asc, -f->color->glyph[i].yOffset);
+        }
+        m_monoDetected = mono ? adv : 0;
+        m_monoAscent   = (uint8_t)MIN(asc, (int16_t)f->yAdvance);
     }
+    m_monoAdvance = m_monoDetected;
+}
+
+void CircleGFX::setMonospace(uint8_t advance) {
+    m_monoAdvance = advance ? advance : m_monoDetected;
 }
 
-void CircleGFX::setFont      (const GFXfont *f)  { m_pFont = f; }
 void CircleGFX::setCursor    (int16_t x, int16_t y) { m_cursorX=x; m_cursorY=y; }
 void CircleGFX::setTextColor (uint16_t c)            { m_textColor=c; m_textBgColor=c; }
 void CircleGFX::setTextColor (uint16_t c, uint16_t bg){ m_textColor=c; m_textBgColor=bg; }
 void CircleGFX::setTextSize  (uint8_t s)             { m_textSizeX=m_textSizeY=s?s:1; }
 void CircleGFX::setTextSize  (uint8_t sx, uint8_t sy){ m_textSizeX=sx?sx:1; m_textSizeY=sy?sy:1; }
 void CircleGFX::setTextWrap  (bool w)                { m_textWrap=w; }
+void CircleGFX::setTextOpaque(boolean on)            { m_textOpaque=on; }
+void CircleGFX::setTextDirection(GFXtextDirection d) { m_textDir=d & 3; }
+GFXtextDirection CircleGFX::getTextDirection() const { return (GFXtextDirection)m_textDir; }
+
+void CircleGFX::setTextOutline(uint16_t color, uint8_t radius) {
+    m_textStyle      = GFX_TEXT_OUTLINE;
+    m_textStyleColor = color;
+    m_textStyleA     = (int8_t)MIN(MAX(radius, 1), 15);
+    m_textStyleB     = 0;
+}
 
-// ─── Control ─────────────────────────────────────────────────────────────────
-
-void CircleGFX::setRotation(uint8_t r) {
-    m_rotation = r % 4;
-    if (m_rotation == 1 || m_rotation == 3) SWAP(m_width, m_height);
+void CircleGFX::setTextShadow(uint16_t color, int8_t dx, int8_t dy) {
+    m_textStyle      = GFX_TEXT_SHADOW;
+    m_textStyleColor = color;
+    m_textStyleA     = (int8_t)MIN(MAX(dx, -8), 7);
+    m_textStyleB     = (int8_t)MIN(MAX(dy, -8), 7);
 }
-uint8_t CircleGFX::getRotation() const { return m_rotation; }
-void    CircleGFX::invertDisplay(bool i) { m_inverted = i; }
 
-// ─── Dimensions ──────────────────────────────────────────────────────────────
-int16_t CircleGFX::width()    const { return m_width; }
-int16_t CircleGFX::height()   const { return m_height; }
-int16_t CircleGFX::getCursorX() const { return m_cursorX; }
-int16_t CircleGFX::getCursorY() const { return m_cursorY; }
+void CircleGFX::setTextPlain() { m_textStyle = GFX_TEXT_PLAIN; }
 
-// ─── Internal line helpers ────────────────────────────────────────────────────
-void CircleGFX::drawFastVLineInternal(int16_t x, int16_t y, int16_t h, uint16_t c)
-{ writeFastVLine(x,y,h,c); }
-void CircleGFX::drawFastHLineInternal(int16_t x, int16_t y, int16_t w, uint16_t c)
-{ writeFastHLine(x,y,w,c); }
+// ─── Glyph cache ─────────────────────────────────────────────────────────────
+// Glyphs are expanded once into blit-ready images: A8 coverage for bitmap
+// glyphs, RGB565 (+A8) for colour glyphs, scaled by the text size.  Both are
+// drawn by the same row kernels.  Set-associative, LRU within a set.
 
-// ─── Color helpers ────────────────────────────────────────────────────────────
-uint16_t CircleGFX::color565(uint8_t r, uint8_t g, uint8_t b)
-{ return ((r&0xF8)<<8)|((g&0xFC)<<3)|(b>>3); }
-uint16_t CircleGFX::color565(uint32_t rgb)
-{ return color565((rgb>>16)&0xFF,(rgb>>8)&0xFF,rgb&0xFF); }
+static inline const GFXcolorGlyph *colorGlyph(const GFXfont *f, uint32_t code) {
+    const GFXcolorGlyphs *c = f ? f->color : nullptr;
+    return (c && code >= c->first && code <= c->last) ? &c->glyph[code - c->first] : nullptr;
+}
 
-#ifndef GFX_USE_OPENGL_ES
+// Cache key: the glyph table, not the GFXfont, which callers may refill in
+// place (e.g. GFXAssetPack::getFont() into one struct).  The classic font
+// is keyed by its table so an empty slot stays nullptr.
+static inline const void *glyphKey(const GFXfont *f, uint32_t code) {
+    if (!f) return s_font;
+    if (colorGlyph(f, code)) return f->color->glyph;
+    return f->glyph;
+}
 
-// ─────────────────────────────────────────────────────────────────────────
-// Multi-Buffer Initialization and Management
-// ─────────────────────────────────────────────────────────────────────────
+int16_t CircleGFX::_glyphAdvance(const GFXfont *f, uint32_t code) const {
+    if (!f) return 6;
+    if (const GFXcolorGlyph *cg = colorGlyph(f, code)) return cg->xAdvance;
+    if (code < f->first || code > f->last) return 0;
+    return f->glyph[code - f->first].xAdvance;
+}
 
-boolean CircleGFX::enableMultiBuffer(uint8_t numBuffers)
-{
-    // Clamp to valid range (1-3 buffers)
-    if (numBuffers < 1 || numBuffers > 3) {
-        numBuffers = 2;  // Default to double-buffering
-    }
+void CircleGFX::flushGlyphCache() {
+    for (uint8_t s = 0; s < GFX_GLYPH_CACHE_SETS; s++)
+        for (uint8_t w = 0; w < GFX_GLYPH_CACHE_WAYS; w++) {
+            free(m_glyphCache[s][w].pData);
+            m_glyphCache[s][w].pData = nullptr;
+            m_glyphCache[s][w].pFont = nullptr;
+        }
+}
 
-    // Calculate buffer size in bytes
-    size_t bufferSize = (size_t)m_width * (size_t)m_height * sizeof(uint16_t);
+// Rotate a w×h plane of bpp-byte pixels by dir quarter turns clockwise.
+// 90° and 270° are transposes, done in 8×8 blocks to stay cache friendly.
+static void rotatePlane(const uint8_t *src, uint8_t *dst, int w, int h, int bpp, uint8_t dir) {
+    if (dir == GFX_TEXT_LEFT) {
+        for (int j = 0; j < h; j++)
+            for (int i = 0; i < w; i++)
+                memcpy(dst + ((h - 1 - j) * w + (w - 1 - i)) * bpp, src + (j * w + i) * bpp, bpp);
+        return;
+    }
+    // dst is h wide and w high
+    for (int bj = 0; bj < h; bj += 8)
+        for (int bi = 0; bi < w; bi += 8)
+            for (int j = bj; j < MIN(bj + 8, h); j++)
+                for (int i = bi; i < MIN(bi + 8, w); i++) {
+                    int di = dir == GFX_TEXT_DOWN ? h - 1 - j : j;
+                    int dj = dir == GFX_TEXT_DOWN ? i : w - 1 - i;
+                    memcpy(dst + (dj * h + di) * bpp, src + (j * w + i) * bpp, bpp);
+                }
+}
 
-    // Free any existing allocated buffers
-    for (uint8_t i = 0; i < m_bufferCount; i++) {
-        if (m_buffers[i].bOwned && m_buffers[i].pData != nullptr) {
-            free(m_buffers[i].pData);
-            m_buffers[i].pData = nullptr;
-            m_buffers[i].bOwned = false;
+// Find a glyph's slot: the cached entry (*pHit set) or the LRU victim
+GFXcachedGlyph *CircleGFX::_glyphSlot(const void *key, uint32_t code, uint32_t variant,
+                                      boolean *pHit) {
+    uint32_t set = (code ^ (code >> 4) ^ (variant * 5) ^ (variant >> 13) ^
+                    (uint32_t)((uintptr_t)key >> 4)) % GFX_GLYPH_CACHE_SETS;
+    m_glyphTick++;
+    GFXcachedGlyph *ways = m_glyphCache[set], *victim = &ways[0];
+    for (uint8_t i = 0; i < GFX_GLYPH_CACHE_WAYS; i++) {
+        GFXcachedGlyph *e = &ways[i];
+        if (e->pFont == key && e->code == code && e->variant == variant) {
+            e->lastUse = m_glyphTick;
+            *pHit = true;
+            return e;
         }
+        if (!e->pFont || (victim->pFont && e->lastUse < victim->lastUse))
+            victim = e;
     }
+    *pHit = false;
+    return victim;
+}
 
-    // Allocate new buffers
-    m_bufferCount = numBuffers;
-    for (uint8_t i = 0; i < m_bufferCount; i++) {
-        m_buffers[i].pData = (uint16_t *)malloc(bufferSize);
-        
-        if (m_buffers[i].pData == nullptr) {
-            // Allocation failed - clean up and revert to single buffer
-            for (uint8_t j = 0; j < i; j++) {
-                free(m_buffers[j].pData);
-                m_buffers[j].pData = nullptr;
+const GFXcachedGlyph *CircleGFX::_cachedGlyph(const GFXfont *f, uint32_t code,
+                                              uint8_t size_x, uint8_t size_y, uint8_t dir) {
+    const void *key  = glyphKey(f, code);
+    uint32_t variant = size_x | ((uint32_t)size_y << 8) | ((uint32_t)(dir & 3) << 16);
+    boolean  hit;
+    GFXcachedGlyph *victim = _glyphSlot(key, code, variant, &hit);
+    if (hit) return victim;
+
+    const GFXcolorGlyph *cg = colorGlyph(f, code);
+    int16_t gw, gh, xo, yo;
+    uint8_t format;
+    if (cg) {
+        gw = cg->width;   gh = cg->height;
+        xo = cg->xOffset; yo = cg->yOffset;
+        format = (cg->alphaOffset == GFX_GLYPH_OPAQUE || !f->color->alpha)
+                 ? GFX_GLYPH_RGB565 : GFX_GLYPH_RGB565A8;
+    } else if (!f) {
+        // Classic 5×8 font: the 6×8 cell including the spacer column
+        if (code < 32 || code > 126) return nullptr;
+        gw = 6; gh = 8;
+        xo = 0; yo = 0;
+        format = GFX_GLYPH_A8;
+    } else {
+        if (code < f->first || code > f->last) return nullptr;
+        const GFXglyph *g = &f->glyph[code - f->first];
+        gw = g->width;   gh = g->height;
+        xo = g->xOffset; yo = g->yOffset;
+        format = GFX_GLYPH_A8;
+    }
+    int32_t w = gw * size_x, h = gh * size_y, n = w * h;
+    size_t  bpp  = format == GFX_GLYPH_A8 ? 1 : format == GFX_GLYPH_RGB565 ? 2 : 3;
+    uint8_t *pData = n ? (uint8_t *)malloc((size_t)n * bpp) : nullptr;
+    if (n && !pData) return nullptr;
+
+    if (format == GFX_GLYPH_A8 && !f) {
+        // Column-major, LSB = top row
+        const uint8_t *cols = s_font + (code - 32) * 5;
+        for (int16_t j = 0; j < gh; j++) {
+            uint8_t *row = pData + (int32_t)j * size_y * w;
+            for (int16_t i = 0; i < gw; i++)
+                memset(row + i * size_x, (i < 5 && (cols[i] >> j) & 1) ? 0xFF : 0x00, size_x);
+            for (uint8_t k = 1; k < size_y; k++) memcpy(row + k * w, row, w);
+        }
+    } else if (format == GFX_GLYPH_A8) {
+        // Unpack the MSB-first bit stream, replicating each bit size_x × size_y
+        const uint8_t *bits = f->bitmap + f->glyph[code - f->first].bitmapOffset;
+        uint32_t bit = 0;
+        for (int16_t j = 0; j < gh; j++) {
+            uint8_t *row = pData + (int32_t)j * size_y * w;
+            for (int16_t i = 0; i < gw; i++, bit++) {
+                uint8_t v = (bits[bit >> 3] & (0x80 >> (bit & 7))) ? 0xFF : 0x00;
+                memset(row + i * size_x, v, size_x);
             }
-            m_bufferCount = 1;
-            m_buffers[0].pData = m_pBuffer;  // Revert to original screen buffer
-            m_buffers[0].bOwned = false;
-            m_multiBufferEnabled = false;
-            return false;
+            for (uint8_t k = 1; k < size_y; k++) memcpy(row + k * w, row, w);
         }
+    } else if (n) {
+        const uint16_t *src   = f->color->pixels + cg->pixelOffset;
+        const uint8_t  *alpha = format == GFX_GLYPH_RGB565A8 ? f->color->alpha + cg->alphaOffset : nullptr;
+        uint16_t       *pix   = (uint16_t *)pData;
+        uint8_t        *mask  = pData + (size_t)n * 2;
+        for (int32_t j = 0; j < h; j++)
+            for (int32_t i = 0; i < w; i++) {
+                int32_t s = (j / size_y) * gw + i / size_x;
+                pix[j * w + i] = src[s];
+                if (alpha) mask[j * w + i] = alpha[s];
+            }
+    }
 
-        m_buffers[i].bOwned = true;
-        m_buffers[i].bReady = false;
-
-        // Initialize buffer to black
-        memset(m_buffers[i].pData, 0, bufferSize);
+    // Rotated variants: a pixel at (dx, dy) from the pen moves to
+    // (-dy, dx) for GFX_TEXT_DOWN, (-dx, -dy) for LEFT and (dy, -dx) for UP
+    int16_t ox = xo * size_x, oy = yo * size_y;
+    dir &= 3;
+    if (dir && n) {
+        uint8_t *pRot = (uint8_t *)malloc((size_t)n * bpp);
+        if (!pRot) { free(pData); return nullptr; }
+        if (format == GFX_GLYPH_A8) {
+            rotatePlane(pData, pRot, w, h, 1, dir);
+        } else {
+            rotatePlane(pData, pRot, w, h, 2, dir);
+            if (format == GFX_GLYPH_RGB565A8)
+                rotatePlane(pData + (size_t)n * 2, pRot + (size_t)n * 2, w, h, 1, dir);
+        }
+        free(pData);
+        pData = pRot;
+    }
+    if (dir == GFX_TEXT_DOWN) {
+        int16_t t = ox;
+        ox = (int16_t)(-(oy + h - 1));
+        oy = t;
+        SWAP(w, h);
+    } else if (dir == GFX_TEXT_LEFT) {
+        ox = (int16_t)(-(ox + w - 1));
+        oy = (int16_t)(-(oy + h - 1));
+    } else if (dir == GFX_TEXT_UP) {
+        int16_t t = oy;
+        oy = (int16_t)(-(ox + w - 1));
+        ox = t;
+        SWAP(w, h);
     }
 
-    m_drawBufferIndex = 0;
-    m_displayBufferIndex = 0;
-    m_multiBufferEnabled = true;
-    m_pBuffer = m_buffers[0].pData;  // Point to first buffer for drawing
+    free(victim->pData);
+    victim->pFont   = key;
+    victim->code    = code;
+    victim->variant = variant;
+    victim->format  = format;
+    victim->w       = (int16_t)w;
+    victim->h       = (int16_t)h;
+    victim->xOffset = ox;
+    victim->yOffset = oy;
+    victim->pData   = pData;
+    victim->lastUse = m_glyphTick;
+    return victim;
+}
 
-    return true;
+// Grey-scale dilation with a disc of radius r: horizontal max filters of
+// each half-width the disc needs, then a max over the rows of the disc
+static void dilateA8(const uint8_t *src, uint8_t *dst, int w, int h, int r) {
+    int W = w + 2 * r;
+    uint8_t *hmax = (uint8_t *)malloc((size_t)(r + 1) * W * h);
+    if (!hmax) return;
+    for (int k = 0; k <= r; k++)
+        for (int j = 0; j < h; j++) {
+            uint8_t *o = hmax + ((size_t)k * h + j) * W;
+            const uint8_t *s = src + j * w;
+            for (int x = 0; x < W; x++) {
+                uint8_t m = 0;
+                for (int i = MAX(x - r - k, 0); i <= MIN(x - r + k, w - 1); i++)
+                    m = MAX(m, s[i]);
+                o[x] = m;
+            }
+        }
+    for (int y = 0; y < h + 2 * r; y++) {
+        uint8_t *o = dst + y * W;
+        memset(o, 0, W);
+        for (int dy = -r; dy <= r; dy++) {
+            int j = y - r + dy;
+            if (j < 0 || j >= h) continue;
+            int k = 0;
+            while ((k + 1) * (k + 1) + dy * dy <= r * r) k++;
+            const uint8_t *row = hmax + ((size_t)k * h + j) * W;
+            for (int x = 0; x < W; x++) o[x] = MAX(o[x], row[x]);
+        }
+    }
+    free(hmax);
 }
 
-boolean CircleGFX::isMultiBuffered() const
-{
-    return m_multiBufferEnabled;
+const GFXcachedGlyph *CircleGFX::_styledGlyph(const GFXfont *f, uint32_t code,
+                                              uint8_t size_x, uint8_t size_y, uint8_t dir) {
+    uint32_t variant = size_x | ((uint32_t)size_y << 8) | ((uint32_t)(dir & 3) << 16) |
+                       ((uint32_t)m_textStyle << 18) | ((uint32_t)(m_textStyleA & 0xF) << 20) |
+                       ((uint32_t)(m_textStyleB & 0xF) << 24);
+    const void *key = glyphKey(f, code);
+    boolean hit;
+    GFXcachedGlyph *slot = _glyphSlot(key, code, variant, &hit);
+    if (hit) return slot;
+
+    const GFXcachedGlyph *base = _cachedGlyph(f, code, size_x, size_y, dir);
+    if (!base || base->format != GFX_GLYPH_A8) return base;
+
+    // Both planes cover the union of the glyph and its decoration
+    int16_t pl, pt, pr, pb;
+    if (m_textStyle == GFX_TEXT_OUTLINE) {
+        pl = pt = pr = pb = m_textStyleA;
+    } else {
+        pl = MAX(-m_textStyleA, 0); pr = MAX(m_textStyleA, 0);
+        pt = MAX(-m_textStyleB, 0); pb = MAX(m_textStyleB, 0);
+    }
+    int32_t W = base->w + pl + pr, H = base->h + pt + pb, n = W * H;
+    uint8_t *pData = (uint8_t *)calloc((size_t)n, 2);
+    if (!pData) return base;
+    uint8_t *fg = pData, *fx = pData + n;
+    for (int16_t j = 0; j < base->h; j++)
+        memcpy(fg + (j + pt) * W + pl, base->pData + j * base->w, base->w);
+    if (m_textStyle == GFX_TEXT_OUTLINE) {
+        dilateA8(base->pData, fx, base->w, base->h, m_textStyleA);
+    } else {
+        int16_t sx = pl + m_textStyleA, sy = pt + m_textStyleB;
+        for (int16_t j = 0; j < base->h; j++)
+            memcpy(fx + (j + sy) * W + sx, base->pData + j * base->w, base->w);
+    }
+    int16_t xo = base->xOffset - pl, yo = base->yOffset - pt;
+
+    // base may share the set, so look the victim up again
+    slot = _glyphSlot(key, code, variant, &hit);
+    free(slot->pData);
+    slot->pFont   = key;
+    slot->code    = code;
+    slot->variant = variant;
+    slot->format  = GFX_GLYPH_A8X2;
+    slot->w       = (int16_t)W;
+    slot->h       = (int16_t)H;
+    slot->xOffset = xo;
+    slot->yOffset = yo;
+    slot->pData   = pData;
+    slot->lastUse = m_glyphTick;
+    return slot;
 }
 
-uint8_t CircleGFX::getBufferCount() const
-{
-    return m_bufferCount;
+// A glyph placed in its monospace cell: the full pitch wide and one line
+// high, top at the font's ascender, so opaque text is one fixed-size blit
+const GFXcachedGlyph *CircleGFX::_cellGlyph(const GFXfont *f, uint32_t code,
+                                            uint8_t size_x, uint8_t size_y) {
+    const void *key  = glyphKey(f, code);
+    uint32_t variant = size_x | ((uint32_t)size_y << 8) |
+                       ((uint32_t)m_monoAdvance << 20) | (1u << 28);
+    int16_t  W   = m_monoAdvance * size_x;
+    int16_t  H   = (f ? f->yAdvance : 8) * size_y;
+    int16_t  top = -m_monoAscent * size_y;
+    boolean  hit;
+    GFXcachedGlyph *slot = _glyphSlot(key, code, variant, &hit);
+    // The cell also depends on the line height and ascent, which are not in
+    // the key: a cell of another size is rebuilt in place
+    if (hit && slot->h == H && slot->yOffset == top) return slot;
+
+    const GFXcachedGlyph *base = _cachedGlyph(f, code, size_x, size_y);
+    if (!base || base->format != GFX_GLYPH_A8) return nullptr;
+    if (base->xOffset == 0 && base->yOffset == top && base->w == W && base->h == H)
+        return base;                        // classic font: already a cell
+
+    uint8_t *pData = (uint8_t *)calloc((size_t)W * H, 1);
+    if (!pData) return nullptr;
+    int16_t i0 = MAX(0, -base->xOffset), i1 = MIN(base->w, W - base->xOffset);
+    for (int16_t j = 0; j < base->h && i0 < i1; j++) {
+        int16_t cy = base->yOffset + j - top;
+        if (cy >= 0 && cy < H)
+            memcpy(pData + cy * W + base->xOffset + i0, base->pData + j * base->w + i0, i1 - i0);
+    }
+
+    slot = _glyphSlot(key, code, variant, &hit);
+    free(slot->pData);
+    slot->pFont   = key;
+    slot->code    = code;
+    slot->variant = variant;
+    slot->format  = GFX_GLYPH_A8;
+    slot->w       = W;
+    slot->h       = H;
+    slot->xOffset = 0;
+    slot->yOffset = top;
+    slot->pData   = pData;
+    slot->lastUse = m_glyphTick;
+    return slot;
 }
 
-uint8_t CircleGFX::getDrawBufferIndex() const
+// Opaque cell row: the mask picks between background and text colour, so
+// the destination is only written
+static void cellRowA8(uint16_t *d, uint16_t color, uint16_t bg, const uint8_t *m, int n) {
+    gfx_u16x8 cv = gfxSplat8(color), bv = gfxSplat8(bg);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 a = (gfx_u16x8)gfxLoadU8x8(m + i);
+        gfxStore8(d + i, gfxBlend565x8(bv, cv, a + (a >> 7)));
+    }
+    for (; i < n; i++)
+        d[i] = gfxBlend565(bg, color, (uint16_t)(m[i] + (m[i] >> 7)));
+}
+
+// Monospace writeText(): wrapping counts cells, whole lines and cells
+// outside the clip are skipped without touching their glyphs
+void CircleGFX::_writeMono(const char *text) {
+    const GFXfont *f = m_pFont;
+    int16_t adv    = m_monoAdvance * m_textSizeX;
+    int16_t lineH  = (f ? f->yAdvance : 8) * m_textSizeY;
+    int16_t asc    = m_monoAscent * m_textSizeY;
+    boolean opaque = !f || m_textOpaque;    // classic font is always opaque
+    int16_t clipR  = m_clip.x + m_clip.w, clipB = m_clip.y + m_clip.h;
+    GFXsurface dst = getDrawSurface();
+
+    int32_t left    = m_textWrap ? (width() - m_cursorX) / adv : 0x7FFFFFFF;
+    boolean visible = m_cursorY - asc < clipB && m_cursorY - asc + lineH > m_clip.y;
+    while (*text) {
+        uint32_t c = utf8Next(text);
+        if (c == '\r') continue;
+        if (c == '\n' || left <= 0) {
+            m_cursorX  = 0;
+            m_cursorY += lineH;
+            left    = m_textWrap ? width() / adv : 0x7FFFFFFF;
+            visible = m_cursorY - asc < clipB && m_cursorY - asc + lineH > m_clip.y;
+            if (c == '\n') continue;
+        }
+        left--;
+        int16_t x = m_cursorX;
+        m_cursorX += adv;
+        if (!visible || x >= clipR || x + adv <= m_clip.x) continue;
+
+        if (!f && (c < 32 || c > 126)) c = '?';
+        const GFXcachedGlyph *g = nullptr;
+        if (!colorGlyph(f, c))
+            g = opaque ? _cellGlyph(f, c, m_textSizeX, m_textSizeY)
+                       : _cachedGlyph(f, c, m_textSizeX, m_textSizeY);
+        if (!g || !opaque) {
+            if (opaque) fillRect(x, m_cursorY - asc, adv, lineH, m_textBgColor);
+            if (g) _drawCachedGlyph(*g, x, m_cursorY, m_textColor);
+            else   drawGlyph(x, m_cursorY, c, m_textColor, m_textSizeX, m_textSizeY);
+            continue;
+        }
+
+        GFXrect box = { x, (int16_t)(m_cursorY + g->yOffset), g->w, g->h }, r;
+        if (!GFXrectIntersect(box, m_clip, &r)) continue;
+        const uint8_t *m = g->pData + (int32_t)(r.y - box.y) * g->w + (r.x - box.x);
+        for (int16_t j = 0; j < r.h; j++, m += g->w)
+            cellRowA8(dst.pData + (int32_t)(r.y + j) * dst.stride + r.x,
+                      m_textColor, m_textBgColor, m, r.w);
+        addDamage(r.x, r.y, r.w, r.h);
+    }
+}
+
+// Coverage mask in a solid colour
+static void glyphRowA8(uint16_t *d, uint16_t color, const uint8_t *m, int n) {
+    gfx_u16x8 cv = gfxSplat8(color);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 a = (gfx_u16x8)gfxLoadU8x8(m + i);
+        gfxStore8(d + i, gfxBlend565x8(gfxLoad8(d + i), cv, a + (a >> 7)));
+    }
+    for (; i < n; i++)
+        if (m[i]) d[i] = gfxBlend565(d[i], color, (uint16_t)(m[i] + (m[i] >> 7)));
+}
+
+// Colour pixels through their own alpha
+static void glyphRowRgbA8(uint16_t *d, const uint16_t *s, const uint8_t *m, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 a = (gfx_u16x8)gfxLoadU8x8(m + i);
+        gfxStore8(d + i, gfxBlend565x8(gfxLoad8(d + i), gfxLoad8(s + i), a + (a >> 7)));
+    }
+    for (; i < n; i++)
+        if (m[i]) d[i] = gfxBlend565(d[i], s[i], (uint16_t)(m[i] + (m[i] >> 7)));
+}
+
+// Decoration then glyph, both in solid colours, in one pass over the row
+static void glyphRowA8x2(uint16_t *d, uint16_t color, uint16_t fxColor,
+                         const uint8_t *m, const uint8_t *e, int n) {
+    gfx_u16x8 cv = gfxSplat8(color), ev = gfxSplat8(fxColor);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 a = (gfx_u16x8)gfxLoadU8x8(m + i);
+        gfx_u16x8 b = (gfx_u16x8)gfxLoadU8x8(e + i);
+        gfx_u16x8 v = gfxBlend565x8(gfxLoad8(d + i), ev, b + (b >> 7));
+        gfxStore8(d + i, gfxBlend565x8(v, cv, a + (a >> 7)));
+    }
+    for (; i < n; i++) {
+        if (e[i]) d[i] = gfxBlend565(d[i], fxColor, (uint16_t)(e[i] + (e[i] >> 7)));
+        if (m[i]) d[i] = gfxBlend565(d[i], color,   (uint16_t)(m[i] + (m[i] >> 7)));
+    }
+}
+
+void CircleGFX::_drawCachedGlyph(const GFXcachedGlyph &g, int16_t x, int16_t y, uint16_t color) {
+    if (!g.pData) return;
+    GFXrect box = { (int16_t)(x + g.xOffset), (int16_t)(y + g.yOffset), g.w, g.h }, r;
+    const uint16_t *pix  = (const uint16_t *)g.pData;
+    const uint8_t  *mask = (g.format == GFX_GLYPH_A8 || g.format == GFX_GLYPH_A8X2)
+                           ? g.pData : g.pData + (size_t)g.w * g.h * 2;
+    const uint8_t  *fx   = g.pData + (size_t)g.w * g.h;
+
+    GFXsurface dst = getDrawSurface();
+    if (!dst.pData) {
+#ifdef GFX_USE_OPENGL_ES
+        if (g.format == GFX_GLYPH_RGB565) {
+            _glClip(true);
+            uploadAndDrawTex(box.x, box.y, box.w, box.h, pix);
+            _glClip(false);
+            return;
+        }
+        startWrite();
+        for (int16_t j = 0; j < g.h; j++)
+            for (int16_t i = 0; i < g.w; i++) {
+                if (mask[j * g.w + i] & 0x80)
+                    writePixel(box.x + i, box.y + j,
+                               g.format == GFX_GLYPH_RGB565A8 ? pix[j * g.w + i] : color);
+                else if (g.format == GFX_GLYPH_A8X2 && (fx[j * g.w + i] & 0x80))
+                    writePixel(box.x + i, box.y + j, m_textStyleColor);
+            }
+        endWrite();
+#endif
+        return;
+    }
+    if (!GFXrectIntersect(box, m_clip, &r)) return;
+
+    int32_t off = (int32_t)(r.y - box.y) * g.w + (r.x - box.x);
+    for (int16_t j = 0; j < r.h; j++, off += g.w) {
+        uint16_t *d = dst.pData + (int32_t)(r.y + j) * dst.stride + r.x;
+        switch (g.format) {
+            case GFX_GLYPH_A8:       glyphRowA8(d, color, mask + off, r.w);        break;
+            case GFX_GLYPH_RGB565:   memcpy(d, pix + off, r.w * 2);                break;
+            case GFX_GLYPH_RGB565A8: glyphRowRgbA8(d, pix + off, mask + off, r.w); break;
+            case GFX_GLYPH_A8X2:
+                glyphRowA8x2(d, color, m_textStyleColor, mask + off, fx + off, r.w);
+                break;
+        }
+    }
+    addDamage(r.x, r.y, r.w, r.h);
+}
+
+int16_t CircleGFX::drawGlyph(int16_t x, int16_t y, uint32_t code, uint16_t color,
+                             uint8_t size_x, uint8_t size_y) {
+    if (!m_pFont) {
+        drawChar(x, y, code > 0xFF ? '?' : (unsigned char)code, color, m_textBgColor, size_x, size_y);
+        return 6 * size_x;
+    }
+    if (!size_x) size_x = 1;
+    if (!size_y) size_y = 1;
+    const GFXcachedGlyph *g = m_textStyle != GFX_TEXT_PLAIN
+                            ? _styledGlyph(m_pFont, code, size_x, size_y, m_textDir)
+                            : _cachedGlyph(m_pFont, code, size_x, size_y, m_textDir);
+    if (g) {
+        _drawCachedGlyph(*g, x, y, color);
+    } else if (!m_textDir && !colorGlyph(m_pFont, code) && code >= m_pFont->first && code <= m_pFont->last) {
+        // Out of memory for the cache: draw straight from the bitmap
+        const GFXglyph *glyph = &m_pFont->glyph[code - m_pFont->first];
+        const uint8_t  *bits  =  m_pFont->bitmap + glyph->bitmapOffset;
+        int16_t gx = x + glyph->xOffset;
+        int16_t gy = y + glyph->yOffset;
+        int16_t gw = glyph->width, gh = glyph->height;
+        uint8_t bit = 0, bits8 = 0;
+        startWrite();
+        for (int16_t gy2 = 0; gy2 < gh; gy2++) {
+            for (int16_t gx2 = 0; gx2 < gw; gx2++) {
+                if (!(bit++ & 7)) bits8 = *bits++;
+                if (bits8 & 0x80) {
+                    if (size_x == 1 && size_y == 1)
+                        writePixel(gx+gx2, gy+gy2, color);
+                    else
+                        writeFillRect(gx+gx2*size_x, gy+gy2*size_y, size_x, size_y, color);
+                }
+                bits8 <<= 1;
+            }
+        }
+        endWrite();
+    }
+    return _glyphAdvance(m_pFont, code) * size_x;
+}
+
+// ─── Control ─────────────────────────────────────────────────────────────────
+
+void CircleGFX::setRotation(uint8_t r) {
+    m_rotation = r % 4;
+    if (m_rotation == 1 || m_rotation == 3) SWAP(m_width, m_height);
+    _resetClip();
+}
+uint8_t CircleGFX::getRotation() const { return m_rotation; }
+void    CircleGFX::invertDisplay(bool i) { m_inverted = i; }
+
+// ─── Dimensions ──────────────────────────────────────────────────────────────
+int16_t CircleGFX::width()    const { return m_pTarget ? m_pTarget->width()  : m_width; }
+int16_t CircleGFX::height()   const { return m_pTarget ? m_pTarget->height() : m_height; }
+int16_t CircleGFX::getCursorX() const { return m_cursorX; }
+int16_t CircleGFX::getCursorY() const { return m_cursorY; }
+
+// ─── Internal line helpers ────────────────────────────────────────────────────
+void CircleGFX::drawFastVLineInternal(int16_t x, int16_t y, int16_t h, uint16_t c)
+{ writeFastVLine(x,y,h,c); }
+void CircleGFX::drawFastHLineInternal(int16_t x, int16_t y, int16_t w, uint16_t c)
+{ writeFastHLine(x,y,w,c); }
+
+// ─── Color helpers ────────────────────────────────────────────────────────────
+uint16_t CircleGFX::color565(uint8_t r, uint8_t g, uint8_t b)
+{ return ((r&0xF8)<<8)|((g&0xFC)<<3)|(b>>3); }
+uint16_t CircleGFX::color565(uint32_t rgb)
+{ return color565((rgb>>16)&0xFF,(rgb>>8)&0xFF,rgb&0xFF); }
+
+// ─── Canvases ─────────────────────────────────────────────────────────────────
+
+GFXcanvas16::GFXcanvas16(int16_t w, int16_t h)
+        : m_pData(nullptr), m_width(0), m_height(0), m_bOwned(true) {
+    if (w <= 0 || h <= 0) return;
+    m_pData = (uint16_t *)malloc((size_t)w * (size_t)h * sizeof(uint16_t));
+    if (!m_pData) return;
+    m_width  = w;
+    m_height = h;
+    memset(m_pData, 0, (size_t)w * (size_t)h * sizeof(uint16_t));
+}
+
+GFXcanvas16::GFXcanvas16(int16_t w, int16_t h, uint16_t *pBuffer)
+        : m_pData(pBuffer), m_width(pBuffer ? w : 0), m_height(pBuffer ? h : 0),
+        m_bOwned(false) {}
+
+GFXcanvas16::~GFXcanvas16() {
+    if (m_bOwned) free(m_pData);
+}
+
+GFXsurface GFXcanvas16::getSurface() const {
+    GFXsurface s = { m_pData, m_width, m_height, m_width };
+    return s;
+}
+
+void GFXcanvas16::fillScreen(uint16_t color) {
+    if (!m_pData) return;
+    uint32_t n = (uint32_t)m_width * (uint32_t)m_height;
+    if ((color >> 8) == (color & 0xFF)) {
+        memset(m_pData, color & 0xFF, n * 2);
+    } else {
+        for (uint32_t i = 0; i < n; i++) m_pData[i] = color;
+    }
+}
+
+// ─── Draw target ─────────────────────────────────────────────────────────────
+
+void CircleGFX::setDrawTarget(GFXcanvas16 *pCanvas) {
+    _flushPending();
+    m_pTarget     = pCanvas;
+    m_userClipSet = false;
+    _resetClip();
+}
+
+GFXcanvas16 *CircleGFX::getDrawTarget() const { return m_pTarget; }
+
+GFXsurface CircleGFX::getDrawSurface() const {
+    if (m_pTarget) return m_pTarget->getSurface();
+#ifdef GFX_USE_OPENGL_ES
+    GFXsurface s = { nullptr, m_width, m_height, 0 };   // not CPU-addressable
+#else
+    GFXsurface s = { m_pBuffer, m_width, m_height, (int32_t)(m_pitch / 2) };
+#endif
+    return s;
+}
+
+void CircleGFX::_resetClip() {
+    m_clip.x = 0;
+    m_clip.y = 0;
+    m_clip.w = width();
+    m_clip.h = height();
+    if (m_userClipSet) GFXrectIntersect(m_clip, m_userClip, &m_clip);
+}
+
+// Clip r against the clip rectangle; false if nothing is left or the
+// target cannot be accessed by the CPU.
+boolean CircleGFX::_clipRegion(GFXrect &r, const GFXsurface &s) const {
+    if (!s.pData) return false;
+    return GFXrectIntersect(r, m_clip, &r);
+}
+
+// ─── Clipping ────────────────────────────────────────────────────────────────
+
+void CircleGFX::setClipRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    m_userClip.x  = x;
+    m_userClip.y  = y;
+    m_userClip.w  = w;
+    m_userClip.h  = h;
+    m_userClipSet = true;
+    _resetClip();
+}
+
+void CircleGFX::clearClipRect(void) {
+    m_userClipSet = false;
+    _resetClip();
+}
+
+GFXrect CircleGFX::getClipRect(void) const { return m_clip; }
+
+// ─── Regions and damage tracking ─────────────────────────────────────────────
+
+boolean GFXrectIntersect(const GFXrect &a, const GFXrect &b, GFXrect *pOut) {
+    int16_t x0 = MAX(a.x, b.x), y0 = MAX(a.y, b.y);
+    int16_t x1 = MIN(a.x + a.w, b.x + b.w), y1 = MIN(a.y + a.h, b.y + b.h);
+    if (x1 <= x0 || y1 <= y0) {
+        pOut->x = x0; pOut->y = y0; pOut->w = 0; pOut->h = 0;
+        return false;
+    }
+    pOut->x = x0; pOut->y = y0; pOut->w = x1 - x0; pOut->h = y1 - y0;
+    return true;
+}
+
+GFXrect GFXrectUnion(const GFXrect &a, const GFXrect &b) {
+    if (a.w <= 0 || a.h <= 0) return b;
+    if (b.w <= 0 || b.h <= 0) return a;
+    int16_t x0 = MIN(a.x, b.x), y0 = MIN(a.y, b.y);
+    int16_t x1 = MAX(a.x + a.w, b.x + b.w), y1 = MAX(a.y + a.h, b.y + b.h);
+    GFXrect u = { x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0) };
+    return u;
+}
+
+static inline int32_t rectArea(const GFXrect &r) { return (int32_t)r.w * r.h; }
+
+void GFXregion::add(const GFXrect &r) {
+    if (r.w <= 0 || r.h <= 0) return;
+    GFXrect cur = r;
+    // Absorb every rectangle the new one overlaps (repeat: the union grows)
+    for (uint8_t i = 0; i < count; ) {
+        GFXrect tmp;
+        if (GFXrectIntersect(rects[i], cur, &tmp)) {
+            cur = GFXrectUnion(rects[i], cur);
+            rects[i] = rects[--count];
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+    if (count < GFX_REGION_MAX_RECTS) {
+        rects[count++] = cur;
+        return;
+    }
+    // Full: merge into the entry whose area grows the least
+    uint8_t best = 0;
+    int32_t bestGrowth = 0x7FFFFFFF;
+    for (uint8_t i = 0; i < count; i++) {
+        int32_t g = rectArea(GFXrectUnion(rects[i], cur)) - rectArea(rects[i]);
+        if (g < bestGrowth) { bestGrowth = g; best = i; }
+    }
+    cur = GFXrectUnion(rects[best], cur);
+    rects[best] = rects[--count];
+    add(cur);
+}
+
+void GFXregion::add(const GFXregion &other) {
+    for (uint8_t i = 0; i < other.count; i++) add(other.rects[i]);
+}
+
+GFXrect GFXregion::bounds() const {
+    GFXrect b = { 0, 0, 0, 0 };
+    for (uint8_t i = 0; i < count; i++) b = GFXrectUnion(b, rects[i]);
+    return b;
+}
+
+boolean GFXregion::intersects(const GFXrect &r) const {
+    GFXrect tmp;
+    for (uint8_t i = 0; i < count; i++)
+        if (GFXrectIntersect(rects[i], r, &tmp)) return true;
+    return false;
+}
+
+void CircleGFX::setDamageTracking(boolean enable) {
+    m_damageEnabled = enable;
+    m_pendingValid  = false;
+    m_damage.clear();
+#ifndef GFX_USE_OPENGL_ES
+    m_presentAll = true;        // display content is unknown to the tracker
+    _updateRepairRegion();
+#endif
+}
+
+boolean CircleGFX::isDamageTracking() const { return m_damageEnabled; }
+
+void CircleGFX::addDamage(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (!m_damageEnabled || m_pTarget || m_repairing) return;
+    GFXrect r = { x, y, w, h }, screen = { 0, 0, m_width, m_height };
+    if (GFXrectIntersect(r, screen, &r)) m_damage.add(r);
+}
+
+const GFXregion &CircleGFX::getDamage(void) {
+    _flushPending();
+    return m_damage;
+}
+
+void CircleGFX::clearDamage(void) {
+    m_pendingValid = false;
+    m_damage.clear();
+}
+
+void CircleGFX::_flushPending() {
+    if (!m_pendingValid) return;
+    if (m_repairing) { m_pendingValid = false; return; }
+    m_damage.add(m_pending);
+    m_pendingValid = false;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  REGION EFFECTS  (CPU, RGB565 surfaces)
+// ═════════════════════════════════════════════════════════════════════════════
+
+void *CircleGFX::_effectScratch(size_t bytes) {
+    if (bytes > m_scratchSize) {
+        free(m_pScratch);
+        m_pScratch    = (uint8_t *)malloc(bytes);
+        m_scratchSize = m_pScratch ? bytes : 0;
+    }
+    return m_pScratch;
+}
+
+void CircleGFX::_freeEffects() {
+    free(m_pScratch);
+    m_pScratch    = nullptr;
+    m_scratchSize = 0;
+    for (uint8_t i = 0; i < GFX_SHADOW_CACHE_SIZE; i++) {
+        free(m_shadowCache[i].pProfile);
+        m_shadowCache[i].pProfile = nullptr;
+    }
+    flushGlyphCache();
+}
+
+// ─── Box blur kernels ────────────────────────────────────────────────────────
+// Each pass is a running sum: one add and one subtract per sample, so the
+// cost does not depend on the radius.  Edges are clamped (the border pixel
+// is repeated).  Division by the window size is a 16.16 reciprocal multiply.
+
+static inline uint32_t boxReciprocal(int r) {
+    uint32_t d = 2 * r + 1;
+    return (65536 + d / 2) / d;
+}
+
+// Sum of src[1..r] with indices clamped to n-1, in O(min(r, n)).
+static inline uint32_t boxPrefix(const uint16_t *src, int stride, int n, int r) {
+    uint32_t sum = 0;
+    int k = 1;
+    for (; k <= r && k < n; k++) sum += src[k * stride];
+    if (k <= r) sum += (uint32_t)(r - k + 1) * src[(n - 1) * stride];
+    return sum;
+}
+
+// One box pass over n samples; src and dst must not alias.
+static void boxBlurLine(const uint16_t *src, int srcStride,
+                        uint16_t *dst, int dstStride, int n, int r, uint32_t inv) {
+    uint32_t sum = (uint32_t)(r + 1) * src[0] + boxPrefix(src, srcStride, n, r);
+    for (int i = 0; i < n; i++) {
+        dst[i * dstStride] = (uint16_t)((sum * inv + 32768) >> 16);
+        int add = MIN(i + r + 1, n - 1);
+        int sub = MAX(i - r, 0);
+        sum += src[add * srcStride];
+        sum -= src[sub * srcStride];
+    }
+}
+
+// One vertical box pass over 8 adjacent columns of a w×h plane.
+// tmp holds a copy of the strip so the plane can be updated in place.
+static void boxBlurStrip8(uint16_t *plane, int w, int h, int r, uint32_t inv,
+                          uint16_t *tmp) {
+    for (int j = 0; j < h; j++) gfxStore8(tmp + j * 8, gfxLoad8(plane + j * w));
+
+    gfx_u16x8 sum = gfxLoad8(tmp) * (uint16_t)(r + 1);
+    int k = 1;
+    for (; k <= r && k < h; k++) sum += gfxLoad8(tmp + k * 8);
+    if (k <= r) sum += gfxLoad8(tmp + (h - 1) * 8) * (uint16_t)(r - k + 1);
+
+    for (int j = 0; j < h; j++) {
+        gfx_u32x8 wide = __builtin_convertvector(sum, gfx_u32x8);
+        wide = (wide * inv + 32768) >> 16;
+        gfxStore8(plane + j * w, __builtin_convertvector(wide, gfx_u16x8));
+        sum += gfxLoad8(tmp + MIN(j + r + 1, h - 1) * 8);
+        sum -= gfxLoad8(tmp + MAX(j - r, 0) * 8);
+    }
+}
+
+void CircleGFX::_blurSurface(const GFXsurface &s, GFXrect r,
+                             const uint8_t *radii, uint8_t passes) {
+    int w = r.w, h = r.h;
+    size_t plane = (size_t)w * (size_t)h;
+    size_t line  = (size_t)MAX(w, h);
+    // Three 16-bit channel planes, one scalar line, one 8-wide strip
+    uint8_t *mem = (uint8_t *)_effectScratch((3 * plane + line) * 2 + (size_t)h * 16);
+    if (!mem) return;
+    uint16_t  *ch[3] = { (uint16_t *)mem, (uint16_t *)mem + plane, (uint16_t *)mem + 2 * plane };
+    uint16_t  *tmpLine  = (uint16_t *)mem + 3 * plane;
+    uint16_t  *tmpStrip = tmpLine + line;
+
+    // ── Unpack RGB565 into planar 5/6/5-bit channels ─────────────────────────
+    for (int j = 0; j < h; j++) {
+        const uint16_t *row = s.pData + (r.y + j) * s.stride + r.x;
+        uint16_t *pr = ch[0] + j * w, *pg = ch[1] + j * w, *pb = ch[2] + j * w;
+        int i = 0;
+        for (; i + 8 <= w; i += 8) {
+            gfx_u16x8 v = gfxLoad8(row + i);
+            gfxStore8(pr + i, v >> 11);
+            gfxStore8(pg + i, (v >> 5) & 0x3F);
+            gfxStore8(pb + i, v & 0x1F);
+        }
+        for (; i < w; i++) {
+            pr[i] = row[i] >> 11;
+            pg[i] = (row[i] >> 5) & 0x3F;
+            pb[i] = row[i] & 0x1F;
+        }
+    }
+
+    // ── Separable passes ─────────────────────────────────────────────────────
+    for (uint8_t p = 0; p < passes; p++) {
+        int rad = radii[p];
+        if (rad == 0) continue;
+        uint32_t inv = boxReciprocal(rad);
+        for (int c = 0; c < 3; c++) {
+            // Horizontal
+            for (int j = 0; j < h; j++) {
+                uint16_t *row = ch[c] + j * w;
+                memcpy(tmpLine, row, w * 2);
+                boxBlurLine(tmpLine, 1, row, 1, w, rad, inv);
+            }
+            // Vertical, 8 columns per vector; leftovers one at a time
+            int i = 0;
+            for (; i + 8 <= w; i += 8)
+                boxBlurStrip8(ch[c] + i, w, h, rad, inv, tmpStrip);
+            for (; i < w; i++) {
+                for (int j = 0; j < h; j++) tmpLine[j] = ch[c][j * w + i];
+                boxBlurLine(tmpLine, 1, ch[c] + i, w, h, rad, inv);
+            }
+        }
+    }
+
+    // ── Repack ───────────────────────────────────────────────────────────────
+    for (int j = 0; j < h; j++) {
+        uint16_t *row = s.pData + (r.y + j) * s.stride + r.x;
+        const uint16_t *pr = ch[0] + j * w, *pg = ch[1] + j * w, *pb = ch[2] + j * w;
+        int i = 0;
+        for (; i + 8 <= w; i += 8)
+            gfxStore8(row + i, (gfxLoad8(pr + i) << 11) | (gfxLoad8(pg + i) << 5) | gfxLoad8(pb + i));
+        for (; i < w; i++)
+            row[i] = (uint16_t)((pr[i] << 11) | (pg[i] << 5) | pb[i]);
+    }
+}
+
+void CircleGFX::boxBlur(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t radius, uint8_t passes) {
+    GFXsurface s = getDrawSurface();
+    GFXrect    r = { x, y, w, h };
+    if (!radius || !passes || !_clipRegion(r, s)) return;
+    uint8_t radii[8];
+    if (passes > 8) passes = 8;
+    for (uint8_t i = 0; i < passes; i++) radii[i] = radius;
+    _blurSurface(s, r, radii, passes);
+    addDamage(r.x, r.y, r.w, r.h);
+}
+
+// Per-pass box radii whose three-pass result approximates a Gaussian with
+// sigma = radius / 2 (integer form of the usual "boxes for Gauss" formula).
+static void gaussBoxRadii(uint8_t radius, uint8_t radii[3]) {
+    int R  = radius;
+    int wl = (R & 1) ? R : R - 1;                 // odd box width <= ideal
+    if (wl < 1) wl = 1;
+    int num = 3 * wl * wl + 12 * wl + 9 - 3 * R * R;
+    int m   = (num + 2 * wl + 2) / (4 * wl + 4);  // rounded
+    m = MAX(0, MIN(3, m));
+    for (int i = 0; i < 3; i++) {
+        int bw   = (i < m) ? wl : wl + 2;
+        radii[i] = (uint8_t)MIN(255, (bw - 1) / 2);
+    }
+}
+
+void CircleGFX::gaussianBlur(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t radius) {
+    GFXsurface s = getDrawSurface();
+    GFXrect    r = { x, y, w, h };
+    if (!radius || !_clipRegion(r, s)) return;
+    uint8_t radii[3];
+    gaussBoxRadii(radius, radii);
+    _blurSurface(s, r, radii, 3);
+    addDamage(r.x, r.y, r.w, r.h);
+}
+
+// ─── Shadows ─────────────────────────────────────────────────────────────────
+// A blurred rectangle is separable: coverage(x, y) = px(x) * py(y), where px
+// and py are the 1-D blurs of a step of width w and height h.  Only those two
+// profiles are cached, so a shadow costs one blend per pixel.
+
+static void blurProfile(uint16_t *v, uint16_t *tmp, int n, const uint8_t radii[3]) {
+    for (int p = 0; p < 3; p++) {
+        if (!radii[p]) continue;
+        memcpy(tmp, v, n * 2);
+        boxBlurLine(tmp, 1, v, 1, n, radii[p], boxReciprocal(radii[p]));
+    }
+}
+
+const GFXshadowProfile *CircleGFX::_shadowProfile(int16_t w, int16_t h, uint8_t radius) {
+    m_shadowTick++;
+    GFXshadowProfile *victim = &m_shadowCache[0];
+    for (uint8_t i = 0; i < GFX_SHADOW_CACHE_SIZE; i++) {
+        GFXshadowProfile *e = &m_shadowCache[i];
+        if (e->pProfile && e->w == w && e->h == h && e->radius == radius) {
+            e->lastUse = m_shadowTick;
+            return e;
+        }
+        if (!e->pProfile || (victim->pProfile && e->lastUse < victim->lastUse))
+            victim = e;
+    }
+
+    uint8_t radii[3];
+    gaussBoxRadii(radius, radii);
+    int16_t ext = radii[0] + radii[1] + radii[2];
+    int lx = w + 2 * ext, ly = h + 2 * ext;
+    int n  = MAX(lx, ly);
+
+    uint16_t *work = (uint16_t *)_effectScratch((size_t)n * 4);
+    uint8_t  *prof = (uint8_t *)malloc(lx + ly);
+    if (!work || !prof) { free(prof); return nullptr; }
+
+    const int lens[2] = { lx, ly };
+    const int size[2] = { w, h };
+    uint8_t *out = prof;
+    for (int axis = 0; axis < 2; axis++) {
+        int len = lens[axis];
+        for (int i = 0; i < len; i++)
+            work[i] = (i >= ext && i < ext + size[axis]) ? 255 : 0;
+        blurProfile(work, work + n, len, radii);
+        for (int i = 0; i < len; i++) *out++ = (uint8_t)work[i];
+    }
+
+    free(victim->pProfile);
+    victim->w        = w;
+    victim->h        = h;
+    victim->radius   = radius;
+    victim->extent   = ext;
+    victim->pProfile = prof;
+    victim->lastUse  = m_shadowTick;
+    return victim;
+}
+
+void CircleGFX::drawShadow(int16_t x, int16_t y, int16_t w, int16_t h,
+                           uint8_t radius, uint8_t alpha, uint16_t color) {
+    GFXsurface s = getDrawSurface();
+    if (!s.pData || w <= 0 || h <= 0 || !alpha) return;
+
+    // The shadow extends the rect by the blur on each side: work in int32 and
+    // give up if the profiles would not fit an int16 length
+    uint8_t radii[3];
+    gaussBoxRadii(radius, radii);
+    int32_t ext = radii[0] + radii[1] + radii[2];
+    int32_t lx  = w + 2 * ext, ly = h + 2 * ext;
+    if (lx > 0x7FFF || ly > 0x7FFF) return;
+
+    const GFXshadowProfile *sp = _shadowProfile(w, h, radius);
+    if (!sp) return;
+    int32_t ox = (int32_t)x - ext, oy = (int32_t)y - ext;
+    int32_t x0 = MAX(ox, (int32_t)0), y0 = MAX(oy, (int32_t)0);    // clip is never left of 0
+    if (ox + lx <= x0 || oy + ly <= y0) return;
+    GFXrect r = { (int16_t)x0, (int16_t)y0, (int16_t)(ox + lx - x0), (int16_t)(oy + ly - y0) };
+    if (!_clipRegion(r, s)) return;
+    addDamage(r.x, r.y, r.w, r.h);
+
+    const uint8_t *px = sp->pProfile + (r.x - ox);
+    const uint8_t *py = sp->pProfile + lx + (r.y - oy);
+    uint32_t a8 = alpha + (alpha >> 7);                 // 0..256
+    gfx_u16x8 src = gfxSplat8(color);
+
+    for (int16_t j = 0; j < r.h; j++) {
+        uint32_t ay = py[j] * a8;                        // 0..65280
+        if (!ay) continue;
+        uint16_t *row = s.pData + (r.y + j) * s.stride + r.x;
+        int16_t i = 0;
+        for (; i + 8 <= r.w; i += 8) {
+            gfx_u32x8 cov = { px[i], px[i+1], px[i+2], px[i+3],
+                              px[i+4], px[i+5], px[i+6], px[i+7] };
+            cov = (cov * ay + (cov >> 7) * ay) >> 16;    // 0..256
+            gfxStore8(row + i, gfxBlend565x8(gfxLoad8(row + i), src,
+                                             __builtin_convertvector(cov, gfx_u16x8)));
+        }
+        for (; i < r.w; i++) {
+            uint32_t a = (px[i] * ay + (px[i] >> 7) * ay) >> 16;
+            row[i] = gfxBlend565(row[i], color, (uint16_t)a);
+        }
+    }
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  COLOUR FILTERS  (in place, CPU, RGB565 surfaces)
+// ═════════════════════════════════════════════════════════════════════════════
+// Every filter is a row kernel: 8 pixels per vector with a scalar tail.
+
+void CircleGFX::_filterRegion(int16_t x, int16_t y, int16_t w, int16_t h,
+                              void (*fn)(uint16_t *row, int n, const void *pArgs),
+                              const void *pArgs) {
+    GFXsurface s = getDrawSurface();
+    GFXrect    r = { x, y, w, h };
+    if (!_clipRegion(r, s)) return;
+    for (int16_t j = 0; j < r.h; j++)
+        fn(s.pData + (r.y + j) * s.stride + r.x, r.w, pArgs);
+    addDamage(r.x, r.y, r.w, r.h);
+}
+
+// ─── Brightness / contrast ───────────────────────────────────────────────────
+
+typedef struct {
+    int16_t contrast;           // 1/256 units
+    int16_t offR, offG, offB;   // mid-grey + brightness, per channel scale
+} BrightnessArgs;
+
+static void rowBrightness(uint16_t *row, int n, const void *pArgs) {
+    const BrightnessArgs *a = (const BrightnessArgs *)pArgs;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 v = gfxLoad8(row + i);
+        gfx_s16x8 r = (gfx_s16x8)(v >> 11) - 16, g = (gfx_s16x8)((v >> 5) & 0x3F) - 32,
+                  b = (gfx_s16x8)(v & 0x1F) - 16;
+        r = gfxClamp8(((r * a->contrast) >> 8) + a->offR, 0, 31);
+        g = gfxClamp8(((g * a->contrast) >> 8) + a->offG, 0, 63);
+        b = gfxClamp8(((b * a->contrast) >> 8) + a->offB, 0, 31);
+        gfxStore8(row + i, (gfx_u16x8)((r << 11) | (g << 5) | b));
+    }
+    for (; i < n; i++) {
+        int r = (row[i] >> 11) - 16, g = ((row[i] >> 5) & 0x3F) - 32, b = (row[i] & 0x1F) - 16;
+        r = ((r * a->contrast) >> 8) + a->offR;
+        g = ((g * a->contrast) >> 8) + a->offG;
+        b = ((b * a->contrast) >> 8) + a->offB;
+        r = MAX(0, MIN(31, r)); g = MAX(0, MIN(63, g)); b = MAX(0, MIN(31, b));
+        row[i] = (uint16_t)((r << 11) | (g << 5) | b);
+    }
+}
+
+void CircleGFX::filterBrightnessContrast(int16_t x, int16_t y, int16_t w, int16_t h,
+                                         int16_t brightness, int16_t contrast) {
+    brightness = MAX(-255, MIN(255, brightness));
+    contrast   = MAX(0, MIN(1023, contrast));      // keeps (c - mid) * contrast in 16 bits
+    BrightnessArgs a;
+    a.contrast = contrast;
+    a.offR = (int16_t)(16 + brightness * 31 / 255);
+    a.offG = (int16_t)(32 + brightness * 63 / 255);
+    a.offB = a.offR;
+    _filterRegion(x, y, w, h, rowBrightness, &a);
+}
+
+// ─── Desaturate ──────────────────────────────────────────────────────────────
+// Luma on a 6-bit scale: (2*77*R5 + 150*G6 + 2*29*B5) >> 8.
+
+static void rowDesaturate(uint16_t *row, int n, const void *pArgs) {
+    int16_t amount = *(const int16_t *)pArgs;      // 0..256
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 v = gfxLoad8(row + i);
+        gfx_s16x8 r = (gfx_s16x8)(v >> 11), g = (gfx_s16x8)((v >> 5) & 0x3F), b = (gfx_s16x8)(v & 0x1F);
+        gfx_s16x8 y = (gfx_s16x8)(((gfx_u16x8)(r * 154 + g * 150 + b * 58)) >> 8);
+        r += (((y >> 1) - r) * amount) >> 8;
+        g += ((y - g) * amount) >> 8;
+        b += (((y >> 1) - b) * amount) >> 8;
+        gfxStore8(row + i, (gfx_u16x8)((r << 11) | (g << 5) | b));
+    }
+    for (; i < n; i++) {
+        int r = row[i] >> 11, g = (row[i] >> 5) & 0x3F, b = row[i] & 0x1F;
+        int y = (r * 154 + g * 150 + b * 58) >> 8;
+        r += (((y >> 1) - r) * amount) >> 8;
+        g += ((y - g) * amount) >> 8;
+        b += (((y >> 1) - b) * amount) >> 8;
+        row[i] = (uint16_t)((r << 11) | (g << 5) | b);
+    }
+}
+
+void CircleGFX::filterDesaturate(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t amount) {
+    int16_t a = amount + (amount >> 7);
+    _filterRegion(x, y, w, h, rowDesaturate, &a);
+}
+
+// ─── Tint ────────────────────────────────────────────────────────────────────
+
+typedef struct {
+    uint16_t color;
+    uint16_t alpha;             // 0..256
+} TintArgs;
+
+static void rowTint(uint16_t *row, int n, const void *pArgs) {
+    const TintArgs *a = (const TintArgs *)pArgs;
+    gfx_u16x8 src = gfxSplat8(a->color), av = gfxSplat8(a->alpha);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        gfxStore8(row + i, gfxBlend565x8(gfxLoad8(row + i), src, av));
+    for (; i < n; i++)
+        row[i] = gfxBlend565(row[i], a->color, a->alpha);
+}
+
+void CircleGFX::filterTint(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, uint8_t alpha) {
+    TintArgs a = { color, (uint16_t)(alpha + (alpha >> 7)) };
+    _filterRegion(x, y, w, h, rowTint, &a);
+}
+
+// ─── Invert ──────────────────────────────────────────────────────────────────
+
+static void rowInvert(uint16_t *row, int n, const void *) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) gfxStore8(row + i, ~gfxLoad8(row + i));
+    for (; i < n; i++) row[i] = ~row[i];
+}
+
+void CircleGFX::filterInvert(int16_t x, int16_t y, int16_t w, int16_t h) {
+    _filterRegion(x, y, w, h, rowInvert, nullptr);
+}
+
+// ─── Multiply ────────────────────────────────────────────────────────────────
+// c' = c * k / max per channel; the division is a 16.16 reciprocal multiply
+// (65536/31 = 2114.1, 65536/63 = 1040.3, rounded up so max * max stays max).
+
+typedef struct {
+    uint16_t kr, kg, kb;
+} MultiplyArgs;
+
+static void rowMultiply(uint16_t *row, int n, const void *pArgs) {
+    const MultiplyArgs *a = (const MultiplyArgs *)pArgs;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 v = gfxLoad8(row + i);
+        gfx_u32x8 r = __builtin_convertvector(v >> 11, gfx_u32x8);
+        gfx_u32x8 g = __builtin_convertvector((v >> 5) & 0x3F, gfx_u32x8);
+        gfx_u32x8 b = __builtin_convertvector(v & 0x1F, gfx_u32x8);
+        r = (r * a->kr * 2115) >> 16;
+        g = (g * a->kg * 1041) >> 16;
+        b = (b * a->kb * 2115) >> 16;
+        gfx_u32x8 out = (r << 11) | (g << 5) | b;
+        gfxStore8(row + i, __builtin_convertvector(out, gfx_u16x8));
+    }
+    for (; i < n; i++) {
+        uint32_t r = ((uint32_t)(row[i] >> 11) * a->kr * 2115) >> 16;
+        uint32_t g = ((uint32_t)((row[i] >> 5) & 0x3F) * a->kg * 1041) >> 16;
+        uint32_t b = ((uint32_t)(row[i] & 0x1F) * a->kb * 2115) >> 16;
+        row[i] = (uint16_t)((r << 11) | (g << 5) | b);
+    }
+}
+
+void CircleGFX::filterMultiply(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    MultiplyArgs a = { (uint16_t)(color >> 11), (uint16_t)((color >> 5) & 0x3F),
+                       (uint16_t)(color & 0x1F) };
+    _filterRegion(x, y, w, h, rowMultiply, &a);
+}
+
+// ─── Curves (generic LUT path) ───────────────────────────────────────────────
+// Pre-shifted tables so each pixel is three loads and two ORs.
+
+typedef struct {
+    uint16_t r[32], g[64], b[32];
+} CurveArgs;
+
+static void rowCurves(uint16_t *row, int n, const void *pArgs) {
+    const CurveArgs *a = (const CurveArgs *)pArgs;
+    for (int i = 0; i < n; i++) {
+        uint16_t v = row[i];
+        row[i] = a->r[v >> 11] | a->g[(v >> 5) & 0x3F] | a->b[v & 0x1F];
+    }
+}
+
+void CircleGFX::filterCurves(int16_t x, int16_t y, int16_t w, int16_t h,
+                             const uint8_t curveR[32], const uint8_t curveG[64],
+                             const uint8_t curveB[32]) {
+    CurveArgs a;
+    for (int i = 0; i < 32; i++) {
+        a.r[i] = (uint16_t)((curveR[i] & 0x1F) << 11);
+        a.b[i] = (uint16_t)(curveB[i] & 0x1F);
+    }
+    for (int i = 0; i < 64; i++) a.g[i] = (uint16_t)((curveG[i] & 0x3F) << 5);
+    _filterRegion(x, y, w, h, rowCurves, &a);
+}
+
+void CircleGFX::filterCurves(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t curve[256]) {
+    uint8_t r[32], g[64];
+    // Sample the 8-bit curve at the expanded channel value, requantise
+    for (int i = 0; i < 32; i++) r[i] = curve[(i << 3) | (i >> 2)] >> 3;
+    for (int i = 0; i < 64; i++) g[i] = curve[(i << 2) | (i >> 4)] >> 2;
+    filterCurves(x, y, w, h, r, g, r);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  BLITS
+// ═════════════════════════════════════════════════════════════════════════════
+
+// ─── RGB565 row kernels ──────────────────────────────────────────────────────
+// Signature shared by all modes; the mode is resolved to one of these once
+// per blit.  d and s never alias (overlapping rows go through a temp line).
+
+typedef void (*BlitRowFn)(uint16_t *d, const uint16_t *s, int n, uint16_t param);
+
+static void blitRowCopy(uint16_t *d, const uint16_t *s, int n, uint16_t) {
+    memcpy(d, s, n * 2);
+}
+
+static void blitRowColorKey(uint16_t *d, const uint16_t *s, int n, uint16_t key) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 sv = gfxLoad8(s + i);
+        gfx_u16x8 keep = (gfx_u16x8)(sv == key);         // all ones where transparent
+        gfxStore8(d + i, (gfxLoad8(d + i) & keep) | (sv & ~keep));
+    }
+    for (; i < n; i++) if (s[i] != key) d[i] = s[i];
+}
+
+static void blitRowXor(uint16_t *d, const uint16_t *s, int n, uint16_t) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) gfxStore8(d + i, gfxLoad8(d + i) ^ gfxLoad8(s + i));
+    for (; i < n; i++) d[i] ^= s[i];
+}
+
+static void blitRowAnd(uint16_t *d, const uint16_t *s, int n, uint16_t) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) gfxStore8(d + i, gfxLoad8(d + i) & gfxLoad8(s + i));
+    for (; i < n; i++) d[i] &= s[i];
+}
+
+static void blitRowOr(uint16_t *d, const uint16_t *s, int n, uint16_t) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) gfxStore8(d + i, gfxLoad8(d + i) | gfxLoad8(s + i));
+    for (; i < n; i++) d[i] |= s[i];
+}
+
+static void blitRowAlpha(uint16_t *d, const uint16_t *s, int n, uint16_t alpha) {
+    gfx_u16x8 av = gfxSplat8(alpha);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        gfxStore8(d + i, gfxBlend565x8(gfxLoad8(d + i), gfxLoad8(s + i), av));
+    for (; i < n; i++) d[i] = gfxBlend565(d[i], s[i], alpha);
+}
+
+static void blitRowAdd(uint16_t *d, const uint16_t *s, int n, uint16_t) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 dv = gfxLoad8(d + i), sv = gfxLoad8(s + i);
+        gfx_s16x8 r = (gfx_s16x8)((dv >> 11) + (sv >> 11));
+        gfx_s16x8 g = (gfx_s16x8)(((dv >> 5) & 0x3F) + ((sv >> 5) & 0x3F));
+        gfx_s16x8 b = (gfx_s16x8)((dv & 0x1F) + (sv & 0x1F));
+        r = gfxClamp8(r, 0, 31); g = gfxClamp8(g, 0, 63); b = gfxClamp8(b, 0, 31);
+        gfxStore8(d + i, (gfx_u16x8)((r << 11) | (g << 5) | b));
+    }
+    for (; i < n; i++) {
+        int r = MIN(31, (d[i] >> 11) + (s[i] >> 11));
+        int g = MIN(63, ((d[i] >> 5) & 0x3F) + ((s[i] >> 5) & 0x3F));
+        int b = MIN(31, (d[i] & 0x1F) + (s[i] & 0x1F));
+        d[i] = (uint16_t)((r << 11) | (g << 5) | b);
+    }
+}
+
+// Same reciprocals as filterMultiply (2115 ~ 65536/31, 1041 ~ 65536/63)
+static void blitRowMultiply(uint16_t *d, const uint16_t *s, int n, uint16_t) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u16x8 dv = gfxLoad8(d + i), sv = gfxLoad8(s + i);
+        gfx_u16x8 r = (dv >> 11) * (sv >> 11);                       // <= 961
+        gfx_u16x8 g = ((dv >> 5) & 0x3F) * ((sv >> 5) & 0x3F);       // <= 3969
+        gfx_u16x8 b = (dv & 0x1F) * (sv & 0x1F);
+        gfx_u32x8 r32 = (__builtin_convertvector(r, gfx_u32x8) * 2115) >> 16;
+        gfx_u32x8 g32 = (__builtin_convertvector(g, gfx_u32x8) * 1041) >> 16;
+        gfx_u32x8 b32 = (__builtin_convertvector(b, gfx_u32x8) * 2115) >> 16;
+        gfxStore8(d + i, __builtin_convertvector((r32 << 11) | (g32 << 5) | b32, gfx_u16x8));
+    }
+    for (; i < n; i++) {
+        uint32_t r = ((uint32_t)(d[i] >> 11) * (s[i] >> 11) * 2115) >> 16;
+        uint32_t g = ((uint32_t)((d[i] >> 5) & 0x3F) * ((s[i] >> 5) & 0x3F) * 1041) >> 16;
+        uint32_t b = ((uint32_t)(d[i] & 0x1F) * (s[i] & 0x1F) * 2115) >> 16;
+        d[i] = (uint16_t)((r << 11) | (g << 5) | b);
+    }
+}
+
+static BlitRowFn selectBlitKernel(GFXblitMode mode) {
+    switch (mode) {
+        case GFX_BLIT_COLORKEY: return blitRowColorKey;
+        case GFX_BLIT_XOR:      return blitRowXor;
+        case GFX_BLIT_AND:      return blitRowAnd;
+        case GFX_BLIT_OR:       return blitRowOr;
+        case GFX_BLIT_ALPHA:    return blitRowAlpha;
+        case GFX_BLIT_ADD:      return blitRowAdd;
+        case GFX_BLIT_MULTIPLY: return blitRowMultiply;
+        case GFX_BLIT_COPY:
+        default:                return blitRowCopy;
+    }
+}
+
+void CircleGFX::blit(const GFXsurface &src, const GFXrect &srcRect, int16_t dstX, int16_t dstY,
+                     GFXblitMode mode, uint16_t param) {
+    if (!src.pData) return;
+
+    // Clip the source rectangle to the source surface ...
+    GFXrect sr = srcRect, srcBounds = { 0, 0, src.width, src.height };
+    int16_t sx0 = sr.x, sy0 = sr.y;
+    if (!GFXrectIntersect(sr, srcBounds, &sr)) return;
+    dstX += sr.x - sx0;
+    dstY += sr.y - sy0;
+
+    // ... and the destination to the clip rectangle
+    GFXrect dr = { dstX, dstY, sr.w, sr.h };
+    if (!GFXrectIntersect(dr, m_clip, &dr)) return;
+    sr.x += dr.x - dstX;
+    sr.y += dr.y - dstY;
+
+    GFXsurface dst = getDrawSurface();
+    if (!dst.pData) {
+#ifdef GFX_USE_OPENGL_ES
+        if (mode != GFX_BLIT_COPY) return;
+        uint16_t *tmp = (uint16_t *)_effectScratch((size_t)dr.w * dr.h * 2);
+        if (!tmp) return;
+        for (int16_t j = 0; j < dr.h; j++)
+            memcpy(tmp + j * dr.w, src.pData + (sr.y + j) * src.stride + sr.x, dr.w * 2);
+        uploadAndDrawTex(dr.x, dr.y, dr.w, dr.h, tmp);
+#endif
+        return;
+    }
+
+    BlitRowFn fn = selectBlitKernel(mode);
+    if (mode == GFX_BLIT_ALPHA) param = (uint16_t)(param + (param >> 7));   // 0..256
+
+    // Overlap: walk rows bottom-up when moving down, and stage rows whose
+    // memory overlaps the destination row in a temp line.
+    const uint16_t *srcFirst = src.pData + sr.y * src.stride + sr.x;
+    uint16_t       *dstFirst = dst.pData + dr.y * dst.stride + dr.x;
+    const uint16_t *srcEnd   = src.pData + (sr.y + sr.h - 1) * src.stride + sr.x + sr.w;
+    const uint16_t *dstEnd   = dst.pData + (dr.y + dr.h - 1) * dst.stride + dr.x + dr.w;
+    boolean overlap  = srcFirst < dstEnd && dstFirst < srcEnd;
+    boolean upwards  = overlap && dstFirst > srcFirst;
+    uint16_t *line   = overlap ? (uint16_t *)_effectScratch((size_t)dr.w * 2) : nullptr;
+    if (overlap && !line) return;
+
+    for (int16_t k = 0; k < dr.h; k++) {
+        int16_t j = upwards ? dr.h - 1 - k : k;
+        const uint16_t *s = src.pData + (sr.y + j) * src.stride + sr.x;
+        uint16_t       *d = dst.pData + (dr.y + j) * dst.stride + dr.x;
+        if (overlap && s < d + dr.w && d < s + dr.w) {
+            memcpy(line, s, dr.w * 2);
+            s = line;
+        }
+        fn(d, s, dr.w, param);
+    }
+    addDamage(dr.x, dr.y, dr.w, dr.h);
+}
+
+void CircleGFX::blit(const GFXcanvas16 &src, int16_t dstX, int16_t dstY,
+                     GFXblitMode mode, uint16_t param) {
+    GFXrect r = { 0, 0, src.width(), src.height() };
+    blit(src.getSurface(), r, dstX, dstY, mode, param);
+}
+
+// ─── 1-bit raster ops ────────────────────────────────────────────────────────
+// Destination bytes are produced from a 16-bit window over the source row,
+// shifted into alignment; partial bytes at the edges are masked.
+
+// 8 source bits starting at bit position pos (may be negative: zeros shifted in)
+static inline uint8_t fetchBits8(const uint8_t *row, int32_t pos, int32_t nBytes) {
+    if (pos < 0) return (uint8_t)(fetchBits8(row, 0, nBytes) >> -pos);
+    int32_t k  = pos >> 3;
+    int     sh = pos & 7;
+    uint16_t win = (uint16_t)(((k < nBytes) ? row[k] : 0) << 8);
+    if (sh && k + 1 < nBytes) win |= row[k + 1];
+    return (uint8_t)((win << sh) >> 8);
+}
+
+void GFXblitBits(const GFXbitSurface &src, const GFXrect &srcRect,
+                 const GFXbitSurface &dst, int16_t dstX, int16_t dstY, GFXblitMode mode) {
+    if (!src.pData || !dst.pData) return;
+    GFXrect sr = srcRect, srcBounds = { 0, 0, src.width, src.height };
+    int16_t sx0 = sr.x, sy0 = sr.y;
+    if (!GFXrectIntersect(sr, srcBounds, &sr)) return;
+    dstX += sr.x - sx0;
+    dstY += sr.y - sy0;
+    GFXrect dr = { dstX, dstY, sr.w, sr.h }, dstBounds = { 0, 0, dst.width, dst.height };
+    if (!GFXrectIntersect(dr, dstBounds, &dr)) return;
+    sr.x += dr.x - dstX;
+    sr.y += dr.y - dstY;
+
+    int32_t srcBytes = (src.width + 7) >> 3;
+    int32_t b0 = dr.x >> 3, b1 = (dr.x + dr.w - 1) >> 3;
+    uint8_t m0 = (uint8_t)(0xFF >> (dr.x & 7));
+    uint8_t m1 = (uint8_t)(0xFF << (7 - ((dr.x + dr.w - 1) & 7)));
+
+    // Same-buffer overlap: rows bottom-up when moving down, bytes right-to-left
+    // when moving right, so every source byte is read before it is overwritten.
+    boolean same  = src.pData == dst.pData;
+    boolean down  = same && dr.y > sr.y;
+    boolean right = same && dr.y == sr.y && dr.x > sr.x;
+
+    for (int16_t k = 0; k < dr.h; k++) {
+        int16_t j = down ? dr.h - 1 - k : k;
+        const uint8_t *s = src.pData + (int32_t)(sr.y + j) * src.stride;
+        uint8_t       *d = dst.pData + (int32_t)(dr.y + j) * dst.stride;
+        for (int32_t n = 0; n <= b1 - b0; n++) {
+            int32_t b = right ? b1 - n : b0 + n;
+            uint8_t mask = 0xFF;
+            if (b == b0) mask &= m0;
+            if (b == b1) mask &= m1;
+            uint8_t v = fetchBits8(s, sr.x + (b * 8 - dr.x), srcBytes) & mask;
+            switch (mode) {
+                case GFX_BLIT_XOR:      d[b] ^= v;                          break;
+                case GFX_BLIT_AND:      d[b] &= (uint8_t)(v | ~mask);       break;
+                case GFX_BLIT_OR:
+                case GFX_BLIT_COLORKEY: d[b] |= v;                          break;
+                default:                d[b] = (uint8_t)((d[b] & ~mask) | v); break;
+            }
+        }
+    }
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  INDEXED CANVASES / PALETTE ANIMATION
+// ═════════════════════════════════════════════════════════════════════════════
+
+GFXcanvas8::GFXcanvas8(int16_t w, int16_t h)
+        : m_pData(nullptr), m_width(0), m_height(0) {
+    memset(m_palette, 0, sizeof(m_palette));
+    memset(m_lut,     0, sizeof(m_lut));
+    memset(m_usage,   0, sizeof(m_usage));
+    memset(m_cycles,  0, sizeof(m_cycles));
+    m_damage.clear();
+    if (w <= 0 || h <= 0) return;
+    m_pData = (uint8_t *)malloc((size_t)w * (size_t)h);
+    if (!m_pData) return;
+    m_width  = w;
+    m_height = h;
+    fillScreen(0);
+}
+
+GFXcanvas8::~GFXcanvas8() {
+    free(m_pData);
+}
+
+// ─── Usage map ───────────────────────────────────────────────────────────────
+// Bounding box per index, grown by every draw.  It is conservative (only
+// fillScreen shrinks it), which is all damage needs.
+
+void GFXcanvas8::_use(uint8_t index, int16_t x, int16_t y, int16_t w, int16_t h) {
+    GFXrect r = { x, y, w, h };
+    m_usage[index] = m_usage[index].w ? GFXrectUnion(m_usage[index], r) : r;
+    m_damage.add(r);
+}
+
+// ─── Drawing ─────────────────────────────────────────────────────────────────
+
+void GFXcanvas8::drawPixel(int16_t x, int16_t y, uint8_t index) {
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height) return;
+    m_pData[(int32_t)y * m_width + x] = index;
+    _use(index, x, y, 1, 1);
+}
+
+void GFXcanvas8::drawFastHLine(int16_t x, int16_t y, int16_t w, uint8_t index) {
+    fillRect(x, y, w, 1, index);
+}
+
+void GFXcanvas8::drawFastVLine(int16_t x, int16_t y, int16_t h, uint8_t index) {
+    fillRect(x, y, 1, h, index);
+}
+
+void GFXcanvas8::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index) {
+    GFXrect r = { x, y, w, h }, bounds = { 0, 0, m_width, m_height };
+    if (!m_pData || !GFXrectIntersect(r, bounds, &r)) return;
+    for (int16_t j = 0; j < r.h; j++)
+        memset(m_pData + (int32_t)(r.y + j) * m_width + r.x, index, r.w);
+    _use(index, r.x, r.y, r.w, r.h);
+}
+
+void GFXcanvas8::fillScreen(uint8_t index) {
+    if (!m_pData) return;
+    memset(m_pData, index, (size_t)m_width * (size_t)m_height);
+    memset(m_usage, 0, sizeof(m_usage));
+    m_damage.clear();
+    _use(index, 0, 0, m_width, m_height);
+}
+
+void GFXcanvas8::drawBitmap(int16_t x, int16_t y, const uint8_t *pIndices, int16_t w, int16_t h) {
+    GFXrect r = { x, y, w, h }, bounds = { 0, 0, m_width, m_height };
+    if (!m_pData || !pIndices || !GFXrectIntersect(r, bounds, &r)) return;
+    for (int16_t j = 0; j < r.h; j++) {
+        const uint8_t *s = pIndices + (int32_t)(r.y - y + j) * w + (r.x - x);
+        memcpy(m_pData + (int32_t)(r.y + j) * m_width + r.x, s, r.w);
+        // Grow the usage box of every index written
+        for (int16_t i = 0; i < r.w; i++) {
+            GFXrect &u  = m_usage[s[i]];
+            int16_t  px = r.x + i, py = r.y + j;
+            if (!u.w) { u.x = px; u.y = py; u.w = 1; u.h = 1; continue; }
+            if (px < u.x)        { u.w += u.x - px; u.x = px; }
+            else if (px >= u.x + u.w) u.w = px - u.x + 1;
+            if (py >= u.y + u.h) u.h = py - u.y + 1;
+            else if (py < u.y)   { u.h += u.y - py; u.y = py; }
+        }
+    }
+    m_damage.add(r);
+}
+
+// ─── Palette ─────────────────────────────────────────────────────────────────
+
+void GFXcanvas8::setPalette(uint8_t index, uint16_t color) {
+    setPalette(&color, index, 1);
+}
+
+void GFXcanvas8::setPalette(const uint16_t *pColors, uint8_t first, uint16_t count) {
+    if (!pColors) return;
+    if (count > 256 - first) count = 256 - first;
+    for (uint16_t i = 0; i < count; i++) m_palette[first + i] = pColors[i];
+    memcpy(m_lut + first, m_palette + first, count * sizeof(uint16_t));
+    for (uint8_t c = 0; c < GFX_MAX_PALETTE_CYCLES; c++)
+        if (m_cycles[c].count && m_cycles[c].phase >= 0) _applyCycle(m_cycles[c]);
+    for (uint16_t i = 0; i < count; i++)
+        if (m_usage[first + i].w) m_damage.add(m_usage[first + i]);
+}
+
+int8_t GFXcanvas8::addPaletteCycle(uint8_t first, uint16_t count, uint16_t stepMs,
+                                   GFXpaletteCycleMode mode) {
+    if (count > 256 - first) count = 256 - first;
+    if (count < 2 || !stepMs) return -1;
+    for (uint8_t c = 0; c < GFX_MAX_PALETTE_CYCLES; c++) {
+        if (m_cycles[c].count) continue;
+        GFXpaletteCycle &cy = m_cycles[c];
+        cy.first   = first;
+        cy.count   = count;
+        cy.stepMs  = stepMs;
+        cy.mode    = (uint8_t)mode;
+        cy.startMs = 0;
+        cy.phase   = -1;
+        return (int8_t)c;
+    }
+    return -1;
+}
+
+void GFXcanvas8::removePaletteCycle(int8_t id) {
+    if (id < 0 || id >= GFX_MAX_PALETTE_CYCLES || !m_cycles[id].count) return;
+    GFXpaletteCycle &cy = m_cycles[id];
+    memcpy(m_lut + cy.first, m_palette + cy.first, cy.count * sizeof(uint16_t));
+    for (uint16_t i = 0; i < cy.count; i++)
+        if (m_usage[cy.first + i].w) m_damage.add(m_usage[cy.first + i]);
+    cy.count = 0;
+}
+
+// Rotate the range by phase entries: lut[i] = palette[i - phase]
+void GFXcanvas8::_applyCycle(const GFXpaletteCycle &c) {
+    const uint16_t *src = m_palette + c.first;
+    uint16_t       *dst = m_lut + c.first;
+    uint16_t        p   = (uint16_t)c.phase;
+    memcpy(dst + p, src, (c.count - p) * sizeof(uint16_t));
+    memcpy(dst, src + (c.count - p), p * sizeof(uint16_t));
+}
+
+boolean GFXcanvas8::updatePalette(uint32_t nowMs) {
+    boolean changed = false;
+    for (uint8_t c = 0; c < GFX_MAX_PALETTE_CYCLES; c++) {
+        GFXpaletteCycle &cy = m_cycles[c];
+        if (!cy.count) continue;
+        if (cy.phase < 0) {
+            cy.startMs = nowMs;
+            cy.phase   = 0;
+            continue;
+        }
+        uint32_t steps = (nowMs - cy.startMs) / cy.stepMs;
+        int16_t  phase;
+        switch (cy.mode) {
+            case GFX_CYCLE_BACKWARD:
+                phase = (int16_t)((cy.count - steps % cy.count) % cy.count);
+                break;
+            case GFX_CYCLE_PINGPONG: {
+                uint32_t period = 2u * (cy.count - 1), p = steps % period;
+                phase = (int16_t)(p < cy.count ? p : period - p);
+                break;
+            }
+            default:
+                phase = (int16_t)(steps % cy.count);
+                break;
+        }
+        if (phase == cy.phase) continue;
+        cy.phase = phase;
+        _applyCycle(cy);
+        for (uint16_t i = 0; i < cy.count; i++)
+            if (m_usage[cy.first + i].w) m_damage.add(m_usage[cy.first + i]);
+        changed = true;
+    }
+    return changed;
+}
+
+// ─── Expansion to RGB565 ─────────────────────────────────────────────────────
+// A 256-entry 16-bit table does not fit a vector table lookup, so this is a
+// scalar gather unrolled by 8.
+
+static inline void expandRow8(uint16_t *d, const uint8_t *s, int n, const uint16_t *lut) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        d[i + 0] = lut[s[i + 0]]; d[i + 1] = lut[s[i + 1]];
+        d[i + 2] = lut[s[i + 2]]; d[i + 3] = lut[s[i + 3]];
+        d[i + 4] = lut[s[i + 4]]; d[i + 5] = lut[s[i + 5]];
+        d[i + 6] = lut[s[i + 6]]; d[i + 7] = lut[s[i + 7]];
+    }
+    for (; i < n; i++) d[i] = lut[s[i]];
+}
+
+void CircleGFX::drawCanvas8(int16_t x, int16_t y, const GFXcanvas8 &canvas,
+                            const GFXregion *pRegion) {
+    if (!canvas.getBuffer()) return;
+    GFXregion all;
+    if (!pRegion) {
+        all.clear();
+        GFXrect r = { 0, 0, canvas.width(), canvas.height() };
+        all.add(r);
+        pRegion = &all;
+    }
+
+    GFXsurface      dst = getDrawSurface();
+    const uint16_t *lut = canvas.getLUT();
+    GFXrect bounds = { 0, 0, canvas.width(), canvas.height() };
+    for (uint8_t k = 0; k < pRegion->count; k++) {
+        GFXrect sr;
+        if (!GFXrectIntersect(pRegion->rects[k], bounds, &sr)) continue;
+        GFXrect dr = { (int16_t)(x + sr.x), (int16_t)(y + sr.y), sr.w, sr.h };
+        if (!GFXrectIntersect(dr, m_clip, &dr)) continue;
+        sr.x = dr.x - x;
+        sr.y = dr.y - y;
+        const uint8_t *s = canvas.getBuffer() + (int32_t)sr.y * canvas.width() + sr.x;
+
+        if (!dst.pData) {
+#ifdef GFX_USE_OPENGL_ES
+            uint16_t *tmp = (uint16_t *)_effectScratch((size_t)dr.w * dr.h * 2);
+            if (!tmp) return;
+            for (int16_t j = 0; j < dr.h; j++)
+                expandRow8(tmp + j * dr.w, s + (int32_t)j * canvas.width(), dr.w, lut);
+            uploadAndDrawTex(dr.x, dr.y, dr.w, dr.h, tmp);
+#endif
+            continue;
+        }
+        for (int16_t j = 0; j < dr.h; j++)
+            expandRow8(dst.pData + (int32_t)(dr.y + j) * dst.stride + dr.x,
+                       s + (int32_t)j * canvas.width(), dr.w, lut);
+        addDamage(dr.x, dr.y, dr.w, dr.h);
+    }
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  NUMERIC READOUT
+// ═════════════════════════════════════════════════════════════════════════════
+// Tiles are rendered straight into RGB565 memory, so draw() is nothing but a
+// blit() per changed cell.
+
+enum { SYM_MINUS = 10, SYM_BLANK = 11, SYM_POINT = 12 };
+
+// Segments a..g in bits 0..6, for '0'..'9' and '-'
+static const uint8_t s_sevenSeg[11] = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F, 0x40
+};
+
+static void tileFill(uint16_t *p, int32_t stride, int16_t tw, int16_t th,
+                     int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    GFXrect r = { x, y, w, h }, b = { 0, 0, tw, th };
+    if (!GFXrectIntersect(r, b, &r)) return;
+    for (int16_t j = 0; j < r.h; j++)
+        for (int16_t i = 0; i < r.w; i++)
+            p[(int32_t)(r.y + j) * stride + r.x + i] = color;
+}
+
+static int16_t readoutAdvance(const GFXfont *f, char c, uint8_t size) {
+    if (!f) return 6 * size;
+    if ((uint8_t)c < f->first || (uint8_t)c > f->last) return 0;
+    return f->glyph[(uint8_t)c - f->first].xAdvance * size;
+}
+
+// One character into a tile with the pen at (x, baseline); nullptr font =
+// classic 5×8 font standing on the baseline
+static void tileChar(uint16_t *p, int32_t stride, int16_t tw, int16_t th, int16_t x,
+                     int16_t baseline, const GFXfont *f, char c, uint8_t size, uint16_t color) {
+    uint8_t ch = (uint8_t)c;
+    if (!f) {
+        if (ch < 32 || ch > 126) ch = '?';
+        const uint8_t *cols = s_font + (ch - 32) * 5;
+        for (int16_t i = 0; i < 5; i++)
+            for (int16_t j = 0; j < 8; j++)
+                if ((cols[i] >> j) & 1)
+                    tileFill(p, stride, tw, th, x + i * size, baseline + (j - 8) * size,
+                             size, size, color);
+        return;
+    }
+    if (ch < f->first || ch > f->last) return;
+    const GFXglyph *g    = &f->glyph[ch - f->first];
+    const uint8_t  *bits = f->bitmap + g->bitmapOffset;
+    uint8_t bit = 0, bits8 = 0;
+    for (int16_t j = 0; j < g->height; j++)
+        for (int16_t i = 0; i < g->width; i++) {
+            if (!(bit++ & 7)) bits8 = *bits++;
+            if (bits8 & 0x80)
+                tileFill(p, stride, tw, th, x + (g->xOffset + i) * size,
+                         baseline + (g->yOffset + j) * size, size, size, color);
+            bits8 <<= 1;
+        }
+}
+
+GFXReadout::GFXReadout(uint8_t intDigits, uint8_t fracDigits, boolean bSigned)
+    : m_intDigits(MIN(MAX(intDigits, 1), GFX_READOUT_MAX_DIGITS)),
+      m_fracDigits(MIN(fracDigits, GFX_READOUT_MAX_DIGITS - m_intDigits)),
+      m_bSigned(bSigned), m_leadingZeros(false), m_x(0), m_y(0), m_value(0),
+      m_segments(false), m_pFont(nullptr), m_size(1), m_segW(0), m_segH(0), m_segT(0),
+      m_on(0xFFFF), m_off(0), m_bg(0),
+      m_pTiles(nullptr), m_pUnitTile(nullptr), m_tileW(0), m_tileH(0),
+      m_pointW(0), m_unitW(0), m_cells(0), m_pointX(0), m_unitX(0), m_staticValid(false)
+{
+    m_units[0] = '\0';
+    m_damage.clear();
+    invalidate();
+}
+
+GFXReadout::~GFXReadout() {
+    free(m_pTiles);
+    free(m_pUnitTile);
+}
+
+boolean GFXReadout::setFontStyle(const GFXfont *f, uint8_t size, uint16_t color, uint16_t bg) {
+    m_segments = false;
+    m_pFont    = f;
+    m_size     = size ? size : 1;
+    m_on       = color;
+    m_off      = bg;
+    m_bg       = bg;
+    return _render();
+}
+
+boolean GFXReadout::setSegmentStyle(int16_t digitW, int16_t digitH, int16_t thickness,
+                                    uint16_t on, uint16_t off, uint16_t bg) {
+    m_segments = true;
+    m_segT     = MAX(thickness, (int16_t)1);
+    m_segW     = MAX(digitW, (int16_t)(3 * m_segT));
+    m_segH     = MAX(digitH, (int16_t)(5 * m_segT));
+    m_on       = on;
+    m_off      = off;
+    m_bg       = bg;
+    return _render();
+}
+
+boolean GFXReadout::setUnits(const char *pUnits) {
+    strncpy(m_units, pUnits ? pUnits : "", sizeof(m_units) - 1);
+    m_units[sizeof(m_units) - 1] = '\0';
+    return m_pTiles ? _render() : true;     // re-render once styled
+}
+
+void GFXReadout::setLeadingZeros(boolean on) { m_leadingZeros = on; }
+
+void GFXReadout::setPosition(int16_t x, int16_t y) {
+    m_x = x;
+    m_y = y;
+    invalidate();
+}
+
+void GFXReadout::setValue(int32_t value) {
+    int32_t maxAbs = 1;
+    for (uint8_t i = 0; i < m_intDigits + m_fracDigits; i++) maxAbs *= 10;
+    maxAbs--;
+    m_value = MIN(MAX(value, m_bSigned ? -maxAbs : 0), maxAbs);
+}
+
+void GFXReadout::invalidate() {
+    memset(m_shown, 0xFF, sizeof(m_shown));
+    m_staticValid = false;
+}
+
+GFXrect GFXReadout::getBounds() const {
+    GFXrect r = { m_x, m_y, (int16_t)(m_unitX + m_unitW), m_tileH };
+    return r;
+}
+
+boolean GFXReadout::_render() {
+    free(m_pTiles);
+    free(m_pUnitTile);
+    m_pTiles = m_pUnitTile = nullptr;
+
+    // Cell metrics
+    int16_t baseline, unitBase;
+    uint8_t unitSize;
+    if (m_segments) {
+        m_tileW  = m_segW + m_segT;         // one stroke of spacing
+        m_tileH  = m_segH;
+        m_pointW = 2 * m_segT;
+        baseline = unitBase = m_tileH;
+        unitSize = (uint8_t)MAX(m_segH / 16, 1);
+    } else {
+        int16_t asc = 0, desc = 0;
+        m_tileW = 0;
+        for (const char *s = "0123456789-."; *s; s++)
+            if (*s != '.') m_tileW = MAX(m_tileW, readoutAdvance(m_pFont, *s, m_size));
+        if (!m_pFont) {                     // classic 5×8 font on the baseline
+            asc     = 8 * m_size;
+            m_tileH = 8 * m_size;
+        } else {
+            char all[32] = "0123456789-.";
+            strcat(all, m_units);
+            for (const char *s = all; *s; s++) {
+                uint8_t ch = (uint8_t)*s;
+                if (ch < m_pFont->first || ch > m_pFont->last) continue;
+                const GFXglyph *g = &m_pFont->glyph[ch - m_pFont->first];
+                asc  = MAX(asc,  (int16_t)(-g->yOffset * m_size));
+                desc = MAX(desc, (int16_t)((g->yOffset + g->height) * m_size));
+            }
+            m_tileH = MAX((int16_t)(m_pFont->yAdvance * m_size), (int16_t)(asc + desc));
+        }
+        m_pointW = readoutAdvance(m_pFont, '.', m_size);
+        baseline = unitBase = asc;
+        unitSize = m_size;
+    }
+    const GFXfont *unitFont = m_segments ? nullptr : m_pFont;
+    int16_t gap = m_units[0] ? m_tileW / 4 : 0;
+    m_unitW = gap;
+    for (const char *s = m_units; *s; s++) m_unitW += readoutAdvance(unitFont, *s, unitSize);
+    if (!m_units[0]) m_unitW = 0;
+
+    int32_t stride = (int32_t)GFX_READOUT_SYMBOLS * m_tileW;
+    m_pTiles = (uint16_t *)malloc((size_t)stride * m_tileH * 2);
+    if (m_unitW) m_pUnitTile = (uint16_t *)malloc((size_t)m_unitW * m_tileH * 2);
+    if (!m_pTiles || (m_unitW && !m_pUnitTile)) {
+        free(m_pTiles);
+        free(m_pUnitTile);
+        m_pTiles = m_pUnitTile = nullptr;
+        return false;
+    }
+
+    // Symbols, each in its own tile
+    tileFill(m_pTiles, stride, (int16_t)stride, m_tileH, 0, 0, (int16_t)stride, m_tileH, m_bg);
+    for (uint8_t sym = 0; sym < GFX_READOUT_SYMBOLS; sym++) {
+        uint16_t *t = m_pTiles + sym * m_tileW;
+        if (m_segments) {
+            int16_t W = m_segW, H = m_segH, T = m_segT;
+            int16_t hu = (H - 3 * T) / 2, hl = H - 3 * T - hu;   // upper / lower stroke length
+            if (sym == SYM_POINT) {
+                tileFill(t, stride, m_tileW, H, T / 2, H - T, T, T, m_on);
+                continue;
+            }
+            uint8_t on = sym <= SYM_MINUS ? s_sevenSeg[sym] : 0;
+            const GFXrect seg[7] = {
+                { T,     0,          (int16_t)(W - 2 * T), T  },   // a
+                { (int16_t)(W - T), T,              T, hu },      // b
+                { (int16_t)(W - T), (int16_t)(2 * T + hu), T, hl }, // c
+                { T,     (int16_t)(H - T),      (int16_t)(W - 2 * T), T }, // d
+                { 0,     (int16_t)(2 * T + hu), T, hl },            // e
+                { 0,     T,              T, hu },                   // f
+                { T,     (int16_t)(T + hu),     (int16_t)(W - 2 * T), T }  // g
+            };
+            for (uint8_t k = 0; k < 7; k++)
+                tileFill(t, stride, m_tileW, H, seg[k].x, seg[k].y, seg[k].w, seg[k].h,
+                         ((on >> k) & 1) ? m_on : m_off);
+        } else if (sym != SYM_BLANK) {
+            char c = sym < 10 ? (char)('0' + sym) : sym == SYM_MINUS ? '-' : '.';
+            int16_t w = sym == SYM_POINT ? m_pointW : m_tileW;
+            tileChar(t, stride, w, m_tileH, (w - readoutAdvance(m_pFont, c, m_size)) / 2,
+                     baseline, m_pFont, c, m_size, m_on);
+        }
+    }
+
+    // Units, after a small gap
+    if (m_pUnitTile) {
+        tileFill(m_pUnitTile, m_unitW, m_unitW, m_tileH, 0, 0, m_unitW, m_tileH, m_bg);
+        int16_t pen = gap;
+        for (const char *s = m_units; *s; s++) {
+            tileChar(m_pUnitTile, m_unitW, m_unitW, m_tileH, pen, unitBase,
+                     unitFont, *s, unitSize, m_on);
+            pen += readoutAdvance(unitFont, *s, unitSize);
+        }
+    }
+
+    // Layout: [sign] integer digits [point] fraction digits [units]
+    int16_t x = 0;
+    m_cells = 0;
+    if (m_bSigned) { m_cellX[m_cells++] = x; x += m_tileW; }
+    for (uint8_t i = 0; i < m_intDigits; i++)  { m_cellX[m_cells++] = x; x += m_tileW; }
+    m_pointX = x;
+    if (m_fracDigits) x += m_pointW;
+    for (uint8_t i = 0; i < m_fracDigits; i++) { m_cellX[m_cells++] = x; x += m_tileW; }
+    m_unitX = x;
+
+    invalidate();
+    return true;
+}
+
+// Symbol per cell for the current value
+void GFXReadout::_symbols(uint8_t *pSym) const {
+    uint8_t  nd = m_intDigits + m_fracDigits;
+    uint8_t *d  = pSym + (m_bSigned ? 1 : 0);
+    uint32_t a  = m_value < 0 ? (uint32_t)(-(int64_t)m_value) : (uint32_t)m_value;
+    for (int8_t k = nd - 1; k >= 0; k--) {
+        d[k] = (uint8_t)(a % 10);
+        a /= 10;
+    }
+    if (m_bSigned) pSym[0] = SYM_BLANK;
+    uint8_t first = 0;                      // first significant integer digit
+    if (!m_leadingZeros)
+        for (; first < m_intDigits - 1 && d[first] == 0; first++) d[first] = SYM_BLANK;
+    // The minus sign sits right in front of the number
+    if (m_value < 0) {
+        if (first) d[first - 1] = SYM_MINUS;
+        else       pSym[0]      = SYM_MINUS;
+    }
+}
+
+uint8_t GFXReadout::draw(CircleGFX &gfx) {
+    m_damage.clear();
+    if (!m_pTiles) return 0;
+    GFXsurface tiles = { m_pTiles, (int16_t)(GFX_READOUT_SYMBOLS * m_tileW), m_tileH,
+                         (int32_t)GFX_READOUT_SYMBOLS * m_tileW };
+
+    if (!m_staticValid) {
+        if (m_fracDigits) {
+            GFXrect sr = { (int16_t)(SYM_POINT * m_tileW), 0, m_pointW, m_tileH };
+            GFXrect dr = { (int16_t)(m_x + m_pointX), m_y, m_pointW, m_tileH };
+            gfx.blit(tiles, sr, dr.x, dr.y);
+            m_damage.add(dr);
+        }
+        if (m_pUnitTile) {
+            GFXsurface units = { m_pUnitTile, m_unitW, m_tileH, m_unitW };
+            GFXrect sr = { 0, 0, m_unitW, m_tileH };
+            GFXrect dr = { (int16_t)(m_x + m_unitX), m_y, m_unitW, m_tileH };
+            gfx.blit(units, sr, dr.x, dr.y);
+            m_damage.add(dr);
+        }
+        m_staticValid = true;
+    }
+
+    uint8_t sym[GFX_READOUT_MAX_DIGITS + 1], n = 0;
+    _symbols(sym);
+    for (uint8_t i = 0; i < m_cells; i++) {
+        if (sym[i] == m_shown[i]) continue;
+        GFXrect sr = { (int16_t)(sym[i] * m_tileW), 0, m_tileW, m_tileH };
+        GFXrect dr = { (int16_t)(m_x + m_cellX[i]), m_y, m_tileW, m_tileH };
+        gfx.blit(tiles, sr, dr.x, dr.y);
+        m_damage.add(dr);
+        m_shown[i] = sym[i];
+        n++;
+    }
+    return n;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  GAUGE
+// ═════════════════════════════════════════════════════════════════════════════
+// Angles are kept in 1/256 degree, clockwise from 12 o'clock, and turned
+// into directions with a fixed-point sine table (no libm on bare metal).
+
+// sin(0..90°) in Q14
+static const int16_t s_sinQ14[91] = {
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384
+};
+
+// sin of an angle in 1/256 degree, Q14, linearly interpolated
+static int32_t sinQ14(int32_t a) {
+    a %= 360 * 256;
+    if (a < 0) a += 360 * 256;
+    int32_t sign = 1;
+    if (a >= 180 * 256) { a -= 180 * 256; sign = -1; }
+    if (a > 90 * 256) a = 180 * 256 - a;
+    int32_t i = a >> 8, f = a & 0xFF;
+    int32_t v = s_sinQ14[i];
+    if (i < 90) v += ((s_sinQ14[i + 1] - v) * f) >> 8;
+    return sign * v;
+}
+
+static int fmtInt(char *pBuf, int32_t v) {
+    char tmp[12];
+    int n = 0, len = 0;
+    uint32_t a = v < 0 ? (uint32_t)(-(int64_t)v) : (uint32_t)v;
+    do { tmp[n++] = (char)('0' + a % 10); a /= 10; } while (a);
+    if (v < 0) pBuf[len++] = '-';
+    while (n) pBuf[len++] = tmp[--n];
+    pBuf[len] = '\0';
+    return len;
+}
+
+GFXGauge::GFXGauge(int16_t cx, int16_t cy, int16_t radius)
+    : m_cx(cx), m_cy(cy), m_radius(MAX(radius, (int16_t)8)),
+      m_min(0), m_max(100), m_startDeg(-135), m_sweepDeg(270),
+      m_nBands(0), m_needleLen(0), m_needleW(3),
+      m_pfnPainter(nullptr), m_pPainterParam(nullptr),
+      m_pFace(nullptr), m_value(0), m_shownAngle(0), m_faceShown(false)
+{
+    GFXgaugeStyle style = { 0x0000, 0x2104, 0xFFFF, 0xF800, 0xC618, 10, 5, nullptr, 1 };
+    m_style     = style;
+    m_needleLen = m_radius * 4 / 5;
+    m_damage.clear();
+}
+
+GFXGauge::~GFXGauge() {
+    delete m_pFace;
+}
+
+void GFXGauge::setRange(int32_t minValue, int32_t maxValue, int16_t startDeg, int16_t sweepDeg) {
+    m_min      = minValue;
+    m_max      = maxValue != minValue ? maxValue : minValue + 1;
+    m_startDeg = startDeg;
+    m_sweepDeg = sweepDeg;
+}
+
+void GFXGauge::setStyle(const GFXgaugeStyle &style) { m_style = style; }
+
+boolean GFXGauge::addBand(int32_t from, int32_t to, uint16_t color) {
+    if (m_nBands >= GFX_GAUGE_MAX_BANDS) return false;
+    GFXgaugeBand b = { from, to, color };
+    m_bands[m_nBands++] = b;
+    return true;
+}
+
+void GFXGauge::clearBands() { m_nBands = 0; }
+
+void GFXGauge::setNeedle(int16_t length, uint8_t width) {
+    m_needleLen = MIN(MAX(length, (int16_t)1), (int16_t)(m_radius - 2));
+    m_needleW   = width ? width : 1;
+    invalidate();
+}
+
+void GFXGauge::setFacePainter(GFXgaugePainter pfn, void *pParam) {
+    m_pfnPainter    = pfn;
+    m_pPainterParam = pParam;
+}
+
+void GFXGauge::setValue(int32_t value) { m_value = value; }
+
+void GFXGauge::invalidate() { m_faceShown = false; }
+
+GFXrect GFXGauge::getBounds() const {
+    GFXrect r = { (int16_t)(m_cx - m_radius), (int16_t)(m_cy - m_radius),
+                  (int16_t)(2 * m_radius + 1), (int16_t)(2 * m_radius + 1) };
+    return r;
+}
+
+int32_t GFXGauge::_angle(int32_t value) const {
+    int32_t lo = MIN(m_min, m_max), hi = MAX(m_min, m_max);
+    value = MIN(MAX(value, lo), hi);
+    return m_startDeg * 256 +
+           (int32_t)((int64_t)(value - m_min) * m_sweepDeg * 256 / (m_max - m_min));
+}
+
+// Offset of the point at radius r (1/256 px) along angle, in 1/256 px
+void GFXGauge::_point(int32_t angle, int32_t r, int32_t *pX, int32_t *pY) const {
+    *pX =  (int32_t)(((int64_t)r * sinQ14(angle)) >> 14);
+    *pY = -(int32_t)(((int64_t)r * sinQ14(angle + 90 * 256)) >> 14);
+}
+
+void GFXGauge::pointAt(int32_t value, int16_t r, int16_t *pX, int16_t *pY) const {
+    int32_t dx, dy;
+    _point(_angle(value), (int32_t)r * 256, &dx, &dy);
+    *pX = (int16_t)(m_radius + ((dx + 128) >> 8));
+    *pY = (int16_t)(m_radius + ((dy + 128) >> 8));
+}
+
+boolean GFXGauge::renderFace(CircleGFX &gfx) {
+    int16_t size = 2 * m_radius + 1, R = m_radius;
+    if (!m_pFace) {
+        m_pFace = new GFXcanvas16(size, size);
+        if (!m_pFace->getBuffer()) {
+            delete m_pFace;
+            m_pFace = nullptr;
+            return false;
+        }
+    }
+    GFXcanvas16 *pPrev = gfx.getDrawTarget();
+    GFXrect      clip  = gfx.getClipRect();
+    gfx.setDrawTarget(m_pFace);
+
+    gfx.fillRect(0, 0, size, size, m_style.bg);
+    gfx.fillCircle(R, R, R, m_style.face);
+    gfx.drawCircle(R, R, R, m_style.rim);
+
+    // Bands: a ring just inside the rim, as quads of at most 2°
+    int16_t rOut = R - 3, rIn = R - 3 - MAX(R / 12, 2);
+    for (uint8_t b = 0; b < m_nBands; b++) {
+        int32_t a0 = _angle(m_bands[b].from), a1 = _angle(m_bands[b].to);
+        if (a0 > a1) { int32_t t = a0; a0 = a1; a1 = t; }
+        for (int32_t a = a0; a < a1; a += 2 * 256) {
+            int32_t e = MIN(a + 2 * 256, a1), p[8];
+            _point(a, rOut * 256, &p[0], &p[1]);
+            _point(e, rOut * 256, &p[2], &p[3]);
+            _point(e, rIn * 256,  &p[4], &p[5]);
+            _point(a, rIn * 256,  &p[6], &p[7]);
+            int16_t q[8];
+            for (uint8_t k = 0; k < 8; k++) q[k] = (int16_t)(R + ((p[k] + 128) >> 8));
+            gfx.fillTriangle(q[0], q[1], q[2], q[3], q[4], q[5], m_bands[b].color);
+            gfx.fillTriangle(q[0], q[1], q[4], q[5], q[6], q[7], m_bands[b].color);
+        }
+    }
+
+    // Ticks and labels
+    uint16_t nTicks = m_style.majorTicks * MAX(m_style.minorTicks, (uint8_t)1);
+    int16_t  major  = MAX(R / 8, 3);
+    for (uint16_t i = 0; m_style.majorTicks && i <= nTicks; i++) {
+        boolean isMajor = i % MAX(m_style.minorTicks, (uint8_t)1) == 0;
+        int32_t a = m_startDeg * 256 + (int32_t)m_sweepDeg * 256 * i / nTicks, x0, y0, x1, y1;
+        _point(a, (R - 2) * 256, &x0, &y0);
+        _point(a, (R - 2 - (isMajor ? major : major / 2)) * 256, &x1, &y1);
+        gfx.drawLine(R + ((x0 + 128) >> 8), R + ((y0 + 128) >> 8),
+                     R + ((x1 + 128) >> 8), R + ((y1 + 128) >> 8), m_style.rim);
+        if (!isMajor || !m_style.labelSize) continue;
+
+        // Label centred inside the tick, drawn straight into the canvas
+        char text[12];
+        int32_t v = m_min + (int32_t)((int64_t)(m_max - m_min) * i / nTicks);
+        int len = fmtInt(text, v);
+        const GFXfont *f = m_style.pLabelFont;
+        uint8_t sz = m_style.labelSize;
+        int16_t tw = 0, th = f ? f->yAdvance * sz : 8 * sz;
+        for (int k = 0; k < len; k++) tw += readoutAdvance(f, text[k], sz);
+        int32_t cx, cy;
+        _point(a, (R - 4 - major) * 256 - (MAX(tw, th) / 2 + 1) * 256, &cx, &cy);
+        int16_t pen  = R + ((cx + 128) >> 8) - tw / 2;
+        int16_t base = R + ((cy + 128) >> 8) + (f ? th / 3 : th / 2);
+        for (int k = 0; k < len; k++) {
+            tileChar(m_pFace->getBuffer(), size, size, size, pen, base, f, text[k], sz, m_style.rim);
+            pen += readoutAdvance(f, text[k], sz);
+        }
+    }
+
+    if (m_pfnPainter) m_pfnPainter(gfx, *this, m_pPainterParam);
+
+    gfx.setDrawTarget(pPrev);
+    GFXrect full = gfx.getClipRect();
+    if (clip.x != full.x || clip.y != full.y || clip.w != full.w || clip.h != full.h)
+        gfx.setClipRect(clip.x, clip.y, clip.w, clip.h);
+    invalidate();
+    return true;
+}
+
+// Needle triangle-ish shape: the half width narrows from the hub to the tip
+GFXrect GFXGauge::_needleBox(int32_t angle) const {
+    int32_t tx, ty;
+    _point(angle, m_needleLen * 256, &tx, &ty);
+    int16_t hub = MAX((int16_t)(m_needleW * 2), (int16_t)3);
+    int16_t x0 = MIN((int16_t)((tx >> 8) - 2), (int16_t)-hub), x1 = MAX((int16_t)((tx >> 8) + 3), hub);
+    int16_t y0 = MIN((int16_t)((ty >> 8) - 2), (int16_t)-hub), y1 = MAX((int16_t)((ty >> 8) + 3), hub);
+    GFXrect r = { (int16_t)(m_cx + x0), (int16_t)(m_cy + y0),
+                  (int16_t)(x1 - x0 + 1), (int16_t)(y1 - y0 + 1) }, out;
+    GFXrectIntersect(r, getBounds(), &out);
+    return out;
+}
+
+void GFXGauge::_drawNeedle(CircleGFX &gfx, int32_t angle) const {
+    GFXrect box = _needleBox(angle), r;
+    if (!GFXrectIntersect(box, gfx.getClipRect(), &r)) return;
+
+    // Unit direction in Q8; distances below are in 1/256 px
+    int32_t nx = sinQ14(angle) >> 6, ny = -(sinQ14(angle + 90 * 256) >> 6);
+    int32_t len = m_needleLen * 256, hw = m_needleW * 128;
+    int32_t taper = ((hw - 64) << 8) / MAX(m_needleLen, (int16_t)1);   // per px of length
+    GFXsurface dst = gfx.getDrawSurface();
+    gfx.startWrite();
+    for (int16_t y = r.y; y < r.y + r.h; y++) {
+        int32_t py = (y - m_cy) * 256;
+        uint16_t *d = dst.pData ? dst.pData + (int32_t)y * dst.stride : nullptr;
+        for (int16_t x = r.x; x < r.x + r.w; x++) {
+            int32_t px   = (x - m_cx) * 256;
+            int32_t t    = (px * nx + py * ny) >> 8;
+            int32_t perp = (px * ny - py * nx) >> 8;
+            int32_t w    = hw - ((MAX(t, (int32_t)0) * taper) >> 16);
+            int32_t c1   = MIN(MAX(w + 128 - ABS(perp), (int32_t)0), (int32_t)256);
+            int32_t c2   = MIN(MAX(len - t + 128, (int32_t)0), (int32_t)256);
+            int32_t a    = (c1 * c2) >> 8;
+            if (t < -hw) a = 0;
+            if (!a) continue;
+            if (d) d[x] = gfxBlend565(d[x], m_style.needle, (uint16_t)a);
+            else if (a >= 128) gfx.writePixel(x, y, m_style.needle);
+        }
+    }
+    gfx.endWrite();
+    if (dst.pData) gfx.addDamage(r.x, r.y, r.w, r.h);
+    gfx.fillCircle(m_cx, m_cy, MAX((int16_t)(m_needleW * 2), (int16_t)3) - 1, m_style.hub);
+}
+
+void GFXGauge::draw(CircleGFX &gfx) {
+    m_damage.clear();
+    if (!m_pFace) return;
+    int32_t angle  = _angle(m_value);
+    GFXrect bounds = getBounds();
+    if (!m_faceShown) {
+        gfx.blit(*m_pFace, bounds.x, bounds.y);
+        m_damage.add(bounds);
+    } else {
+        if (angle == m_shownAngle) return;
+        GFXrect old = _needleBox(m_shownAngle);
+        GFXrect sr  = { (int16_t)(old.x - bounds.x), (int16_t)(old.y - bounds.y), old.w, old.h };
+        gfx.blit(m_pFace->getSurface(), sr, old.x, old.y);
+        m_damage.add(old);
+        m_damage.add(_needleBox(angle));
+    }
+    _drawNeedle(gfx, angle);
+    m_shownAngle = angle;
+    m_faceShown  = true;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  SPATIAL INDEX
+// ═════════════════════════════════════════════════════════════════════════════
+
+GFXSpatialGrid::GFXSpatialGrid(int16_t width, int16_t height, uint8_t cellShift)
+    : m_shift(cellShift), m_cols(0), m_rows(0), m_pBuckets(nullptr), m_pEntries(nullptr),
+      m_capacity(0), m_used(0), m_freeId(-1), m_count(0), m_stamp(0)
+{
+    m_cols = (int16_t)MAX((width  + (1 << m_shift) - 1) >> m_shift, 1);
+    m_rows = (int16_t)MAX((height + (1 << m_shift) - 1) >> m_shift, 1);
+    m_pBuckets = (Bucket *)calloc((size_t)m_cols * m_rows, sizeof(Bucket));
+    if (!m_pBuckets) m_cols = m_rows = 0;
+}
+
+GFXSpatialGrid::~GFXSpatialGrid() {
+    for (int32_t i = 0; m_pBuckets && i < (int32_t)m_cols * m_rows; i++)
+        free(m_pBuckets[i].pIds);
+    free(m_pBuckets);
+    free(m_pEntries);
+}
+
+void GFXSpatialGrid::_cells(const GFXrect &r, int16_t *pC0, int16_t *pR0,
+                            int16_t *pC1, int16_t *pR1) const {
+    if (r.w <= 0 || r.h <= 0 || !m_cols) {
+        *pC0 = *pR0 = 0;
+        *pC1 = *pR1 = -1;
+        return;
+    }
+    *pC0 = (int16_t)MIN(MAX(r.x >> m_shift, 0), m_cols - 1);
+    *pR0 = (int16_t)MIN(MAX(r.y >> m_shift, 0), m_rows - 1);
+    *pC1 = (int16_t)MIN(MAX((r.x + r.w - 1) >> m_shift, 0), m_cols - 1);
+    *pR1 = (int16_t)MIN(MAX((r.y + r.h - 1) >> m_shift, 0), m_rows - 1);
+}
+
+void GFXSpatialGrid::_link(int32_t id) {
+    Entry &e = m_pEntries[id];
+    for (int16_t row = e.r0; row <= e.r1; row++)
+        for (int16_t col = e.c0; col <= e.c1; col++) {
+            Bucket &b = m_pBuckets[row * m_cols + col];
+            if (b.count == b.capacity) {
+                uint16_t cap = b.capacity ? b.capacity * 2 : 4;
+                int32_t *p = (int32_t *)realloc(b.pIds, cap * sizeof(int32_t));
+                if (!p) continue;           // the item just won't be found here
+                b.pIds     = p;
+                b.capacity = cap;
+            }
+            b.pIds[b.count++] = id;
+        }
+}
+
+void GFXSpatialGrid::_unlink(int32_t id) {
+    Entry &e = m_pEntries[id];
+    for (int16_t row = e.r0; row <= e.r1; row++)
+        for (int16_t col = e.c0; col <= e.c1; col++) {
+            Bucket &b = m_pBuckets[row * m_cols + col];
+            for (uint16_t i = 0; i < b.count; i++)
+                if (b.pIds[i] == id) {
+                    b.pIds[i] = b.pIds[--b.count];
+                    break;
+                }
+        }
+}
+
+int32_t GFXSpatialGrid::insert(void *pItem, const GFXrect &r) {
+    if (!pItem) return -1;
+    int32_t id = m_freeId;
+    if (id >= 0) {
+        m_freeId = m_pEntries[id].nextFree;
+    } else {
+        if (m_used == m_capacity) {
+            int32_t cap = m_capacity ? m_capacity * 2 : 32;
+            Entry *p = (Entry *)realloc(m_pEntries, cap * sizeof(Entry));
+            if (!p) return -1;
+            m_pEntries = p;
+            m_capacity = cap;
+        }
+        id = m_used++;
+    }
+    Entry &e   = m_pEntries[id];
+    e.pItem    = pItem;
+    e.rect     = r;
+    e.stamp    = m_stamp;
+    e.nextFree = -1;
+    _cells(r, &e.c0, &e.r0, &e.c1, &e.r1);
+    _link(id);
+    m_count++;
+    return id;
+}
+
+void GFXSpatialGrid::update(int32_t id, const GFXrect &r) {
+    if (id < 0 || id >= m_used || !m_pEntries[id].pItem) return;
+    Entry &e = m_pEntries[id];
+    int16_t c0, r0, c1, r1;
+    _cells(r, &c0, &r0, &c1, &r1);
+    e.rect = r;
+    if (c0 == e.c0 && r0 == e.r0 && c1 == e.c1 && r1 == e.r1) return;
+    _unlink(id);
+    e.c0 = c0; e.r0 = r0; e.c1 = c1; e.r1 = r1;
+    _link(id);
+}
+
+void GFXSpatialGrid::remove(int32_t id) {
+    if (id < 0 || id >= m_used || !m_pEntries[id].pItem) return;
+    _unlink(id);
+    m_pEntries[id].pItem    = nullptr;
+    m_pEntries[id].nextFree = m_freeId;
+    m_freeId = id;
+    m_count--;
+}
+
+uint16_t GFXSpatialGrid::queryPoint(int16_t x, int16_t y, void **ppOut, uint16_t maxOut) {
+    GFXrect r = { x, y, 1, 1 };
+    return queryRect(r, ppOut, maxOut);
+}
+
+uint16_t GFXSpatialGrid::queryRect(const GFXrect &r, void **ppOut, uint16_t maxOut) {
+    int16_t c0, r0, c1, r1;
+    _cells(r, &c0, &r0, &c1, &r1);
+    uint16_t n = 0;
+    m_stamp++;
+    for (int16_t row = r0; row <= r1; row++)
+        for (int16_t col = c0; col <= c1; col++) {
+            const Bucket &b = m_pBuckets[row * m_cols + col];
+            for (uint16_t i = 0; i < b.count && n < maxOut; i++) {
+                Entry &e = m_pEntries[b.pIds[i]];
+                GFXrect o;
+                if (e.stamp == m_stamp) continue;
+                e.stamp = m_stamp;
+                if (GFXrectIntersect(e.rect, r, &o)) ppOut[n++] = e.pItem;
+            }
+        }
+    return n;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  RETAINED WIDGETS
+// ═════════════════════════════════════════════════════════════════════════════
+
+static inline boolean rectContains(const GFXrect &outer, const GFXrect &inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+}
+
+// ─── GFXWidget ───────────────────────────────────────────────────────────────
+
+GFXWidget::GFXWidget(int16_t x, int16_t y, int16_t w, int16_t h, boolean bOpaque)
+    : m_z(0), m_bOpaque(bOpaque), m_bVisible(true),
+      m_pParent(nullptr), m_pFirstChild(nullptr), m_pNext(nullptr), m_pTree(nullptr),
+      m_gridId(-1), m_order(0)
+{
+    GFXrect r = { x, y, w, h };
+    m_bounds = r;
+}
+
+GFXWidget::~GFXWidget() {
+    if (m_pParent)    m_pParent->removeChild(this);
+    else if (m_pTree) m_pTree->remove(this);
+    for (GFXWidget *c = m_pFirstChild, *next; c; c = next) {
+        next = c->m_pNext;
+        c->m_pParent = nullptr;
+        c->m_pNext   = nullptr;
+    }
+}
+
+// Insert into a sibling list, after any siblings of the same z
+void GFXWidget::_link(GFXWidget **ppFirst) {
+    while (*ppFirst && (*ppFirst)->m_z <= m_z) ppFirst = &(*ppFirst)->m_pNext;
+    m_pNext  = *ppFirst;
+    *ppFirst = this;
+}
+
+void GFXWidget::_unlink(GFXWidget **ppFirst) {
+    while (*ppFirst && *ppFirst != this) ppFirst = &(*ppFirst)->m_pNext;
+    if (*ppFirst) *ppFirst = m_pNext;
+    m_pNext = nullptr;
+}
+
+void GFXWidget::_setTree(GFXWidgetTree *pTree) {
+    if (pTree != m_pTree) {
+        if (m_pTree) {
+            m_pTree->m_grid.remove(m_gridId);
+            m_pTree->m_orderDirty = true;
+        }
+        m_gridId = pTree ? pTree->m_grid.insert(this, m_bounds) : -1;
+        m_pTree  = pTree;
+    }
+    if (pTree) pTree->m_orderDirty = true;
+    for (GFXWidget *c = m_pFirstChild; c; c = c->m_pNext) c->_setTree(pTree);
+}
+
+void GFXWidget::addChild(GFXWidget *pChild) {
+    if (!pChild || pChild == this) return;
+    if (pChild->m_pParent)    pChild->m_pParent->removeChild(pChild);
+    else if (pChild->m_pTree) pChild->m_pTree->remove(pChild);
+    pChild->m_pParent = this;
+    pChild->_link(&m_pFirstChild);
+    pChild->_setTree(m_pTree);
+    pChild->invalidate();
+}
+
+void GFXWidget::removeChild(GFXWidget *pChild) {
+    if (!pChild || pChild->m_pParent != this) return;
+    pChild->invalidate();                   // uncovers what was below
+    pChild->_unlink(&m_pFirstChild);
+    pChild->m_pParent = nullptr;
+    pChild->_setTree(nullptr);
+}
+
+void GFXWidget::setBounds(int16_t x, int16_t y, int16_t w, int16_t h) {
+    invalidate();
+    GFXrect r = { x, y, w, h };
+    m_bounds = r;
+    if (m_pTree) m_pTree->m_grid.update(m_gridId, m_bounds);
+    invalidate();
+}
+
+void GFXWidget::moveTo(int16_t x, int16_t y) { setBounds(x, y, m_bounds.w, m_bounds.h); }
+
+void GFXWidget::setZ(int16_t z) {
+    if (z == m_z) return;
+    GFXWidget **ppFirst = m_pParent ? &m_pParent->m_pFirstChild
+                        : m_pTree   ? &m_pTree->m_pFirst : nullptr;
+    if (ppFirst) _unlink(ppFirst);
+    m_z = z;
+    if (ppFirst) _link(ppFirst);
+    if (m_pTree) m_pTree->m_orderDirty = true;
+    invalidate();
+}
+
+void GFXWidget::setOpaque(boolean bOpaque) {
+    m_bOpaque = bOpaque;
+    invalidate();
+}
+
+void GFXWidget::setVisible(boolean bVisible) {
+    if (bVisible == m_bVisible) return;
+    invalidate();                           // while still visible ...
+    m_bVisible = bVisible;
+    invalidate();                           // ... and once it is
+}
+
+GFXrect GFXWidget::getVisibleBounds() const {
+    GFXrect r = m_bounds;
+    if (!m_pTree || !m_bVisible) r.w = r.h = 0;
+    for (const GFXWidget *p = m_pParent; p && r.w; p = p->m_pParent)
+        if (!p->m_bVisible || !GFXrectIntersect(r, p->m_bounds, &r)) r.w = r.h = 0;
+    return r;
+}
+
+void GFXWidget::invalidate() {
+    invalidate(m_bounds);
+}
+
+void GFXWidget::invalidate(const GFXrect &r) {
+    GFXrect v = getVisibleBounds(), o;
+    if (m_pTree && v.w && GFXrectIntersect(r, v, &o)) m_pTree->invalidate(o);
+}
+
+// ─── GFXWidgetTree ───────────────────────────────────────────────────────────
+
+GFXWidgetTree::GFXWidgetTree(CircleGFX *pGFX)
+    : m_pGFX(pGFX), m_pFirst(nullptr), m_grid(pGFX->width(), pGFX->height()),
+      m_orderDirty(false), m_bg(0x0000),
+      m_ppPaint(nullptr), m_pVisible(nullptr), m_paintSize(0)
+{
+    m_invalid.clear();
+}
+
+GFXWidgetTree::~GFXWidgetTree() {
+    for (GFXWidget *w = m_pFirst, *next; w; w = next) {
+        next = w->m_pNext;
+        w->_setTree(nullptr);
+        w->m_pNext = nullptr;
+    }
+    free(m_ppPaint);
+    free(m_pVisible);
+}
+
+void GFXWidgetTree::add(GFXWidget *pWidget) {
+    if (!pWidget) return;
+    if (pWidget->m_pParent)    pWidget->m_pParent->removeChild(pWidget);
+    else if (pWidget->m_pTree) pWidget->m_pTree->remove(pWidget);
+    pWidget->_link(&m_pFirst);
+    pWidget->_setTree(this);
+    pWidget->invalidate();
+}
+
+void GFXWidgetTree::remove(GFXWidget *pWidget) {
+    if (!pWidget || pWidget->m_pTree != this || pWidget->m_pParent) return;
+    pWidget->invalidate();
+    pWidget->_unlink(&m_pFirst);
+    pWidget->_setTree(nullptr);
+}
+
+void GFXWidgetTree::setBackground(uint16_t color) {
+    m_bg = color;
+    invalidateAll();
+}
+
+void GFXWidgetTree::invalidate(const GFXrect &r) {
+    GFXrect screen = { 0, 0, m_pGFX->width(), m_pGFX->height() }, o;
+    if (GFXrectIntersect(r, screen, &o)) m_invalid.add(o);
+}
+
+void GFXWidgetTree::invalidateAll() {
+    GFXrect screen = { 0, 0, m_pGFX->width(), m_pGFX->height() };
+    m_invalid.clear();
+    m_invalid.add(screen);
+}
+
+// Room for n entries in the paint list scratch
+boolean GFXWidgetTree::_reserve(uint32_t n) {
+    if (n <= m_paintSize) return true;
+    uint32_t size = MAX(n, (uint32_t)m_paintSize * 2);
+    size = MIN(MAX(size, (uint32_t)32), (uint32_t)0xFFFF);
+    GFXWidget **pp = (GFXWidget **)realloc(m_ppPaint, size * sizeof(GFXWidget *));
+    if (pp) m_ppPaint = pp;
+    GFXrect *pv = (GFXrect *)realloc(m_pVisible, size * sizeof(GFXrect));
+    if (pv) m_pVisible = pv;
+    if (!pp || !pv) return false;
+    m_paintSize = (uint16_t)size;
+    return true;
+}
+
+// Paint order is depth-first: parents before children, siblings by z
+uint32_t GFXWidgetTree::_number(GFXWidget *pFirst, uint32_t order) {
+    for (GFXWidget *w = pFirst; w; w = w->m_pNext) {
+        w->m_order = order++;
+        order = _number(w->m_pFirstChild, order);
+    }
+    return order;
+}
+
+void GFXWidgetTree::_renumber() {
+    if (!m_orderDirty) return;
+    _number(m_pFirst, 0);
+    m_orderDirty = false;
+}
+
+// The widgets reaching into r, in paint order, with the part of each that
+// is visible there
+uint16_t GFXWidgetTree::_collect(const GFXrect &r) {
+    _renumber();
+    _reserve(m_grid.count());
+    uint16_t n = m_grid.queryRect(r, (void **)m_ppPaint, m_paintSize), k = 0;
+    for (uint16_t i = 0; i < n; i++) {
+        GFXWidget *w = m_ppPaint[i];
+        GFXrect v;
+        if (!GFXrectIntersect(w->getVisibleBounds(), r, &v)) continue;
+        // Insertion sort by paint order; the lists are short
+        uint16_t j = k++;
+        for (; j > 0 && m_ppPaint[j - 1]->m_order > w->m_order; j--) {
+            m_ppPaint[j]  = m_ppPaint[j - 1];
+            m_pVisible[j] = m_pVisible[j - 1];
+        }
+        m_ppPaint[j]  = w;
+        m_pVisible[j] = v;
+    }
+    return k;
+}
+
+GFXWidget *GFXWidgetTree::hitTest(int16_t x, int16_t y) {
+    GFXrect r = { x, y, 1, 1 };
+    uint16_t n = _collect(r);
+    return n ? m_ppPaint[n - 1] : nullptr;
+}
+
+uint16_t GFXWidgetTree::findWidgets(const GFXrect &r, GFXWidget **ppOut, uint16_t maxOut) {
+    uint16_t n = MIN(_collect(r), maxOut);
+    memcpy(ppOut, m_ppPaint, n * sizeof(GFXWidget *));
+    return n;
+}
+
+void GFXWidgetTree::_paintRect(const GFXrect &r) {
+    uint16_t n = _collect(r), first = 0;
+
+    // Everything below the topmost opaque widget covering r is hidden
+    boolean covered = false;
+    for (uint16_t i = n; i-- > 0; )
+        if (m_ppPaint[i]->m_bOpaque && rectContains(m_pVisible[i], r)) {
+            first   = i;
+            covered = true;
+            break;
+        }
+    if (!covered) {
+        m_pGFX->setClipRect(r.x, r.y, r.w, r.h);
+        m_pGFX->fillRect(r.x, r.y, r.w, r.h, m_bg);
+    }
+
+    for (uint16_t i = first; i < n; i++) {
+        boolean hidden = false;
+        for (uint16_t j = i + 1; j < n && !hidden; j++)
+            hidden = m_ppPaint[j]->m_bOpaque && rectContains(m_pVisible[j], m_pVisible[i]);
+        if (hidden) continue;
+        const GFXrect &v = m_pVisible[i];
+        m_pGFX->setClipRect(v.x, v.y, v.w, v.h);
+        m_ppPaint[i]->paint(*m_pGFX);
+    }
+}
+
+boolean GFXWidgetTree::render() {
+    boolean painted = false;
+#ifndef GFX_USE_OPENGL_ES
+    // Older frames in a reused buffer: repaint what changed since, as it is now
+    if (m_pGFX->isMultiBuffered() && m_pGFX->isDamageTracking()) {
+        const GFXregion &repair = m_pGFX->getRepairRegion();
+        if (!repair.isEmpty()) {
+            m_pGFX->beginRepair();
+            for (uint8_t i = 0; i < repair.count; i++) _paintRect(repair.rects[i]);
+            m_pGFX->endRepair();
+            painted = true;
+        }
+    }
+#endif
+    if (!m_invalid.isEmpty()) {
+        // Paint callbacks may invalidate again: that goes to the next frame
+        GFXregion invalid = m_invalid;
+        m_invalid.clear();
+        for (uint8_t i = 0; i < invalid.count; i++) _paintRect(invalid.rects[i]);
+        painted = true;
+    }
+    if (painted) m_pGFX->clearClipRect();
+    return painted;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  ANIMATION
+// ═════════════════════════════════════════════════════════════════════════════
+
+enum { TWEEN_ADDED, TWEEN_DELAYED, TWEEN_RUNNING };
+
+static inline int32_t mulQ16(int32_t a, int32_t b) {
+    return (int32_t)(((int64_t)a * b) >> 16);
+}
+
+int32_t GFXAnimator::ease(GFXease curve, int32_t t) {
+    const int32_t one = 65536;
+    if (t <= 0)   return 0;
+    if (t >= one) return one;           // exact, whatever the rounding
+    int32_t u = one - t;
+    switch (curve) {
+    case GFX_EASE_IN_QUAD:     return mulQ16(t, t);
+    case GFX_EASE_OUT_QUAD:    return one - mulQ16(u, u);
+    case GFX_EASE_IN_OUT_QUAD:
+        return t < one / 2 ? 2 * mulQ16(t, t) : one - 2 * mulQ16(u, u);
+    case GFX_EASE_IN_CUBIC:    return mulQ16(mulQ16(t, t), t);
+    case GFX_EASE_OUT_CUBIC:   return one - mulQ16(mulQ16(u, u), u);
+    case GFX_EASE_IN_OUT_CUBIC:
+        return t < one / 2 ? 4 * mulQ16(mulQ16(t, t), t)
+                           : one - 4 * mulQ16(mulQ16(u, u), u);
+    case GFX_EASE_SMOOTH:      return mulQ16(mulQ16(t, t), 3 * one - 2 * t);
+    case GFX_EASE_OUT_BACK: {
+        // 1 + (c + 1)(t - 1)³ + c(t - 1)², c = 1.70158
+        const int32_t c = 111514;
+        int32_t v = -u, v2 = mulQ16(v, v);
+        return one + mulQ16(c + one, mulQ16(v2, v)) + mulQ16(c, v2);
+    }
+    case GFX_EASE_OUT_BOUNCE: {
+        // Four parabolas of 7.5625 t², peaks at 1 shrinking towards the end
+        const int32_t n = 495616;
+        if (t < 23831) return mulQ16(n, mulQ16(t, t));
+        if (t < 47663) { t -= 35747; return mulQ16(n, mulQ16(t, t)) + 49152; }
+        if (t < 59578) { t -= 53620; return mulQ16(n, mulQ16(t, t)) + 61440; }
+        t -= 62557;
+        return mulQ16(n, mulQ16(t, t)) + 64512;
+    }
+    default:                   return t;
+    }
+}
+
+GFXAnimator::GFXAnimator() : m_active(0) {
+    memset(m_tweens, 0, sizeof(m_tweens));
+    m_damage.clear();
+}
+
+int8_t GFXAnimator::_start(GFXtweenType type, void *pTarget, uint16_t durationMs, GFXease ease) {
+    if (!pTarget) return -1;
+    int8_t id = -1;
+    // A new tween on the same target takes over the old one's slot
+    for (int8_t i = 0; i < GFX_MAX_TWEENS && id < 0; i++)
+        if (m_tweens[i].type != GFX_TWEEN_NONE && m_tweens[i].pTarget == pTarget) id = i;
+    for (int8_t i = 0; i < GFX_MAX_TWEENS && id < 0; i++)
+        if (m_tweens[i].type == GFX_TWEEN_NONE) {
+            id = i;
+            m_active++;
+        }
+    if (id < 0) return -1;
+    GFXtween &tw  = m_tweens[id];
+    memset(&tw, 0, sizeof(tw));
+    tw.type       = type;
+    tw.ease       = ease;
+    tw.durationMs = MAX(durationMs, 1);
+    tw.pTarget    = pTarget;
+    return id;
+}
+
+int8_t GFXAnimator::tweenInt(int16_t *pValue, int16_t to, uint16_t durationMs, GFXease ease) {
+    int8_t id = _start(GFX_TWEEN_INT16, pValue, durationMs, ease);
+    if (id >= 0) m_tweens[id].to[0] = to;
+    return id;
+}
+
+int8_t GFXAnimator::tweenAlpha(uint8_t *pValue, uint8_t to, uint16_t durationMs, GFXease ease) {
+    int8_t id = _start(GFX_TWEEN_UINT8, pValue, durationMs, ease);
+    if (id >= 0) m_tweens[id].to[0] = to;
+    return id;
+}
+
+int8_t GFXAnimator::tweenColor(uint16_t *pColor, uint16_t to, uint16_t durationMs, GFXease ease) {
+    int8_t id = _start(GFX_TWEEN_COLOR, pColor, durationMs, ease);
+    if (id >= 0) {
+        m_tweens[id].to[0] = to >> 11;
+        m_tweens[id].to[1] = (to >> 5) & 0x3F;
+        m_tweens[id].to[2] = to & 0x1F;
+    }
+    return id;
+}
+
+int8_t GFXAnimator::tweenRect(GFXrect *pRect, const GFXrect &to, uint16_t durationMs, GFXease ease) {
+    int8_t id = _start(GFX_TWEEN_RECT, pRect, durationMs, ease);
+    if (id >= 0) {
+        int16_t *p = m_tweens[id].to;
+        p[0] = to.x; p[1] = to.y; p[2] = to.w; p[3] = to.h;
+    }
+    return id;
+}
+
+int8_t GFXAnimator::tweenBounds(GFXWidget *pWidget, const GFXrect &to, uint16_t durationMs, GFXease ease) {
+    int8_t id = _start(GFX_TWEEN_WIDGET, pWidget, durationMs, ease);
+    if (id >= 0) {
+        int16_t *p = m_tweens[id].to;
+        p[0] = to.x; p[1] = to.y; p[2] = to.w; p[3] = to.h;
+    }
+    return id;
+}
+
+int8_t GFXAnimator::tweenMove(GFXWidget *pWidget, int16_t x, int16_t y, uint16_t durationMs, GFXease ease) {
+    if (!pWidget) return -1;
+    GFXrect to = pWidget->getBounds();
+    to.x = x;
+    to.y = y;
+    return tweenBounds(pWidget, to, durationMs, ease);
+}
+
+void GFXAnimator::bind(int8_t id, GFXWidget *pWidget) {
+    if (isRunning(id)) m_tweens[id].pWidget = pWidget;
+}
+
+void GFXAnimator::bind(int8_t id, const GFXrect &area) {
+    if (isRunning(id)) m_tweens[id].area = area;
+}
+
+void GFXAnimator::setDelay(int8_t id, uint16_t delayMs) {
+    if (isRunning(id) && m_tweens[id].state == TWEEN_ADDED) m_tweens[id].delayMs = delayMs;
+}
+
+void GFXAnimator::setRepeat(int8_t id, uint16_t count, boolean bYoyo) {
+    if (!isRunning(id)) return;
+    m_tweens[id].repeat = count;
+    m_tweens[id].bYoyo  = bYoyo;
+}
+
+void GFXAnimator::onDone(int8_t id, GFXtweenDone pDone, void *pParam) {
+    if (!isRunning(id)) return;
+    m_tweens[id].pDone  = pDone;
+    m_tweens[id].pParam = pParam;
+}
+
+boolean GFXAnimator::isRunning(int8_t id) const {
+    return id >= 0 && id < GFX_MAX_TWEENS && m_tweens[id].type != GFX_TWEEN_NONE;
+}
+
+void GFXAnimator::_free(int8_t id) {
+    m_tweens[id].type = GFX_TWEEN_NONE;
+    m_active--;
+}
+
+void GFXAnimator::stop(int8_t id, boolean bFinish) {
+    if (!isRunning(id)) return;
+    GFXtween &tw = m_tweens[id];
+    if (bFinish) {
+        if (tw.state != TWEEN_RUNNING) _read(tw);
+        // The end of the last run: back at the start after an odd number of
+        // yoyo returns
+        if (tw.bYoyo && tw.repeat != GFX_TWEEN_FOREVER && (tw.repeat & 1))
+            _write(tw, 0);
+        else
+            _write(tw, 65536);
+    }
+    _free(id);
+}
+
+void GFXAnimator::stopTarget(const void *pTarget, boolean bFinish) {
+    for (int8_t i = 0; i < GFX_MAX_TWEENS; i++)
+        if (m_tweens[i].type != GFX_TWEEN_NONE && m_tweens[i].pTarget == pTarget) stop(i, bFinish);
+}
+
+void GFXAnimator::stopAll() {
+    for (int8_t i = 0; i < GFX_MAX_TWEENS; i++)
+        if (m_tweens[i].type != GFX_TWEEN_NONE) _free(i);
+}
+
+// Capture the start values from the target
+void GFXAnimator::_read(GFXtween &tw) {
+    int16_t *f = tw.from;
+    switch (tw.type) {
+    case GFX_TWEEN_INT16: f[0] = *(int16_t *)tw.pTarget; break;
+    case GFX_TWEEN_UINT8: f[0] = *(uint8_t *)tw.pTarget; break;
+    case GFX_TWEEN_COLOR: {
+        uint16_t c = *(uint16_t *)tw.pTarget;
+        f[0] = c >> 11; f[1] = (c >> 5) & 0x3F; f[2] = c & 0x1F;
+        break;
+    }
+    case GFX_TWEEN_RECT:
+    case GFX_TWEEN_WIDGET: {
+        GFXrect r = tw.type == GFX_TWEEN_RECT ? *(GFXrect *)tw.pTarget
+                                              : ((GFXWidget *)tw.pTarget)->getBounds();
+        f[0] = r.x; f[1] = r.y; f[2] = r.w; f[3] = r.h;
+        break;
+    }
+    }
+}
+
+// Write the value at eased progress e; true if it changed
+boolean GFXAnimator::_write(GFXtween &tw, int32_t e) {
+    int32_t v[4];
+    for (uint8_t i = 0; i < 4; i++)
+        v[i] = tw.from[i] + (int32_t)(((int64_t)(tw.to[i] - tw.from[i]) * e) >> 16);
+
+    GFXrect before = { 0, 0, 0, 0 }, after;
+    switch (tw.type) {
+    case GFX_TWEEN_INT16: {
+        int16_t *p = (int16_t *)tw.pTarget, n = (int16_t)MIN(MAX(v[0], -32768), 32767);
+        if (*p == n) return false;
+        *p = n;
+        break;
+    }
+    case GFX_TWEEN_UINT8: {
+        uint8_t *p = (uint8_t *)tw.pTarget, n = (uint8_t)MIN(MAX(v[0], 0), 255);
+        if (*p == n) return false;
+        *p = n;
+        break;
+    }
+    case GFX_TWEEN_COLOR: {
+        uint16_t *p = (uint16_t *)tw.pTarget;
+        uint16_t n = (uint16_t)((MIN(MAX(v[0], 0), 31) << 11) |
+                                (MIN(MAX(v[1], 0), 63) << 5) | MIN(MAX(v[2], 0), 31));
+        if (*p == n) return false;
+        *p = n;
+        break;
+    }
+    case GFX_TWEEN_RECT:
+    case GFX_TWEEN_WIDGET:
+        after.x = (int16_t)MIN(MAX(v[0], -32768), 32767);
+        after.y = (int16_t)MIN(MAX(v[1], -32768), 32767);
+        after.w = (int16_t)MIN(MAX(v[2], 0), 32767);
+        after.h = (int16_t)MIN(MAX(v[3], 0), 32767);
+        if (tw.type == GFX_TWEEN_WIDGET) {
+            GFXWidget *w = (GFXWidget *)tw.pTarget;
+            before = w->getBounds();
+            if (!memcmp(&before, &after, sizeof(GFXrect))) return false;
+            w->setBounds(after.x, after.y, after.w, after.h);   // invalidates both
+        } else {
+            GFXrect *p = (GFXrect *)tw.pTarget;
+            before = *p;
+            if (!memcmp(&before, &after, sizeof(GFXrect))) return false;
+            *p = after;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    if (tw.type == GFX_TWEEN_RECT) {
+        // Old and new position of whatever the rectangle frames
+        if (tw.pWidget) {
+            tw.pWidget->invalidate(before);
+            tw.pWidget->invalidate(after);
+        } else {
+            m_damage.add(before);
+            m_damage.add(after);
+        }
+    } else if (tw.pWidget) {
+        tw.pWidget->invalidate();
+    }
+    if (tw.area.w) m_damage.add(tw.area);
+    return true;
+}
+
+boolean GFXAnimator::tick(uint32_t nowMs) {
+    boolean changed = false;
+    for (int8_t id = 0; id < GFX_MAX_TWEENS; id++) {
+        GFXtween &tw = m_tweens[id];
+        if (tw.type == GFX_TWEEN_NONE) continue;
+        if (tw.state == TWEEN_ADDED) {
+            tw.startMs = nowMs + tw.delayMs;
+            tw.state   = TWEEN_DELAYED;
+        }
+        int32_t elapsed = (int32_t)(nowMs - tw.startMs);
+        if (elapsed < 0) continue;
+        if (tw.state == TWEEN_DELAYED) {
+            _read(tw);
+            tw.state = TWEEN_RUNNING;
+        }
+
+        // Skip the runs that are over
+        uint32_t runs = (uint32_t)elapsed / tw.durationMs;
+        if (runs && tw.repeat) {
+            if (tw.repeat != GFX_TWEEN_FOREVER) {
+                runs = MIN(runs, (uint32_t)tw.repeat);
+                tw.repeat -= runs;
+            }
+            tw.startMs += runs * tw.durationMs;
+            elapsed    -= runs * tw.durationMs;
+            if (tw.bYoyo && (runs & 1))
+                for (uint8_t i = 0; i < 4; i++) SWAP(tw.from[i], tw.to[i]);
+        }
+
+        boolean done = elapsed >= tw.durationMs;
+        int32_t t = done ? 65536 : (int32_t)(((uint32_t)elapsed << 16) / tw.durationMs);
+        if (_write(tw, ease((GFXease)tw.ease, t))) changed = true;
+        if (done) {
+            GFXtweenDone pDone = tw.pDone;
+            void *pParam = tw.pParam;
+            _free(id);
+            if (pDone) pDone(id, pParam);     // may start a new tween in this slot
+        }
+    }
+    return changed;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  SPRITE ENGINE
+// ═════════════════════════════════════════════════════════════════════════════
+// A frame's sprite lists hold, for every viewport line, the ids of the sprites
+// crossing it in drawing order.  A line is composed in m_pLine (which stays
+// in the data cache) and then copied out, so the target sees one write per
+// pixel no matter how many sprites overlap.
+
+static inline int32_t wrapMod(int32_t v, int32_t n) {
+    v %= n;
+    return v < 0 ? v + n : v;
+}
+
+static inline void fillRow16(uint16_t *p, int16_t n, uint16_t color) {
+    for (int16_t i = 0; i < n; i++) p[i] = color;
+}
+
+GFXSpriteEngine::GFXSpriteEngine(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t maxSprites)
+    : m_bgMode(BG_COLOR), m_bgColor(0x0000), m_tileW(0), m_tileH(0), m_pMap(nullptr),
+      m_mapW(0), m_mapH(0), m_scrollX(0), m_scrollY(0), m_maxSprites(maxSprites),
+      m_orderDirty(false), m_pLineIds(nullptr), m_lineIdsSize(0),
+      m_pStage(nullptr), m_stageSize(0)
+{
+    GFXrect view = { x, y, (int16_t)MAX(w, 1), (int16_t)MAX(h, 1) };
+    m_view = view;
+    memset(&m_bgImage, 0, sizeof(m_bgImage));
+    m_pSprites   = (GFXsprite *)calloc(MAX(maxSprites, 1), sizeof(GFXsprite));
+    m_pOrder     = (uint16_t *)malloc(MAX(maxSprites, 1) * sizeof(uint16_t));
+    m_pLineStart = (uint32_t *)malloc((m_view.h + 1) * sizeof(uint32_t));
+    m_pLine      = (uint16_t *)malloc(m_view.w * sizeof(uint16_t));
+    if (!m_pSprites || !m_pOrder || !m_pLineStart || !m_pLine) m_maxSprites = 0;
+    for (uint16_t i = 0; i < m_maxSprites; i++) m_pOrder[i] = i;
+    m_invalid.clear();
+    m_invalid.add(m_view);
+    m_damage.clear();
+}
+
+GFXSpriteEngine::~GFXSpriteEngine() {
+    free(m_pSprites);
+    free(m_pOrder);
+    free(m_pLineStart);
+    free(m_pLineIds);
+    free(m_pLine);
+    free(m_pStage);
+}
+
+// ─── Background ──────────────────────────────────────────────────────────────
+
+void GFXSpriteEngine::setBackgroundColor(uint16_t color) {
+    m_bgColor = color;
+    invalidate();
+}
+
+void GFXSpriteEngine::setBackground(const GFXsurface &image) {
+    m_bgMode  = image.pData && image.width > 0 && image.height > 0 ? BG_IMAGE : BG_COLOR;
+    m_bgImage = image;
+    invalidate();
+}
+
+void GFXSpriteEngine::setTilemap(const GFXsurface &tiles, int16_t tileW, int16_t tileH,
+                                 const uint16_t *pMap, int16_t mapW, int16_t mapH) {
+    boolean ok = tiles.pData && pMap && tileW > 0 && tileH > 0 && mapW > 0 && mapH > 0
+              && tiles.width >= tileW && tiles.height >= tileH;
+    m_bgMode  = ok ? BG_TILES : BG_COLOR;
+    m_bgImage = tiles;
+    m_tileW   = tileW;
+    m_tileH   = tileH;
+    m_pMap    = pMap;
+    m_mapW    = mapW;
+    m_mapH    = mapH;
+    invalidate();
+}
+
+void GFXSpriteEngine::setScroll(int16_t sx, int16_t sy) {
+    if (sx == m_scrollX && sy == m_scrollY) return;
+    m_scrollX = sx;
+    m_scrollY = sy;
+    invalidate();
+}
+
+void GFXSpriteEngine::invalidate() {
+    m_invalid.clear();
+    m_invalid.add(m_view);
+}
+
+void GFXSpriteEngine::invalidate(const GFXrect &r) {
+    GFXrect s = { (int16_t)(m_view.x + r.x), (int16_t)(m_view.y + r.y), r.w, r.h };
+    if (GFXrectIntersect(s, m_view, &s)) m_invalid.add(s);
+}
+
+// ─── Sprites ─────────────────────────────────────────────────────────────────
+
+// Screen area a sprite covers now, within the viewport
+GFXrect GFXSpriteEngine::_screenRect(const GFXsprite &s) const {
+    GFXrect r = { (int16_t)(m_view.x + s.x), (int16_t)(m_view.y + s.y), s.frame.w, s.frame.h };
+    if (!(s.flags & GFX_SPRITE_VISIBLE) || !GFXrectIntersect(r, m_view, &r)) r.w = r.h = 0;
+    return r;
+}
+
+void GFXSpriteEngine::setSprite(uint16_t id, const GFXsurface &sheet, const GFXrect &frame,
+                                uint16_t key, uint8_t flags) {
+    if (id >= m_maxSprites) return;
+    GFXsprite &s = m_pSprites[id];
+    s.sheet = sheet;
+    s.key   = key;
+    s.flags = flags;
+    s.frame.w = s.frame.h = 0;
+    setFrame(id, frame);
+    s.bDirty = true;
+}
+
+void GFXSpriteEngine::setFrame(uint16_t id, const GFXrect &frame) {
+    if (id >= m_maxSprites) return;
+    GFXsprite &s = m_pSprites[id];
+    GFXrect f, sheet = { 0, 0, s.sheet.width, s.sheet.height };
+    if (!s.sheet.pData) sheet.w = sheet.h = 0;
+    GFXrectIntersect(frame, sheet, &f);
+    if (!memcmp(&f, &s.frame, sizeof(GFXrect))) return;
+    s.frame = f;
+    s.bDirty = true;
+}
+
+void GFXSpriteEngine::moveSprite(uint16_t id, int16_t x, int16_t y) {
+    if (id >= m_maxSprites) return;
+    GFXsprite &s = m_pSprites[id];
+    if (s.x == x && s.y == y) return;
+    s.x = x;
+    s.y = y;
+    s.bDirty = true;
+}
+
+void GFXSpriteEngine::setPriority(uint16_t id, int16_t z) {
+    if (id >= m_maxSprites || m_pSprites[id].z == z) return;
+    m_pSprites[id].z = z;
+    m_orderDirty = true;
+    m_pSprites[id].bDirty = true;
+}
+
+void GFXSpriteEngine::setFlags(uint16_t id, uint8_t flags) {
+    if (id >= m_maxSprites || m_pSprites[id].flags == flags) return;
+    m_pSprites[id].flags = flags;
+    m_pSprites[id].bDirty = true;
+}
+
+// ─── Composition ─────────────────────────────────────────────────────────────
+
+// Per-line sprite lists for the whole viewport (counting sort by line)
+boolean GFXSpriteEngine::_buildLines() {
+    if (m_orderDirty) {
+        // Insertion sort by (z, id): the order rarely changes much
+        for (uint16_t i = 1; i < m_maxSprites; i++) {
+            uint16_t id = m_pOrder[i], j = i;
+            const GFXsprite &s = m_pSprites[id];
+            for (; j > 0; j--) {
+                const GFXsprite &p = m_pSprites[m_pOrder[j - 1]];
+                if (p.z < s.z || (p.z == s.z && m_pOrder[j - 1] < id)) break;
+                m_pOrder[j] = m_pOrder[j - 1];
+            }
+            m_pOrder[j] = id;
+        }
+        m_orderDirty = false;
+    }
+
+    int16_t h = m_view.h;
+    memset(m_pLineStart, 0, (h + 1) * sizeof(uint32_t));
+    for (uint16_t k = 0; k < m_maxSprites; k++) {
+        const GFXsprite &s = m_pSprites[m_pOrder[k]];
+        if (!(s.flags & GFX_SPRITE_VISIBLE) || !s.frame.w || !s.frame.h) continue;
+        if (s.x >= m_view.w || s.x + s.frame.w <= 0) continue;
+        int16_t y0 = MAX(s.y, 0), y1 = (int16_t)MIN(s.y + s.frame.h, (int32_t)h);
+        for (int16_t y = y0; y < y1; y++) m_pLineStart[y + 1]++;
+    }
+    for (int16_t y = 0; y < h; y++) m_pLineStart[y + 1] += m_pLineStart[y];
+
+    uint32_t total = m_pLineStart[h];
+    if (total > m_lineIdsSize) {
+        uint16_t *p = (uint16_t *)realloc(m_pLineIds, total * sizeof(uint16_t));
+        if (!p) return false;
+        m_pLineIds    = p;
+        m_lineIdsSize = total;
+    }
+    // Fill using the starts as cursors, which leaves each on the next line's start
+    for (uint16_t k = 0; k < m_maxSprites; k++) {
+        uint16_t id = m_pOrder[k];
+        const GFXsprite &s = m_pSprites[id];
+        if (!(s.flags & GFX_SPRITE_VISIBLE) || !s.frame.w || !s.frame.h) continue;
+        if (s.x >= m_view.w || s.x + s.frame.w <= 0) continue;
+        int16_t y0 = MAX(s.y, 0), y1 = (int16_t)MIN(s.y + s.frame.h, (int32_t)h);
+        for (int16_t y = y0; y < y1; y++) m_pLineIds[m_pLineStart[y]++] = id;
+    }
+    for (int16_t y = h; y > 0; y--) m_pLineStart[y] = m_pLineStart[y - 1];
+    m_pLineStart[0] = 0;
+    return true;
+}
+
+// Background for w pixels of viewport line y, from column x
+void GFXSpriteEngine::_background(uint16_t *pLine, int16_t x, int16_t y, int16_t w) const {
+    if (m_bgMode == BG_IMAGE) {
+        const GFXsurface &img = m_bgImage;
+        const uint16_t *row = img.pData + wrapMod(y + m_scrollY, img.height) * img.stride;
+        int32_t sx = wrapMod(x + m_scrollX, img.width);
+        for (int16_t i = 0; i < w; ) {
+            int16_t n = (int16_t)MIN((int32_t)(w - i), img.width - sx);
+            memcpy(pLine + i, row + sx, n * sizeof(uint16_t));
+            i += n;
+            sx = 0;
+        }
+    } else if (m_bgMode == BG_TILES) {
+        const GFXsurface &sheet = m_bgImage;
+        int16_t  cols  = sheet.width / m_tileW;
+        uint32_t tiles = (uint32_t)cols * (sheet.height / m_tileH);
+        int32_t  wy    = wrapMod(y + m_scrollY, (int32_t)m_mapH * m_tileH);
+        int32_t  wx    = wrapMod(x + m_scrollX, (int32_t)m_mapW * m_tileW);
+        const uint16_t *mapRow = m_pMap + (wy / m_tileH) * m_mapW;
+        int16_t py = wy % m_tileH, tx = wx / m_tileW, px = wx % m_tileW;
+        for (int16_t i = 0; i < w; ) {
+            int16_t  n = MIN(m_tileW - px, w - i);
+            uint16_t t = mapRow[tx];
+            if (t == GFX_SPRITE_NO_TILE || t >= tiles)
+                fillRow16(pLine + i, n, m_bgColor);
+            else
+                memcpy(pLine + i, sheet.pData + ((t / cols) * m_tileH + py) * sheet.stride
+                                              + (t % cols) * m_tileW + px,
+                       n * sizeof(uint16_t));
+            i += n;
+            px = 0;
+            if (++tx == m_mapW) tx = 0;
+        }
+    } else {
+        fillRow16(pLine, w, m_bgColor);
+    }
+}
+
+// The sprites crossing viewport line y, back to front, over columns [x, x+w)
+void GFXSpriteEngine::_sprites(uint16_t *pLine, int16_t x, int16_t y, int16_t w) const {
+    for (uint32_t k = m_pLineStart[y]; k < m_pLineStart[y + 1]; k++) {
+        const GFXsprite &s = m_pSprites[m_pLineIds[k]];
+        int16_t a = MAX(s.x, x), b = (int16_t)MIN(s.x + s.frame.w, x + w);
+        if (a >= b) continue;
+        int16_t row = y - s.y;
+        if (s.flags & GFX_SPRITE_FLIP_Y) row = s.frame.h - 1 - row;
+        const uint16_t *src = s.sheet.pData + (int32_t)(s.frame.y + row) * s.sheet.stride + s.frame.x;
+        uint16_t *d = pLine + (a - x);
+        int16_t   n = b - a;
+        if (s.flags & GFX_SPRITE_FLIP_X) {
+            src += s.frame.w - 1 - (a - s.x);
+            if (s.flags & GFX_SPRITE_OPAQUE) {
+                for (int16_t i = 0; i < n; i++) d[i] = src[-i];
+            } else {
+                for (int16_t i = 0; i < n; i++)
+                    if (src[-i] != s.key) d[i] = src[-i];
+            }
+        } else {
+            src += a - s.x;
+            if (s.flags & GFX_SPRITE_OPAQUE) {
+                memcpy(d, src, n * sizeof(uint16_t));
+            } else {
+                for (int16_t i = 0; i < n; i++)
+                    if (src[i] != s.key) d[i] = src[i];
+            }
+        }
+    }
+}
+
+// Recompose one screen rectangle
+void GFXSpriteEngine::_compose(CircleGFX &gfx, const GFXrect &rect) {
+    GFXrect r;
+    if (!GFXrectIntersect(rect, m_view, &r) || !GFXrectIntersect(r, gfx.getClipRect(), &r)) return;
+    int16_t    x   = r.x - m_view.x, y = r.y - m_view.y;
+    GFXsurface dst = gfx.getDrawSurface();
+    if (dst.pData) {
+        for (int16_t j = 0; j < r.h; j++) {
+            _background(m_pLine, x, y + j, r.w);
+            _sprites   (m_pLine, x, y + j, r.w);
+            memcpy(dst.pData + (int32_t)(r.y + j) * dst.stride + r.x, m_pLine, r.w * sizeof(uint16_t));
+        }
+        gfx.addDamage(r.x, r.y, r.w, r.h);
+    } else {
+        // Not CPU-addressable (OpenGL ES screen): stage the rectangle, one upload
+        uint32_t size = (uint32_t)r.w * r.h;
+        if (size > m_stageSize) {
+            uint16_t *p = (uint16_t *)realloc(m_pStage, size * sizeof(uint16_t));
+            if (!p) return;
+            m_pStage    = p;
+            m_stageSize = size;
+        }
+        for (int16_t j = 0; j < r.h; j++) {
+            _background(m_pStage + (int32_t)j * r.w, x, y + j, r.w);
+            _sprites   (m_pStage + (int32_t)j * r.w, x, y + j, r.w);
+        }
+        GFXsurface stage = { m_pStage, r.w, r.h, r.w };
+        GFXrect    sr    = { 0, 0, r.w, r.h };
+        gfx.blit(stage, sr, r.x, r.y);
+    }
+    m_damage.add(r);
+}
+
+boolean GFXSpriteEngine::draw(CircleGFX &gfx) {
+    m_damage.clear();
+    if (!m_maxSprites) return false;
+    for (uint16_t i = 0; i < m_maxSprites; i++) {
+        GFXsprite &s = m_pSprites[i];
+        if (!s.bDirty) continue;
+        m_invalid.add(s.drawn);
+        s.drawn  = _screenRect(s);
+        s.bDirty = false;
+        m_invalid.add(s.drawn);
+    }
+    if (!_buildLines()) return false;
+
+#ifndef GFX_USE_OPENGL_ES
+    // Older frames in a reused buffer: recompose what changed since
+    if (gfx.isMultiBuffered() && gfx.isDamageTracking()) {
+        const GFXregion &repair = gfx.getRepairRegion();
+        if (!repair.isEmpty()) {
+            gfx.beginRepair();
+            for (uint8_t i = 0; i < repair.count; i++) _compose(gfx, repair.rects[i]);
+            gfx.endRepair();
+        }
+    }
+#endif
+    for (uint8_t i = 0; i < m_invalid.count; i++) _compose(gfx, m_invalid.rects[i]);
+    m_invalid.clear();
+    return !m_damage.isEmpty();
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  COLLISION
+// ═════════════════════════════════════════════════════════════════════════════
+
+// 32 mask pixels of a row starting at pixel bit, MSB first.  Bytes past the
+// row (w pixels) read as zero; a missing mask is solid.
+static inline uint32_t maskBits32(const uint8_t *pRow, int32_t bit, int16_t w) {
+    if (!pRow) return 0xFFFFFFFF;
+    int32_t  i = bit >> 3, last = (w - 1) >> 3;
+    uint64_t v;
+    if (i + 4 <= last) {
+        v = ((uint64_t)pRow[i] << 32) | ((uint32_t)pRow[i + 1] << 24) |
+            ((uint32_t)pRow[i + 2] << 16) | ((uint32_t)pRow[i + 3] << 8) | pRow[i + 4];
+    } else {
+        v = 0;
+        for (int32_t k = i; k < i + 5; k++) v = (v << 8) | (k <= last ? pRow[k] : 0);
+    }
+    return (uint32_t)(v >> (8 - (bit & 7)));
+}
+
+boolean GFXcollide(const GFXcollider &a, const GFXcollider &b, GFXrect *pHit) {
+    GFXrect ra = { a.x, a.y, a.w, a.h }, rb = { b.x, b.y, b.w, b.h }, o;
+    if (pHit) pHit->x = pHit->y = pHit->w = pHit->h = 0;
+    if (!GFXrectIntersect(ra, rb, &o)) return false;
+    if (!a.pMask && !b.pMask) {
+        if (pHit) *pHit = o;
+        return true;
+    }
+
+    GFXrect hit = { 0, 0, 0, 0 };
+    for (int16_t y = o.y; y < o.y + o.h; y++) {
+        const uint8_t *pa = a.pMask ? a.pMask + (int32_t)(y - a.y) * a.stride : nullptr;
+        const uint8_t *pb = b.pMask ? b.pMask + (int32_t)(y - b.y) * b.stride : nullptr;
+        for (int16_t x = o.x; x < o.x + o.w; x += 32) {
+            int16_t  n = (int16_t)MIN(32, o.x + o.w - x);
+            uint32_t m = maskBits32(pa, x - a.x, a.w) & maskBits32(pb, x - b.x, b.w);
+            m &= 0xFFFFFFFFu << (32 - n);
+            if (!m) continue;
+            if (!pHit) return true;
+            GFXrect span = { (int16_t)(x + __builtin_clz(m)), y,
+                             (int16_t)(32 - __builtin_clz(m) - __builtin_ctz(m)), 1 };
+            hit = GFXrectUnion(hit, span);
+        }
+    }
+    if (!hit.w) return false;
+    *pHit = hit;
+    return true;
+}
+
+uint16_t GFXcollideGrid(const GFXcollider &a, GFXSpatialGrid &grid,
+                        GFXcollider **ppHits, uint16_t maxHits) {
+    GFXrect  r = { a.x, a.y, a.w, a.h };
+    uint16_t n = grid.queryRect(r, (void **)ppHits, maxHits), hits = 0;
+    for (uint16_t i = 0; i < n; i++)
+        if (ppHits[i] != &a && GFXcollide(a, *ppHits[i])) ppHits[hits++] = ppHits[i];
+    return hits;
+}
+
+void GFXmaskFromKey(const GFXsurface &src, const GFXrect &r, uint16_t key,
+                    uint8_t *pMask, int32_t stride) {
+    for (int16_t j = 0; j < r.h; j++) {
+        const uint16_t *s = src.pData + (int32_t)(r.y + j) * src.stride + r.x;
+        uint8_t *d = pMask + (int32_t)j * stride;
+        memset(d, 0, (r.w + 7) >> 3);
+        for (int16_t i = 0; i < r.w; i++)
+            if (s[i] != key) d[i >> 3] |= 0x80 >> (i & 7);
+    }
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  PARTICLES
+// ═════════════════════════════════════════════════════════════════════════════
+
+GFXParticles::GFXParticles(uint32_t capacity)
+    : m_count(0), m_capacity(capacity), m_ax(0), m_ay(0), m_drag(256), m_cull(),
+      m_fade(0), m_pBrush(nullptr), m_brushW(0), m_brushH(0), m_bounds(), m_rng(0x9E3779B9)
+{
+    m_pX     = (int32_t *)malloc(capacity * sizeof(int32_t));
+    m_pY     = (int32_t *)malloc(capacity * sizeof(int32_t));
+    m_pVX    = (int32_t *)malloc(capacity * sizeof(int32_t));
+    m_pVY    = (int32_t *)malloc(capacity * sizeof(int32_t));
+    m_pLife  = (uint16_t *)malloc(capacity * sizeof(uint16_t));
+    m_pColor = (uint16_t *)malloc(capacity * sizeof(uint16_t));
+    if (!m_pX || !m_pY || !m_pVX || !m_pVY || !m_pLife || !m_pColor) m_capacity = 0;
+}
+
+GFXParticles::~GFXParticles() {
+    free(m_pX);
+    free(m_pY);
+    free(m_pVX);
+    free(m_pVY);
+    free(m_pLife);
+    free(m_pColor);
+}
+
+void GFXParticles::setBrush(const uint8_t *pAlpha, uint8_t w, uint8_t h) {
+    m_pBrush = w && h ? pAlpha : nullptr;
+    m_brushW = m_pBrush ? w : 0;
+    m_brushH = m_pBrush ? h : 0;
+}
+
+// Uniform in [0, range)
+uint32_t GFXParticles::_random(uint32_t range) {
+    m_rng ^= m_rng << 13;
+    m_rng ^= m_rng >> 17;
+    m_rng ^= m_rng << 5;
+    return range ? (uint32_t)(((uint64_t)m_rng * range) >> 32) : 0;
+}
+
+boolean GFXParticles::add(int32_t x, int32_t y, int32_t vx, int32_t vy, uint16_t life, uint16_t color) {
+    if (m_count >= m_capacity || !life) return false;
+    uint32_t i = m_count++;
+    m_pX[i]     = x;
+    m_pY[i]     = y;
+    m_pVX[i]    = vx;
+    m_pVY[i]    = vy;
+    m_pLife[i]  = life;
+    m_pColor[i] = color;
+    return true;
+}
+
+uint32_t GFXParticles::emit(uint32_t count, const GFXemitter &e) {
+    uint32_t n = 0;
+    for (; n < count && m_count < m_capacity; n++) {
+        int32_t x  = e.x + (int32_t)_random(2 * (uint32_t)e.jitterX + 1) - e.jitterX;
+        int32_t y  = e.y + (int32_t)_random(2 * (uint32_t)e.jitterY + 1) - e.jitterY;
+        int32_t vx = e.vx0 + (int32_t)_random((uint32_t)(e.vx1 - e.vx0) + 1);
+        int32_t vy = e.vy0 + (int32_t)_random((uint32_t)(e.vy1 - e.vy0) + 1);
+        uint16_t life = (uint16_t)(e.life0 + _random((uint32_t)(e.life1 - e.life0) + 1));
+        add(x, y, vx, vy, MAX(life, (uint16_t)1), e.color);
+    }
+    return n;
+}
+
+void GFXParticles::update() {
+    uint32_t n = m_count, i = 0;
+
+    // Integration, four particles per step
+    const gfx_s32x4 ax = { m_ax, m_ax, m_ax, m_ax }, ay = { m_ay, m_ay, m_ay, m_ay };
+    const gfx_s32x4 drag = { m_drag, m_drag, m_drag, m_drag };
+    for (; i + 4 <= n; i += 4) {
+        gfx_s32x4 vx = gfxLoadS32x4(m_pVX + i), vy = gfxLoadS32x4(m_pVY + i);
+        if (m_drag != 256) {
+            vx = (vx * drag) >> 8;
+            vy = (vy * drag) >> 8;
+        }
+        vx += ax;
+        vy += ay;
+        gfxStoreS32x4(m_pVX + i, vx);
+        gfxStoreS32x4(m_pVY + i, vy);
+        gfxStoreS32x4(m_pX + i, gfxLoadS32x4(m_pX + i) + vx);
+        gfxStoreS32x4(m_pY + i, gfxLoadS32x4(m_pY + i) + vy);
+    }
+    for (; i < n; i++) {
+        if (m_drag != 256) {
+            m_pVX[i] = (m_pVX[i] * m_drag) >> 8;
+            m_pVY[i] = (m_pVY[i] * m_drag) >> 8;
+        }
+        m_pVX[i] += m_ax;
+        m_pVY[i] += m_ay;
+        m_pX[i]  += m_pVX[i];
+        m_pY[i]  += m_pVY[i];
+    }
+
+    // Ageing, culling and bounds
+    const boolean cull = m_cull.w > 0 && m_cull.h > 0;
+    int32_t x0 = 0x7FFF, y0 = 0x7FFF, x1 = -0x8000, y1 = -0x8000;
+    for (i = 0; i < n; ) {
+        int32_t px = m_pX[i] >> GFX_PARTICLE_FRAC, py = m_pY[i] >> GFX_PARTICLE_FRAC;
+        if (--m_pLife[i] == 0 ||
+            (cull && (px < m_cull.x || px >= m_cull.x + m_cull.w ||
+                      py < m_cull.y || py >= m_cull.y + m_cull.h))) {
+            n--;
+            m_pX[i]     = m_pX[n];
+            m_pY[i]     = m_pY[n];
+            m_pVX[i]    = m_pVX[n];
+            m_pVY[i]    = m_pVY[n];
+            m_pLife[i]  = m_pLife[n];
+            m_pColor[i] = m_pColor[n];
+            continue;
+        }
+        x0 = MIN(x0, px);
+        x1 = MAX(x1, px);
+        y0 = MIN(y0, py);
+        y1 = MAX(y1, py);
+        i++;
+    }
+    m_count = n;
+
+    GFXrect b = { 0, 0, 0, 0 };
+    if (n) {
+        int16_t bw = MAX(m_brushW, (uint8_t)1), bh = MAX(m_brushH, (uint8_t)1);
+        x0 = MAX(x0 - bw / 2, (int32_t)-0x8000);
+        y0 = MAX(y0 - bh / 2, (int32_t)-0x8000);
+        b.x = (int16_t)x0;
+        b.y = (int16_t)y0;
+        b.w = (int16_t)MIN(x1 - x0 + bw, (int32_t)0x7FFF);
+        b.h = (int16_t)MIN(y1 - y0 + bh, (int32_t)0x7FFF);
+    }
+    m_bounds = b;
+}
+
+// ─── Drawing ─────────────────────────────────────────────────────────────────
+
+// Combine colour c at opacity a (0..256) into one pixel
+static inline uint16_t particlePixel(uint16_t d, uint16_t c, uint16_t a, GFXblitMode mode) {
+    if (mode == GFX_BLIT_ADD) {
+        uint32_t r = (d >> 11) + (((c >> 11) * a) >> 8);
+        uint32_t g = ((d >> 5) & 0x3F) + ((((c >> 5) & 0x3F) * a) >> 8);
+        uint32_t b = (d & 0x1F) + (((c & 0x1F) * a) >> 8);
+        return (uint16_t)((MIN(r, 31u) << 11) | (MIN(g, 63u) << 5) | MIN(b, 31u));
+    }
+    if (mode == GFX_BLIT_COPY || a >= 256) return c;
+    return gfxBlend565(d, c, a);
+}
+
+void CircleGFX::drawParticles(const GFXParticles &particles, GFXblitMode mode, uint8_t alpha) {
+    uint32_t n = particles.count();
+    if (!n || !alpha) return;
+    if (mode != GFX_BLIT_ADD && mode != GFX_BLIT_COPY) mode = GFX_BLIT_ALPHA;
+
+    GFXsurface dst = getDrawSurface();
+    if (!dst.pData) {
+#ifdef GFX_USE_OPENGL_ES
+        drawGLParticles(particles, mode, alpha);
+#endif
+        return;
+    }
+
+    const int32_t  *px  = particles.getX(), *py = particles.getY();
+    const uint16_t *col = particles.getColor();
+    uint8_t bw, bh;
+    const uint8_t *pBrush = particles.getBrush(&bw, &bh);
+    const uint16_t a0 = alpha + (alpha >> 7);
+    const int16_t  cx0 = m_clip.x, cy0 = m_clip.y;
+    const int16_t  cx1 = m_clip.x + m_clip.w, cy1 = m_clip.y + m_clip.h;
+    int32_t x0 = cx1, y0 = cy1, x1 = cx0 - 1, y1 = cy0 - 1;   // drawn area
+
+    if (!pBrush) {
+        for (uint32_t i = 0; i < n; i++) {
+            int32_t x = px[i] >> GFX_PARTICLE_FRAC, y = py[i] >> GFX_PARTICLE_FRAC;
+            if (x < cx0 || x >= cx1 || y < cy0 || y >= cy1) continue;
+            uint16_t *d = dst.pData + y * dst.stride + x;
+            *d = particlePixel(*d, col[i], (a0 * particles.getFade(i)) >> 8, mode);
+            x0 = MIN(x0, x);
+            x1 = MAX(x1, x);
+            y0 = MIN(y0, y);
+            y1 = MAX(y1, y);
+        }
+    } else {
+        for (uint32_t i = 0; i < n; i++) {
+            int32_t x = (px[i] >> GFX_PARTICLE_FRAC) - bw / 2;
+            int32_t y = (py[i] >> GFX_PARTICLE_FRAC) - bh / 2;
+            if (x >= cx1 || y >= cy1 || x + bw <= cx0 || y + bh <= cy0) continue;
+            uint16_t a = (a0 * particles.getFade(i)) >> 8;
+            int16_t i0 = (int16_t)MAX(cx0 - x, 0), i1 = (int16_t)MIN(cx1 - x, (int32_t)bw);
+            int16_t j0 = (int16_t)MAX(cy0 - y, 0), j1 = (int16_t)MIN(cy1 - y, (int32_t)bh);
+            x0 = MIN(x0, x + i0);
+            x1 = MAX(x1, x + i1 - 1);
+            y0 = MIN(y0, y + j0);
+            y1 = MAX(y1, y + j1 - 1);
+            for (int16_t j = j0; j < j1; j++) {
+                const uint8_t *s = pBrush + j * bw;
+                uint16_t      *d = dst.pData + (y + j) * dst.stride + x;
+                for (int16_t k = i0; k < i1; k++) {
+                    uint16_t ba = s[k] + (s[k] >> 7);
+                    if (ba) d[k] = particlePixel(d[k], col[i], (a * ba) >> 8, mode);
+                }
+            }
+        }
+    }
+    if (x1 >= x0) addDamage((int16_t)x0, (int16_t)y0, (int16_t)(x1 - x0 + 1), (int16_t)(y1 - y0 + 1));
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  IMAGES
+// ═════════════════════════════════════════════════════════════════════════════
+
+static inline uint16_t gray565(uint8_t v) {
+    return (uint16_t)(((v >> 3) << 11) | ((v >> 2) << 5) | (v >> 3));
+}
+
+static inline uint16_t paletteColor(const GFXimage &img, uint8_t index) {
+    return index < img.paletteSize ? img.pPalette[index] : 0;
+}
+
+boolean GFXimageRow(const GFXimage &img, int16_t y, int16_t x, int16_t w, uint16_t *pOut) {
+    if (!img.pData || y < 0 || y >= img.height || x < 0 || w < 0 || x + w > img.width) return false;
+    const uint8_t *row = img.pData + (int32_t)y * img.stride;
+
+    switch (img.format) {
+    case GFX_IMAGE_RGB565:
+        memcpy(pOut, row + x * 2, w * sizeof(uint16_t));
+        return true;
+    case GFX_IMAGE_INDEX8:
+        if (img.paletteSize == 256) {
+            expandRow8(pOut, row + x, w, img.pPalette);
+        } else {
+            for (int16_t i = 0; i < w; i++) pOut[i] = paletteColor(img, row[x + i]);
+        }
+        return true;
+    case GFX_IMAGE_INDEX4:
+        for (int16_t i = 0; i < w; i++) {
+            uint8_t b = row[(x + i) >> 1];
+            pOut[i] = paletteColor(img, ((x + i) & 1) ? (b & 0x0F) : (b >> 4));
+        }
+        return true;
+    case GFX_IMAGE_A8:
+        for (int16_t i = 0; i < w; i++) pOut[i] = gray565(row[x + i]);
+        return true;
+    case GFX_IMAGE_MASK1:
+        for (int16_t i = 0; i < w; i++)
+            pOut[i] = (row[(x + i) >> 3] & (0x80 >> ((x + i) & 7))) ? 0xFFFF : 0x0000;
+        return true;
+    case GFX_IMAGE_RLE565:
+    case GFX_IMAGE_RLE8: {
+        // Walk the packets from the start of the row, keeping what overlaps [x, x+w)
+        const uint8_t *end = img.pData + img.size;
+        uint32_t off;
+        if ((uint32_t)img.height * 4 > img.size) return false;
+        memcpy(&off, img.pData + y * 4, 4);
+        if (off > img.size) return false;
+        const uint8_t *p = img.pData + off;
+        const int32_t  bpp = img.format == GFX_IMAGE_RLE565 ? 2 : 1;
+        for (int32_t pos = 0; pos < x + w; ) {
+            if (p >= end) return false;
+            uint8_t c   = *p++;
+            boolean run = c >= 128;
+            int32_t n   = run ? c - 127 : c + 1, bytes = run ? bpp : n * bpp;
+            if (bytes > end - p) return false;
+            int32_t a = MAX(pos, (int32_t)x), b = MIN(pos + n, (int32_t)(x + w));
+            for (int32_t k = a; k < b; k++) {
+                const uint8_t *q = run ? p : p + (k - pos) * bpp;
+                pOut[k - x] = bpp == 2 ? (uint16_t)(q[0] | (q[1] << 8)) : paletteColor(img, q[0]);
+            }
+            p   += bytes;
+            pos += n;
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void CircleGFX::drawImage(int16_t x, int16_t y, const GFXimage &image) {
+    GFXrect dr = { x, y, image.width, image.height };
+    if (!image.pData || !GFXrectIntersect(dr, m_clip, &dr)) return;
+    int16_t    sx  = dr.x - x, sy = dr.y - y;
+    GFXsurface dst = getDrawSurface();
+
+    if (!dst.pData) {
+#ifdef GFX_USE_OPENGL_ES
+        uint16_t *tmp = (uint16_t *)_effectScratch((size_t)dr.w * dr.h * 2);
+        if (!tmp) return;
+        for (int16_t j = 0; j < dr.h; j++)
+            if (!GFXimageRow(image, sy + j, sx, dr.w, tmp + j * dr.w)) return;
+        uploadAndDrawTex(dr.x, dr.y, dr.w, dr.h, tmp);
+#endif
+        return;
+    }
+
+    // Unkeyed rows decode straight into the target
+    boolean   keyed = image.flags & GFX_IMAGE_KEYED;
+    uint16_t *line  = keyed ? (uint16_t *)_effectScratch((size_t)dr.w * 2) : nullptr;
+    if (keyed && !line) return;
+    int16_t j = 0;
+    for (; j < dr.h; j++) {
+        uint16_t *d = dst.pData + (int32_t)(dr.y + j) * dst.stride + dr.x;
+        if (!keyed) {
+            if (!GFXimageRow(image, sy + j, sx, dr.w, d)) break;
+            continue;
+        }
+        if (!GFXimageRow(image, sy + j, sx, dr.w, line)) break;
+        for (int16_t i = 0; i < dr.w; i++)
+            if (line[i] != image.key) d[i] = line[i];
+    }
+    if (j) addDamage(dr.x, dr.y, dr.w, j);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  ASSET PACK
+// ═════════════════════════════════════════════════════════════════════════════
+// Glyph and frame arrays are used in place, so their in-memory layout is
+// part of the file format.
+
+static_assert(sizeof(GFXassetEntry) == 16, "pack TOC entry layout");
+static_assert(sizeof(GFXglyph)      == 8,  "pack font glyph layout");
+static_assert(sizeof(GFXsdfGlyph)   == 12, "pack SDF glyph layout");
+static_assert(sizeof(GFXatlasFrame) == 16, "pack atlas frame layout");
+
+static inline uint16_t packRead16(const uint8_t *p) {
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t packRead32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Bytes per row of an unpacked image format (0 for RLE)
+static int32_t imageStride(uint8_t format, int16_t w) {
+    switch (format) {
+    case GFX_IMAGE_RGB565: return (int32_t)w * 2;
+    case GFX_IMAGE_INDEX8:
+    case GFX_IMAGE_A8:     return w;
+    case GFX_IMAGE_INDEX4: return (w + 1) >> 1;
+    case GFX_IMAGE_MASK1:  return (w + 7) >> 3;
+    default:               return 0;
+    }
+}
+
+GFXAssetPack::GFXAssetPack()
+    : m_pData(nullptr), m_size(0), m_pToc(nullptr), m_count(0)
+{
+}
+
+uint32_t GFXAssetPack::hash(const char *pName) {
+    uint32_t h = 0x811C9DC5;
+    while (pName && *pName) {
+        h ^= (uint8_t)*pName++;
+        h *= 0x01000193;
+    }
+    return h;
+}
+
+boolean GFXAssetPack::open(const void *pData, uint32_t size) {
+    close();
+    const uint8_t *p = (const uint8_t *)pData;
+    if (!p || ((uintptr_t)p & 3) || size < 16) return false;
+    if (packRead32(p) != GFX_PACK_MAGIC || packRead16(p + 4) != GFX_PACK_VERSION) return false;
+    uint16_t count = packRead16(p + 6);
+    uint32_t toc   = packRead32(p + 8);
+    if (packRead32(p + 12) > size || (toc & 3) || toc > size ||
+        (size - toc) / sizeof(GFXassetEntry) < count) return false;
+
+    const GFXassetEntry *pToc = (const GFXassetEntry *)(p + toc);
+    for (uint16_t i = 0; i < count; i++) {
+        const GFXassetEntry &e = pToc[i];
+        if ((e.offset & 3) || e.offset > size || e.size > size - e.offset) return false;
+        if (i && (pToc[i - 1].hash > e.hash ||
+                  (pToc[i - 1].hash == e.hash && pToc[i - 1].type >= e.type))) return false;
+    }
+    m_pData = p;
+    m_size  = size;
+    m_pToc  = pToc;
+    m_count = count;
+    return true;
+}
+
+void GFXAssetPack::close() {
+    m_pData = nullptr;
+    m_size  = 0;
+    m_pToc  = nullptr;
+    m_count = 0;
+}
+
+const GFXassetEntry *GFXAssetPack::find(uint32_t hash, GFXassetType type) const {
+    uint16_t lo = 0, hi = m_count;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) >> 1;
+        if (m_pToc[mid].hash < hash) lo = mid + 1;
+        else                         hi = mid;
+    }
+    for (; lo < m_count && m_pToc[lo].hash == hash; lo++)
+        if (m_pToc[lo].type == type) return &m_pToc[lo];
+    return nullptr;
+}
+
+const uint8_t *GFXAssetPack::_section(const GFXassetEntry *pEntry, uint32_t minSize) const {
+    return pEntry && pEntry->size >= minSize ? m_pData + pEntry->offset : nullptr;
+}
+
+// Font: u16 first, u16 last, u8 yAdvance, 3 spare, u32 bitmap bytes, 4 spare;
+// then the GFXglyph array and the bitmaps
+boolean GFXAssetPack::getFont(const char *pName, GFXfont *pFont) const {
+    const GFXassetEntry *e = find(pName, GFX_ASSET_FONT);
+    const uint8_t       *s = _section(e, 16);
+    if (!s) return false;
+    uint16_t first = packRead16(s), last = packRead16(s + 2);
+    uint32_t bytes = packRead32(s + 8);
+    if (last < first) return false;
+    uint32_t n = (uint32_t)(last - first + 1);
+    uint32_t table = 16 + n * (uint32_t)sizeof(GFXglyph);      // at most 512 KiB
+    if (table > e->size || bytes > e->size - table) return false;
+
+    const GFXglyph *g = (const GFXglyph *)(s + 16);
+    for (uint32_t i = 0; i < n; i++)
+        if (g[i].bitmapOffset + ((uint32_t)g[i].width * g[i].height + 7) / 8 > bytes) return false;
+    pFont->bitmap   = (u8 *)(s + table);
+    pFont->glyph    = (GFXglyph *)g;
+    pFont->first    = first;
+    pFont->last     = last;
+    pFont->yAdvance = s[4];
+    pFont->color    = nullptr;
+    return true;
+}
+
+// SDF font: u16 first, u16 last, u8 yAdvance, u8 size, u8 spread, 1 spare,
+// u32 field bytes, 4 spare; then the GFXsdfGlyph array and the fields
+boolean GFXAssetPack::getSdfFont(const char *pName, GFXsdfFont *pFont) const {
+    const GFXassetEntry *e = find(pName, GFX_ASSET_SDF_FONT);
+    const uint8_t       *s = _section(e, 16);
+    if (!s) return false;
+    uint16_t first = packRead16(s), last = packRead16(s + 2);
+    uint32_t bytes = packRead32(s + 8);
+    if (last < first) return false;
+    uint32_t n = (uint32_t)(last - first + 1);
+    uint32_t table = 16 + n * (uint32_t)sizeof(GFXsdfGlyph);   // at most 768 KiB
+    if (table > e->size || bytes > e->size - table) return false;
+
+    const GFXsdfGlyph *g = (const GFXsdfGlyph *)(s + 16);
+    for (uint32_t i = 0; i < n; i++)
+        if (g[i].sdfOffset > bytes || (uint32_t)g[i].width * g[i].height > bytes - g[i].sdfOffset)
+            return false;
+    pFont->sdf      = (u8 *)(s + table);
+    pFont->glyph    = (GFXsdfGlyph *)g;
+    pFont->first    = first;
+    pFont->last     = last;
+    pFont->yAdvance = s[4];
+    pFont->size     = s[5];
+    pFont->spread   = s[6];
+    return true;
+}
+
+boolean GFXAssetPack::getImage(const char *pName, GFXimage *pImage) const {
+    return getImage(hash(pName), pImage);
+}
+
+// Image: u16 width, u16 height, u8 format, u8 flags, u16 key, u16 palette
+// entries, 2 spare, u32 data bytes; then the palette (padded to 4 bytes)
+// and the pixel data
+boolean GFXAssetPack::getImage(uint32_t nameHash, GFXimage *pImage) const {
+    const GFXassetEntry *e = find(nameHash, GFX_ASSET_IMAGE);
+    const uint8_t       *s = _section(e, 16);
+    if (!s) return false;
+    GFXimage img;
+    img.width       = (int16_t)packRead16(s);
+    img.height      = (int16_t)packRead16(s + 2);
+    img.format      = s[4];
+    img.flags       = s[5];
+    img.key         = packRead16(s + 6);
+    img.paletteSize = packRead16(s + 8);
+    img.size        = packRead32(s + 12);
+    img.stride      = imageStride(img.format, img.width);
+    uint32_t palBytes = ((uint32_t)img.paletteSize * 2 + 3) & ~3u;
+    if (img.width <= 0 || img.height <= 0 || img.format > GFX_IMAGE_RLE8 ||
+        16 + palBytes > e->size || img.size > e->size - 16 - palBytes) return false;
+
+    boolean indexed = img.format == GFX_IMAGE_INDEX8 || img.format == GFX_IMAGE_INDEX4 ||
+                      img.format == GFX_IMAGE_RLE8;
+    if (indexed && !img.paletteSize) return false;
+    if (img.stride ? (uint32_t)img.stride * img.height > img.size
+                   : (uint32_t)img.height * 4 > img.size) return false;
+    img.pPalette = img.paletteSize ? (const uint16_t *)(s + 16) : nullptr;
+    img.pData    = s + 16 + palBytes;
+    *pImage = img;
+    return true;
+}
+
+// Palette: u16 entries, 2 spare; then the colours
+boolean GFXAssetPack::getPalette(const char *pName, const uint16_t **ppColors, uint16_t *pCount) const {
+    const GFXassetEntry *e = find(pName, GFX_ASSET_PALETTE);
+    const uint8_t       *s = _section(e, 4);
+    if (!s) return false;
+    uint16_t n = packRead16(s);
+    if (4 + (uint32_t)n * 2 > e->size) return false;
+    *ppColors = (const uint16_t *)(s + 4);
+    *pCount   = n;
+    return true;
+}
+
+// Atlas: u32 image name hash, u16 frames, 2 spare; then the GFXatlasFrame
+// array sorted by hash
+boolean GFXAssetPack::getAtlas(const char *pName, GFXatlas *pAtlas) const {
+    const GFXassetEntry *e = find(pName, GFX_ASSET_ATLAS);
+    const uint8_t       *s = _section(e, 8);
+    if (!s) return false;
+    uint16_t n = packRead16(s + 4);
+    if (8 + (uint32_t)n * sizeof(GFXatlasFrame) > e->size) return false;
+    if (!getImage(packRead32(s), &pAtlas->image)) return false;
+    pAtlas->pFrames = (const GFXatlasFrame *)(s + 8);
+    pAtlas->count   = n;
+    return true;
+}
+
+const void *GFXAssetPack::getBlob(const char *pName, uint32_t *pSize) const {
+    const GFXassetEntry *e = find(pName, GFX_ASSET_BLOB);
+    if (!e) return nullptr;
+    if (pSize) *pSize = e->size;
+    return m_pData + e->offset;
+}
+
+const GFXatlasFrame *GFXAssetPack::findFrame(const GFXatlas &atlas, const char *pName) {
+    uint32_t h  = hash(pName);
+    uint16_t lo = 0, hi = atlas.count;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) >> 1;
+        if (atlas.pFrames[mid].hash < h) lo = mid + 1;
+        else                             hi = mid;
+    }
+    return lo < atlas.count && atlas.pFrames[lo].hash == h ? &atlas.pFrames[lo] : nullptr;
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  MONOCHROME / E-PAPER
+// ═════════════════════════════════════════════════════════════════════════════
+
+GFXcanvas1::GFXcanvas1(int16_t w, int16_t h)
+        : m_pData(nullptr), m_width(0), m_height(0), m_stride(0), m_pFont(nullptr),
+          m_cursorX(0), m_cursorY(0), m_textColor(GFX_MONO_WHITE),
+          m_pScratch(nullptr), m_scratchSize(0), m_pPages(nullptr), m_pagesSize(0) {
+    m_damage.clear();
+    if (w <= 0 || h <= 0) return;
+    int32_t stride = ((w + 31) >> 5) * 4;
+    m_pData = (uint8_t *)malloc((size_t)stride * h);
+    if (!m_pData) return;
+    m_width  = w;
+    m_height = h;
+    m_stride = stride;
+    fillScreen(GFX_MONO_BLACK);
+}
+
+GFXcanvas1::~GFXcanvas1() {
+    free(m_pData);
+    free(m_pScratch);
+    free(m_pPages);
+}
+
+GFXbitSurface GFXcanvas1::getSurface() const {
+    GFXbitSurface s = { m_pData, m_width, m_height, m_stride };
+    return s;
+}
+
+void *GFXcanvas1::_grow(void **ppBuf, size_t *pSize, size_t bytes) {
+    if (bytes > *pSize) {
+        void *p = realloc(*ppBuf, bytes);
+        if (!p) return nullptr;
+        *ppBuf = p;
+        *pSize = bytes;
+    }
+    return *ppBuf;
+}
+
+void GFXcanvas1::_damage(int16_t x, int16_t y, int16_t w, int16_t h) {
+    GFXrect r = { x, y, w, h }, bounds = { 0, 0, m_width, m_height };
+    if (GFXrectIntersect(r, bounds, &r)) m_damage.add(r);
+}
+
+// ─── Bit spans ───────────────────────────────────────────────────────────────
+// Partial bytes at the ends are masked; whole bytes in between are filled a
+// 32-bit word at a time (rows start word-aligned).
+
+static inline void monoApply(uint8_t &d, uint8_t bits, uint8_t color) {
+    if      (color == GFX_MONO_WHITE) d |= bits;
+    else if (color == GFX_MONO_BLACK) d &= (uint8_t)~bits;
+    else                              d ^= bits;
+}
+
+void GFXcanvas1::_plot(int16_t x, int16_t y, uint8_t color) {
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height || !m_pData) return;
+    monoApply(m_pData[(int32_t)y * m_stride + (x >> 3)], (uint8_t)(0x80 >> (x & 7)), color);
+}
+
+// Span of a row, already clipped
+void GFXcanvas1::_span(int16_t x, int16_t y, int16_t w, uint8_t color) {
+    uint8_t *row = m_pData + (int32_t)y * m_stride;
+    int32_t  b0  = x >> 3, b1 = (x + w - 1) >> 3;
+    uint8_t  m0  = (uint8_t)(0xFF >> (x & 7));
+    uint8_t  m1  = (uint8_t)(0xFF << (7 - ((x + w - 1) & 7)));
+    if (b0 == b1) {
+        monoApply(row[b0], m0 & m1, color);
+        return;
+    }
+    monoApply(row[b0], m0, color);
+    monoApply(row[b1], m1, color);
+    int32_t b = b0 + 1;
+    if (color != GFX_MONO_INVERSE) {
+        memset(row + b, color == GFX_MONO_WHITE ? 0xFF : 0x00, b1 - b);
+        return;
+    }
+    for (; b < b1 && (b & 3); b++) row[b] ^= 0xFF;
+    for (; b + 4 <= b1; b += 4) {
+        uint32_t v;
+        memcpy(&v, row + b, 4);
+        v = ~v;
+        memcpy(row + b, &v, 4);
+    }
+    for (; b < b1; b++) row[b] ^= 0xFF;
+}
+
+// h rows of w source bits, rowBits apart in pSrc, drawn at (x, y) with the
+// set bits in color.  Clipping moves the source window instead of the bits.
+void GFXcanvas1::_bits(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pSrc,
+                       int32_t rowBits, int32_t srcBytes, uint8_t color) {
+    GFXrect r = { x, y, w, h }, bounds = { 0, 0, m_width, m_height };
+    if (!m_pData || !GFXrectIntersect(r, bounds, &r)) return;
+    int32_t b0 = r.x >> 3, b1 = (r.x + r.w - 1) >> 3;
+    uint8_t m0 = (uint8_t)(0xFF >> (r.x & 7));
+    uint8_t m1 = (uint8_t)(0xFF << (7 - ((r.x + r.w - 1) & 7)));
+    for (int16_t j = 0; j < r.h; j++) {
+        uint8_t *row = m_pData + (int32_t)(r.y + j) * m_stride;
+        int32_t  pos = (int32_t)(r.y + j - y) * rowBits + (r.x - x);
+        for (int32_t b = b0; b <= b1; b++) {
+            uint8_t mask = 0xFF;
+            if (b == b0) mask &= m0;
+            if (b == b1) mask &= m1;
+            monoApply(row[b], fetchBits8(pSrc, pos + (b * 8 - r.x), srcBytes) & mask, color);
+        }
+    }
+    m_damage.add(r);
+}
+
+// ─── Primitives ──────────────────────────────────────────────────────────────
+
+void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint8_t color) {
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height || !m_pData) return;
+    _plot(x, y, color);
+    GFXrect r = { x, y, 1, 1 };
+    m_damage.add(r);
+}
+
+boolean GFXcanvas1::getPixel(int16_t x, int16_t y) const {
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height || !m_pData) return false;
+    return (m_pData[(int32_t)y * m_stride + (x >> 3)] >> (7 - (x & 7))) & 1;
+}
+
+void GFXcanvas1::drawFastHLine(int16_t x, int16_t y, int16_t w, uint8_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void GFXcanvas1::drawFastVLine(int16_t x, int16_t y, int16_t h, uint8_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+void GFXcanvas1::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t color) {
+    GFXrect r = { x, y, w, h }, bounds = { 0, 0, m_width, m_height };
+    if (!m_pData || !GFXrectIntersect(r, bounds, &r)) return;
+    for (int16_t j = 0; j < r.h; j++) _span(r.x, r.y + j, r.w, color);
+    m_damage.add(r);
+}
+
+void GFXcanvas1::fillScreen(uint8_t color) {
+    if (!m_pData) return;
+    if (color == GFX_MONO_INVERSE) {
+        fillRect(0, 0, m_width, m_height, color);
+        return;
+    }
+    memset(m_pData, color == GFX_MONO_WHITE ? 0xFF : 0x00, (size_t)m_stride * m_height);
+    m_damage.clear();
+    _damage(0, 0, m_width, m_height);
+}
+
+void GFXcanvas1::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color) {
+    if (y0 == y1) {
+        if (x1 < x0) SWAP(x0, x1);
+        fillRect(x0, y0, x1 - x0 + 1, 1, color);
+        return;
+    }
+    if (x0 == x1) {
+        if (y1 < y0) SWAP(y0, y1);
+        fillRect(x0, y0, 1, y1 - y0 + 1, color);
+        return;
+    }
+    int16_t dx = ABS(x1 - x0), dy = -ABS(y1 - y0);
+    int16_t sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    _damage(MIN(x0, x1), MIN(y0, y1), dx + 1, -dy + 1);
+    for (;;) {
+        _plot(x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void GFXcanvas1::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t color) {
+    if (w <= 0 || h <= 0) return;
+    fillRect(x, y, w, 1, color);
+    if (h > 1) fillRect(x, y + h - 1, w, 1, color);
+    if (h > 2) {
+        fillRect(x, y + 1, 1, h - 2, color);
+        if (w > 1) fillRect(x + w - 1, y + 1, 1, h - 2, color);
+    }
+}
+
+void GFXcanvas1::drawBitmap(int16_t x, int16_t y, const uint8_t *pBits, int16_t w, int16_t h,
+                            uint8_t color) {
+    if (!pBits || w <= 0 || h <= 0) return;
+    int32_t rowBytes = (w + 7) >> 3;
+    _bits(x, y, w, h, pBits, rowBytes * 8, rowBytes * h, color);
+}
+
+void GFXcanvas1::blit(const GFXbitSurface &src, const GFXrect &srcRect, int16_t x, int16_t y,
+                      GFXblitMode mode) {
+    if (!m_pData) return;
+    GFXblitBits(src, srcRect, getSurface(), x, y, mode);
+    _damage(x, y, srcRect.w, srcRect.h);
+}
+
+// ─── Dithered images ─────────────────────────────────────────────────────────
+
+static const uint8_t s_bayer8[64] = {
+     0, 32,  8, 40,  2, 34, 10, 42,
+    48, 16, 56, 24, 50, 18, 58, 26,
+    12, 44,  4, 36, 14, 46,  6, 38,
+    60, 28, 52, 20, 62, 30, 54, 22,
+     3, 35, 11, 43,  1, 33,  9, 41,
+    51, 19, 59, 27, 49, 17, 57, 25,
+    15, 47,  7, 39, 13, 45,  5, 37,
+    63, 31, 55, 23, 61, 29, 53, 21
+};
+
+static inline int16_t luma565(uint16_t c) {
+    int r = (c >> 11) << 3, g = ((c >> 5) & 0x3F) << 2, b = (c & 0x1F) << 3;
+    r |= r >> 5;
+    g |= g >> 6;
+    b |= b >> 5;
+    return (int16_t)((r * 77 + g * 150 + b * 29) >> 8);
+}
+
+void GFXcanvas1::drawImage(int16_t x, int16_t y, const GFXimage &image, GFXdither dither) {
+    GFXrect r = { x, y, image.width, image.height }, bounds = { 0, 0, m_width, m_height };
+    if (!m_pData || !image.pData || !GFXrectIntersect(r, bounds, &r)) return;
+
+    // One decoded row, then two Floyd–Steinberg error rows with a guard each side
+    size_t    lineBytes = (((size_t)r.w * sizeof(uint16_t)) + 3) & ~(size_t)3;
+    size_t    errCount  = dither == GFX_DITHER_FS ? 2 * ((size_t)r.w + 2) : 0;
+    uint8_t  *pBuf = (uint8_t *)_grow(&m_pScratch, &m_scratchSize,
+                                      lineBytes + errCount * sizeof(int16_t));
+    if (!pBuf) return;
+    uint16_t *line = (uint16_t *)pBuf;
+    int16_t  *cur  = (int16_t *)(pBuf + lineBytes), *next = cur + r.w + 2;
+    if (errCount) memset(cur, 0, errCount * sizeof(int16_t));
+
+    boolean keyed = image.flags & GFX_IMAGE_KEYED;
+    int16_t j = 0;
+    for (; j < r.h; j++) {
+        int16_t py = r.y + j;
+        if (!GFXimageRow(image, py - y, r.x - x, r.w, line)) break;
+        uint8_t *row = m_pData + (int32_t)py * m_stride;
+        const uint8_t *bayer = s_bayer8 + (py & 7) * 8;
+        for (int16_t i = 0; i < r.w; i++) {
+            if (keyed && line[i] == image.key) continue;
+            int16_t px = r.x + i, v = luma565(line[i]);
+            boolean on;
+            if (dither == GFX_DITHER_ORDERED) {
+                on = v > bayer[px & 7] * 4 + 1;
+            } else if (dither == GFX_DITHER_FS) {
+                int16_t e = v + cur[i + 1] / 16;
+                on = e >= 128;
+                e -= on ? 255 : 0;
+                cur [i + 2] += e * 7;
+                next[i]     += e * 3;
+                next[i + 1] += e * 5;
+                next[i + 2] += e;
+            } else {
+                on = v >= 128;
+            }
+            monoApply(row[px >> 3], (uint8_t)(0x80 >> (px & 7)), on ? GFX_MONO_WHITE : GFX_MONO_BLACK);
+        }
+        if (errCount) {
+            SWAP(cur, next);
+            memset(next, 0, ((size_t)r.w + 2) * sizeof(int16_t));
+        }
+    }
+    if (j) _damage(r.x, r.y, r.w, j);
+}
+
+void GFXcanvas1::drawRGBBitmap(int16_t x, int16_t y, const uint16_t *pPixels, int16_t w, int16_t h,
+                               GFXdither dither) {
+    if (!pPixels || w <= 0 || h <= 0) return;
+    GFXimage img = { GFX_IMAGE_RGB565, 0, 0, w, h, (int32_t)w * 2, nullptr, 0,
+                     (const uint8_t *)pPixels, (uint32_t)w * h * 2 };
+    drawImage(x, y, img, dither);
+}
+
+// ─── Text ────────────────────────────────────────────────────────────────────
+
+int16_t GFXcanvas1::drawChar(int16_t x, int16_t y, uint32_t code, uint8_t color) {
+    if (!m_pFont) {
+        // Built-in 5×8 font: column bytes, LSB at the top
+        if (code < 32 || code > 126) code = '?';
+        const uint8_t *glyph = s_font + (code - 32) * 5;
+        for (int8_t col = 0; col < 5; col++)
+            for (int8_t row = 0; row < 8; row++)
+                if (glyph[col] & (1 << row)) _plot(x + col, y + row, color);
+        _damage(x, y, 5, 8);
+        return 6;
+    }
+    const GFXfont *f = m_pFont;
+    if (code < f->first || code > f->last) return 0;
+    const GFXglyph &g = f->glyph[code - f->first];
+    if (g.width && g.height)
+        _bits(x + g.xOffset, y + g.yOffset, g.width, g.height, f->bitmap + g.bitmapOffset,
+              g.width, ((int32_t)g.width * g.height + 7) >> 3, color);
+    return g.xAdvance;
+}
+
+void GFXcanvas1::writeText(const char *pText) {
+    int16_t lineH = m_pFont ? m_pFont->yAdvance : 8;
+    while (*pText) {
+        uint32_t c = utf8Next(pText);
+        if (c == '\n') {
+            m_cursorX  = 0;
+            m_cursorY += lineH;
+        } else if (c != '\r') {
+            m_cursorX += drawChar(m_cursorX, m_cursorY, c, m_textColor);
+        }
+    }
+}
+
+// ─── Partial refresh ─────────────────────────────────────────────────────────
+
+uint8_t GFXcanvas1::getRefreshWindows(uint8_t alignX, uint8_t alignY, uint8_t maxWindows,
+                                      GFXrect *pOut) const {
+    if (!maxWindows || m_damage.isEmpty()) return 0;
+    if (!alignX) alignX = 1;
+    if (!alignY) alignY = 1;
+    GFXregion windows;
+    windows.clear();
+    for (uint8_t i = 0; i < m_damage.count; i++) {
+        const GFXrect &d = m_damage.rects[i];
+        int16_t x0 = d.x & ~(alignX - 1), y0 = d.y & ~(alignY - 1);
+        int16_t x1 = MIN((d.x + d.w + alignX - 1) & ~(alignX - 1), (int)m_width);
+        int16_t y1 = MIN((d.y + d.h + alignY - 1) & ~(alignY - 1), (int)m_height);
+        GFXrect r = { x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0) };
+        windows.add(r);
+    }
+    if (windows.count > maxWindows) {
+        pOut[0] = windows.bounds();
+        return 1;
+    }
+    memcpy(pOut, windows.rects, windows.count * sizeof(GFXrect));
+    return windows.count;
+}
+
+uint8_t GFXcanvas1::flush(GFXDisplaySink &sink, boolean bFull) {
+    if (!m_pData) return 0;
+    GFXsinkLayout layout = sink.getLayout();
+    uint8_t alignX = sink.getAlignX(), alignY = sink.getAlignY();
+    if (layout == GFX_SINK_ROWS  && alignX < 8) alignX = 8;
+    if (layout == GFX_SINK_PAGES && alignY < 8) alignY = 8;
+
+    GFXrect windows[GFX_REGION_MAX_RECTS];
+    uint8_t n;
+    if (bFull) {
+        GFXrect all = { 0, 0, m_width, m_height };
+        windows[0] = all;
+        n = 1;
+    } else {
+        n = getRefreshWindows(alignX, alignY, MIN(sink.getMaxWindows(), GFX_REGION_MAX_RECTS),
+                              windows);
+    }
+
+    GFXrect bounds = { 0, 0, 0, 0 };
+    for (uint8_t i = 0; i < n; i++) {
+        const GFXrect &r = windows[i];
+        if (layout == GFX_SINK_ROWS) {
+            sink.write(r, m_pData + (int32_t)r.y * m_stride + (r.x >> 3), m_stride);
+        } else {
+            // Transpose into pages: bit k of a column byte is row 8p + k
+            int16_t  pages = (r.h + 7) >> 3;
+            uint8_t *out   = (uint8_t *)_grow(&m_pPages, &m_pagesSize, (size_t)pages * r.w);
+            if (!out) break;
+            memset(out, 0, (size_t)pages * r.w);
+            for (int16_t j = 0; j < r.h; j++) {
+                const uint8_t *row = m_pData + (int32_t)(r.y + j) * m_stride;
+                uint8_t       *dst = out + (j >> 3) * r.w;
+                uint8_t        bit = (uint8_t)(1 << (j & 7));
+                for (int16_t i = 0; i < r.w; i++) {
+                    int16_t px = r.x + i;
+                    if (row[px >> 3] & (0x80 >> (px & 7))) dst[i] |= bit;
+                }
+            }
+            sink.write(r, out, r.w);
+        }
+        bounds = GFXrectUnion(bounds, r);
+    }
+    if (n) sink.refresh(bounds, bFull);
+    m_damage.clear();
+    return n;
+}
+
+#ifndef GFX_USE_OPENGL_ES
+
+// ─────────────────────────────────────────────────────────────────────────
+// Multi-Buffer Initialization and Management
+// ─────────────────────────────────────────────────────────────────────────
+
+boolean CircleGFX::enableMultiBuffer(uint8_t numBuffers)
+{
+    // Clamp to valid range (1-3 buffers)
+    if (numBuffers < 1 || numBuffers > 3) {
+        numBuffers = 2;  // Default to double-buffering
+    }
+
+    // Calculate buffer size in bytes
+    size_t bufferSize = (size_t)m_width * (size_t)m_height * sizeof(uint16_t);
+
+    // Free any existing allocated buffers
+    for (uint8_t i = 0; i < m_bufferCount; i++) {
+        if (m_buffers[i].bOwned && m_buffers[i].pData != nullptr) {
+            free(m_buffers[i].pData);
+            m_buffers[i].pData = nullptr;
+            m_buffers[i].bOwned = false;
+        }
+    }
+
+    // Allocate new buffers
+    m_bufferCount = numBuffers;
+    for (uint8_t i = 0; i < m_bufferCount; i++) {
+        m_buffers[i].pData = (uint16_t *)malloc(bufferSize);
+        
+        if (m_buffers[i].pData == nullptr) {
+            // Allocation failed - clean up and revert to single buffer
+            for (uint8_t j = 0; j < i; j++) {
+                free(m_buffers[j].pData);
+                m_buffers[j].pData = nullptr;
+            }
+            m_bufferCount = 1;
+            m_buffers[0].pData = m_pBuffer;  // Revert to original screen buffer
+            m_buffers[0].bOwned = false;
+            m_multiBufferEnabled = false;
+            return false;
+        }
+
+        m_buffers[i].bOwned = true;
+        m_buffers[i].bReady = false;
+        m_buffers[i].nFrame = 0;
+
+        // Initialize buffer to black
+        memset(m_buffers[i].pData, 0, bufferSize);
+    }
+
+    m_drawBufferIndex = 0;
+    m_displayBufferIndex = 0;
+    m_multiBufferEnabled = true;
+    m_pBuffer = m_buffers[0].pData;  // Point to first buffer for drawing
+
+    // Fresh buffers: no history, the first frame is presented in full
+    m_transition.state = 0;
+    m_presentAll = true;
+    m_tileHashValid = false;
+    m_frameCount = 0;
+    memset(m_history, 0, sizeof(m_history));
+    _updateRepairRegion();
+
+    return true;
+}
+
+boolean CircleGFX::isMultiBuffered() const
+{
+    return m_multiBufferEnabled;
+}
+
+uint8_t CircleGFX::getBufferCount() const
+{
+    return m_bufferCount;
+}
+
+uint8_t CircleGFX::getDrawBufferIndex() const
 {
     return m_drawBufferIndex;
 }
@@ -1012,40 +5761,141 @@ void CircleGFX::swapBuffers(boolean autoclear) {
         return;
     }
 
+    // A running transition consumes the swap until its last step
+    if (m_transition.state != 0 && _stepTransition()) {
+        return;
+    }
+
     // Mark current draw buffer as ready
     m_buffers[m_drawBufferIndex].bReady = true;
 
     // This buffer becomes visible
     m_displayBufferIndex = m_drawBufferIndex;
 
-    // Copy to hardware framebuffer
-    if (m_pFrameBuffer != nullptr) {
-        uint32_t bufferSize = m_width * m_height * 2;
-        memcpy((void*)m_pFrameBuffer->GetBuffer(),
-               m_buffers[m_displayBufferIndex].pData,
-               bufferSize);
+    // What differs from the frame on screen: this frame's damage, or
+    // everything if it is unknown (no tracking, buffer cleared ...)
+    GFXregion changed;
+    if (m_damageEnabled && !m_presentAll) {
+        _flushPending();
+        changed = m_damage;
+    } else {
+        _setFullScreen(changed);
+    }
+    m_presentAll = false;
+
+    // Drop tiles whose content did not actually change
+    if (m_pTileHash != nullptr) {
+        _diffTiles(changed);
     }
 
+    // Copy to hardware framebuffer (nothing at all if nothing changed)
+    _present(changed);
+
+    // Remember what this frame changed, for buffers that are reused later
+    m_frameCount++;
+    FrameDamage &entry = m_history[m_frameCount % GFX_DAMAGE_HISTORY];
+    entry.nFrame = m_frameCount;
+    entry.region = changed;
+    m_buffers[m_displayBufferIndex].nFrame = m_frameCount;
+    m_damage.clear();
+
     // Advance draw buffer (round-robin)
     m_drawBufferIndex = (m_drawBufferIndex + 1) % m_bufferCount;
 
     if (autoclear) {
         uint32_t pixelCount = (uint32_t)m_width * (uint32_t)m_height;
         memset(m_buffers[m_drawBufferIndex].pData, 0, pixelCount * 2);
+        m_buffers[m_drawBufferIndex].nFrame = 0;
+        m_presentAll = true;
     }
+    _updateRepairRegion();
 
     // Update pointer
     m_pBuffer = m_buffers[m_drawBufferIndex].pData;
 }
 
+// Copy the given part of the display buffer to the hardware framebuffer
+void CircleGFX::_present(const GFXregion &region) {
+    if (m_pFrameBuffer == nullptr || region.isEmpty()) {
+        return;
+    }
+    uint16_t       *pDst = (uint16_t *)m_pFrameBuffer->GetBuffer();
+    const uint16_t *pSrc = m_buffers[m_displayBufferIndex].pData;
+    const GFXrect  &first = region.rects[0];
+    if (region.count == 1 && first.w == m_width && first.h == m_height) {
+        memcpy(pDst, pSrc, (uint32_t)m_width * m_height * 2);
+        return;
+    }
+    uint32_t stride = m_pitch / 2;
+    for (uint8_t i = 0; i < region.count; i++) {
+        const GFXrect &r = region.rects[i];
+        for (int16_t y = r.y; y < r.y + r.h; y++)
+            memcpy(pDst + y * stride + r.x, pSrc + y * stride + r.x, r.w * 2);
+    }
+}
+
+void CircleGFX::_setFullScreen(GFXregion &region) const {
+    GFXrect screen = { 0, 0, m_width, m_height };
+    region.clear();
+    region.add(screen);
+}
+
+// Union of the damage of every frame presented after the draw buffer's
+// content; the whole screen if any of that history is unknown.
+void CircleGFX::_updateRepairRegion() {
+    const FrameBuffer &buf = m_buffers[m_drawBufferIndex];
+    if (!m_damageEnabled || buf.nFrame == 0 ||
+        m_frameCount - buf.nFrame >= GFX_DAMAGE_HISTORY) {
+        _setFullScreen(m_repair);
+        return;
+    }
+    m_repair.clear();
+    for (uint32_t f = buf.nFrame + 1; f <= m_frameCount; f++) {
+        const FrameDamage &entry = m_history[f % GFX_DAMAGE_HISTORY];
+        if (entry.nFrame != f) {
+            _setFullScreen(m_repair);
+            return;
+        }
+        m_repair.add(entry.region);
+    }
+}
+
+void CircleGFX::beginRepair()
+{
+    _flushPending();
+    m_repairing = true;
+}
+
+void CircleGFX::endRepair()
+{
+    m_pendingValid = false;     // repaint of stale pixels is not new damage
+    m_repairing    = false;
+}
+
+uint8_t CircleGFX::getBufferAge() const
+{
+    const FrameBuffer &buf = m_buffers[m_drawBufferIndex];
+    if (!m_multiBufferEnabled || buf.nFrame == 0) {
+        return 0;
+    }
+    return (uint8_t)MIN(255u, m_frameCount + 1 - buf.nFrame);
+}
+
+const GFXregion &CircleGFX::getRepairRegion() const
+{
+    return m_repair;
+}
+
 boolean CircleGFX::selectDrawBuffer(uint8_t bufferIndex)
 {
     if (!m_multiBufferEnabled || bufferIndex >= m_bufferCount) {
         return false;
     }
 
+    cancelTransition();
     m_drawBufferIndex = bufferIndex;
     m_pBuffer = m_buffers[m_drawBufferIndex].pData;
+    _updateRepairRegion();
     return true;
 }
 
@@ -1055,17 +5905,293 @@ boolean CircleGFX::selectDisplayBuffer(uint8_t bufferIndex)
         return false;
     }
 
+    cancelTransition();
     m_displayBufferIndex = bufferIndex;
 
     // Immediately copy to hardware framebuffer
-    if (m_pFrameBuffer != nullptr) {
-        uint32_t bufferSize = m_width * m_height * 2;  // 16-bit pixels
-        memcpy((void*)m_pFrameBuffer->GetBuffer(), m_buffers[m_displayBufferIndex].pData, bufferSize);
+    GFXregion changed;
+    _setFullScreen(changed);
+    _present(changed);
+    m_tileHashValid = false;
+
+    // Counts as a full-screen frame for buffer-age tracking
+    m_frameCount++;
+    FrameDamage &entry = m_history[m_frameCount % GFX_DAMAGE_HISTORY];
+    entry.nFrame = m_frameCount;
+    entry.region = changed;
+    m_buffers[m_displayBufferIndex].nFrame = m_frameCount;
+    _updateRepairRegion();
+
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────
+// Transitions
+// ─────────────────────────────────────────────────────────────────────────
+
+boolean CircleGFX::startTransition(GFXtransition type, uint16_t frames, uint16_t color)
+{
+    if (!m_multiBufferEnabled || m_bufferCount < 2 || type == GFX_TRANSITION_NONE) {
+        return false;
+    }
+    cancelTransition();
+    m_transition.type   = (uint8_t)type;
+    m_transition.state  = 1;
+    m_transition.frames = frames ? frames : 1;
+    m_transition.frame  = 0;
+    m_transition.color  = color;
+    return true;
+}
+
+void CircleGFX::cancelTransition()
+{
+    if (m_transition.state == 2) {
+        m_presentAll    = true;     // the screen holds a mix of both buffers
+        m_tileHashValid = false;
     }
+    m_transition.state = 0;
+}
 
+boolean CircleGFX::isTransitionActive() const
+{
+    return m_transition.state != 0;
+}
+
+// One swapBuffers() step; false when the swap should run as usual (the
+// final step, which presents the new buffer and resumes rotation).
+boolean CircleGFX::_stepTransition()
+{
+    Transition &tr = m_transition;
+    if (tr.state == 1) {
+        tr.from  = m_displayBufferIndex;
+        tr.to    = m_drawBufferIndex;
+        tr.state = 2;
+        m_buffers[tr.to].bReady = true;
+    }
+    if (++tr.frame >= tr.frames) {
+        cancelTransition();
+        return false;
+    }
+    _composeTransition((uint16_t)(((uint32_t)tr.frame << 8) / tr.frames));
     return true;
 }
 
+// Blend n pixels of a towards b by alpha (0..256) into d
+static void transitionBlendRow(uint16_t *d, const uint16_t *a, const uint16_t *b,
+                               int n, uint16_t alpha) {
+    gfx_u16x8 av = gfxSplat8(alpha);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        gfxStore8(d + i, gfxBlend565x8(gfxLoad8(a + i), gfxLoad8(b + i), av));
+    for (; i < n; i++) d[i] = gfxBlend565(a[i], b[i], alpha);
+}
+
+// Compose step t (0..256) from the old to the new buffer on the hardware
+// framebuffer.  Areas that only ever shrink (the old screen under a slide or
+// wipe) are already on screen and are not rewritten.
+void CircleGFX::_composeTransition(uint16_t t)
+{
+    if (m_pFrameBuffer == nullptr) {
+        return;
+    }
+    uint16_t       *pDst   = (uint16_t *)m_pFrameBuffer->GetBuffer();
+    const uint16_t *pOld   = m_buffers[m_transition.from].pData;
+    const uint16_t *pNew   = m_buffers[m_transition.to].pData;
+    uint32_t        stride = m_pitch / 2;
+    int16_t         w = m_width, h = m_height;
+    int16_t         ox = (int16_t)(((int32_t)w * t) >> 8);   // columns of the new screen
+    int16_t         oy = (int16_t)(((int32_t)h * t) >> 8);   // rows of the new screen
+
+    for (int16_t y = 0; y < h; y++) {
+        uint16_t       *d = pDst + y * stride;
+        const uint16_t *o = pOld + y * stride;
+        const uint16_t *n = pNew + y * stride;
+        switch (m_transition.type) {
+            case GFX_TRANSITION_SLIDE_LEFT:
+                memcpy(d + (w - ox), n, ox * 2);
+                break;
+            case GFX_TRANSITION_SLIDE_RIGHT:
+                memcpy(d, n + (w - ox), ox * 2);
+                break;
+            case GFX_TRANSITION_PUSH_LEFT:
+                memcpy(d, o + ox, (w - ox) * 2);
+                memcpy(d + (w - ox), n, ox * 2);
+                break;
+            case GFX_TRANSITION_PUSH_RIGHT:
+                memcpy(d, n + (w - ox), ox * 2);
+                memcpy(d + ox, o, (w - ox) * 2);
+                break;
+            case GFX_TRANSITION_WIPE_LEFT:
+                memcpy(d + (w - ox), n + (w - ox), ox * 2);
+                break;
+            case GFX_TRANSITION_WIPE_RIGHT:
+                memcpy(d, n, ox * 2);
+                break;
+            case GFX_TRANSITION_SLIDE_UP:
+                if (y >= h - oy) memcpy(d, pNew + (y - (h - oy)) * stride, w * 2);
+                break;
+            case GFX_TRANSITION_SLIDE_DOWN:
+                if (y < oy) memcpy(d, pNew + (y + (h - oy)) * stride, w * 2);
+                break;
+            case GFX_TRANSITION_PUSH_UP:
+                memcpy(d, y < h - oy ? pOld + (y + oy) * stride
+                                     : pNew + (y - (h - oy)) * stride, w * 2);
+                break;
+            case GFX_TRANSITION_PUSH_DOWN:
+                memcpy(d, y < oy ? pNew + (y + (h - oy)) * stride
+                                 : pOld + (y - oy) * stride, w * 2);
+                break;
+            case GFX_TRANSITION_WIPE_UP:
+                if (y >= h - oy) memcpy(d, n, w * 2);
+                break;
+            case GFX_TRANSITION_WIPE_DOWN:
+                if (y < oy) memcpy(d, n, w * 2);
+                break;
+            case GFX_TRANSITION_FADE: {
+                // Old -> colour over the first half, colour -> new over the second
+                uint16_t c = m_transition.color;
+                int i = 0;
+                if (t < 128) {
+                    gfx_u16x8 cv = gfxSplat8(c), av = gfxSplat8((uint16_t)(t * 2));
+                    for (; i + 8 <= w; i += 8)
+                        gfxStore8(d + i, gfxBlend565x8(gfxLoad8(o + i), cv, av));
+                    for (; i < w; i++) d[i] = gfxBlend565(o[i], c, (uint16_t)(t * 2));
+                } else {
+                    gfx_u16x8 cv = gfxSplat8(c), av = gfxSplat8((uint16_t)((t - 128) * 2));
+                    for (; i + 8 <= w; i += 8)
+                        gfxStore8(d + i, gfxBlend565x8(cv, gfxLoad8(n + i), av));
+                    for (; i < w; i++) d[i] = gfxBlend565(c, n[i], (uint16_t)((t - 128) * 2));
+                }
+                break;
+            }
+            case GFX_TRANSITION_CROSSFADE:
+            default:
+                transitionBlendRow(d, o, n, w, t);
+                break;
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────
+// Tile Diffing
+// ─────────────────────────────────────────────────────────────────────────
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+
+// CRC32 over the tile, 4 pixels per instruction
+typedef uint32_t TileHash;
+
+static inline void tileHashInit(TileHash &h) { h = 0xFFFFFFFFu; }
+
+static inline void tileHashRow(TileHash &h, const uint16_t *p, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint64_t v;
+        memcpy(&v, p + i, sizeof(v));
+        h = __crc32d(h, v);
+    }
+    for (; i < n; i++) h = __crc32h(h, p[i]);
+}
+
+static inline uint32_t tileHashFinish(const TileHash &h) { return ~h; }
+
+#else
+
+// Four-lane multiply-xor hash, 8 pixels per step.  Every step is a bijection
+// of each lane, so a change to any single word always changes the result.
+typedef gfx_u32x4 TileHash;
+
+static inline void tileHashInit(TileHash &h) {
+    h = (gfx_u32x4){ 0x811C9DC5u, 0x01000193u, 0x9E3779B9u, 0x85EBCA6Bu };
+}
+
+static inline void tileHashRow(TileHash &h, const uint16_t *p, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        gfx_u32x4 v;
+        memcpy(&v, p + i, sizeof(v));
+        h = (h ^ v) * 0x9E3779B1u;
+    }
+    for (; i < n; i++) h[0] = (h[0] ^ p[i]) * 0x01000193u;
+}
+
+static inline uint32_t tileHashFinish(const TileHash &h) {
+    return h[0] ^ ((h[1] << 8) | (h[1] >> 24)) ^ ((h[2] << 16) | (h[2] >> 16)) ^ ((h[3] << 24) | (h[3] >> 8));
+}
+
+#endif
+
+boolean CircleGFX::setTileDiffing(boolean enable)
+{
+    free(m_pTileHash);
+    m_pTileHash = nullptr;
+    m_tileHashValid = false;
+    if (!enable) {
+        return true;
+    }
+    m_tilesX = (uint16_t)((m_width  + GFX_TILE_SIZE - 1) / GFX_TILE_SIZE);
+    m_tilesY = (uint16_t)((m_height + GFX_TILE_SIZE - 1) / GFX_TILE_SIZE);
+    m_pTileHash = (uint32_t *)malloc((size_t)m_tilesX * m_tilesY * sizeof(uint32_t));
+    return m_pTileHash != nullptr;
+}
+
+boolean CircleGFX::isTileDiffing() const
+{
+    return m_pTileHash != nullptr;
+}
+
+// Replace the changed region by the tiles inside it whose content differs
+// from what was last presented; runs of changed tiles become one rectangle.
+void CircleGFX::_diffTiles(GFXregion &changed)
+{
+    if (!m_tileHashValid) {
+        _setFullScreen(changed);        // rehash everything below
+    }
+    const uint16_t *pBuf   = m_buffers[m_displayBufferIndex].pData;
+    uint32_t        stride = m_pitch / 2;
+
+    // Which tiles to look at
+    GFXrect bounds = changed.bounds();
+    int tx0 = bounds.x / GFX_TILE_SIZE, tx1 = (bounds.x + bounds.w - 1) / GFX_TILE_SIZE;
+    int ty0 = bounds.y / GFX_TILE_SIZE, ty1 = (bounds.y + bounds.h - 1) / GFX_TILE_SIZE;
+
+    GFXregion actual;
+    actual.clear();
+    for (int ty = ty0; ty <= ty1 && !changed.isEmpty(); ty++) {
+        int16_t y = (int16_t)(ty * GFX_TILE_SIZE);
+        int16_t h = (int16_t)MIN(GFX_TILE_SIZE, m_height - y);
+        int16_t runX = -1;
+        for (int tx = tx0; tx <= tx1 + 1; tx++) {
+            boolean differs = false;
+            int16_t x = (int16_t)(tx * GFX_TILE_SIZE);
+            if (tx <= tx1) {
+                int16_t w = (int16_t)MIN(GFX_TILE_SIZE, m_width - x);
+                GFXrect tile = { x, y, w, h };
+                if (changed.intersects(tile)) {
+                    TileHash state;
+                    tileHashInit(state);
+                    for (int16_t j = 0; j < h; j++)
+                        tileHashRow(state, pBuf + (y + j) * stride + x, w);
+                    uint32_t hash = tileHashFinish(state);
+                    uint32_t &stored = m_pTileHash[ty * m_tilesX + tx];
+                    differs = !m_tileHashValid || stored != hash;
+                    stored = hash;
+                }
+            }
+            if (differs && runX < 0) {
+                runX = x;
+            } else if (!differs && runX >= 0) {
+                GFXrect run = { runX, y, (int16_t)(MIN(x, m_width) - runX), h };
+                actual.add(run);
+                runX = -1;
+            }
+        }
+    }
+    m_tileHashValid = true;
+    changed = actual;
+}
+
 // ─────────────────────────────────────────────────────────────────────────
 // Buffer Clearing and Access
 // ─────────────────────────────────────────────────────────────────────────
@@ -1086,12 +6212,16 @@ void CircleGFX::clearBuffer(int8_t bufferIndex, uint16_t color)
                         m_buffers[i].pData[j] = color;
                     }
                 }
+                m_buffers[i].nFrame = 0;
             }
         }
+        m_presentAll = true;
     } else if (bufferIndex == -2) {
         // clear last buffer
         uint32_t pixelCount = (uint32_t)m_width * (uint32_t)m_height;
         memset(m_buffers[m_drawBufferIndex].pData, 0, pixelCount * 2);
+        m_buffers[m_drawBufferIndex].nFrame = 0;
+        m_presentAll = true;
     } else if (bufferIndex < m_bufferCount) {
         // Clear specific buffer
         if (m_buffers[bufferIndex].pData != nullptr) {
@@ -1102,8 +6232,11 @@ void CircleGFX::clearBuffer(int8_t bufferIndex, uint16_t color)
                     m_buffers[bufferIndex].pData[j] = color;
                 }
             }
+            m_buffers[bufferIndex].nFrame = 0;
+            if (bufferIndex == m_drawBufferIndex) m_presentAll = true;
         }
     }
+    _updateRepairRegion();
 }
 
 uint16_t* CircleGFX::getBuffer(uint8_t bufferIndex)
@@ -1133,6 +6266,7 @@ boolean CircleGFX::attachExternalBuffer(uint8_t bufferIndex, uint16_t *pBuffer)
     m_buffers[bufferIndex].pData = pBuffer;
     m_buffers[bufferIndex].bOwned = false;  // Not owned, don't free on cleanup
     m_buffers[bufferIndex].bReady = false;
+    m_buffers[bufferIndex].nFrame = 0;      // Content unknown
 
     // Update buffer count if needed
     if (bufferIndex >= m_bufferCount) {
@@ -1151,6 +6285,7 @@ boolean CircleGFX::detachExternalBuffer(uint8_t bufferIndex)
     if (!m_buffers[bufferIndex].bOwned) {
         m_buffers[bufferIndex].pData = nullptr;
         m_buffers[bufferIndex].bReady = false;
+        m_buffers[bufferIndex].nFrame = 0;
         return true;
     }
 
@@ -1170,12 +6305,23 @@ void CircleGFX::_initializeMultiBuffer()
         m_buffers[i].pData = nullptr;
         m_buffers[i].bOwned = false;
         m_buffers[i].bReady = false;
+        m_buffers[i].nFrame = 0;
     }
 
     m_bufferCount = 1;
     m_drawBufferIndex = 0;
     m_displayBufferIndex = 0;
     m_multiBufferEnabled = false;
+    m_frameCount = 0;
+    memset(m_history, 0, sizeof(m_history));
+    m_repair.clear();
+    m_presentAll = true;
+    m_repairing = false;
+    m_pTileHash = nullptr;
+    m_tilesX = 0;
+    m_tilesY = 0;
+    m_tileHashValid = false;
+    memset(&m_transition, 0, sizeof(m_transition));
 
     // Set the main buffer pointer to the primary buffer
     m_buffers[0].pData = m_pBuffer;
@@ -1192,6 +6338,8 @@ void CircleGFX::_cleanupMultiBuffer()
             m_buffers[i].pData = nullptr;
         }
     }
+    free(m_pTileHash);
+    m_pTileHash = nullptr;
     m_multiBufferEnabled = false;
 }
 
@@ -37,6 +37,29 @@ typedef struct {
     s8  yOffset;      ///< Y dist from cursor pos to UL corner
 } GFXglyph;
 
+/// alphaOffset of a colour glyph without alpha channel
+#define GFX_GLYPH_OPAQUE 0xFFFFFFFFu
+
+/// Colour glyph (icon) data stored PER GLYPH
+typedef struct {
+    u32 pixelOffset;  ///< Offset into GFXcolorGlyphs->pixels (RGB565)
+    u32 alphaOffset;  ///< Offset into GFXcolorGlyphs->alpha (A8), or GFX_GLYPH_OPAQUE
+    u8  width;        ///< Bitmap dimensions in pixels
+    u8  height;       ///< Bitmap dimensions in pixels
+    u8  xAdvance;     ///< Distance to advance cursor (x axis)
+    s8  xOffset;      ///< X dist from cursor pos to UL corner
+    s8  yOffset;      ///< Y dist from cursor pos to UL corner
+} GFXcolorGlyph;
+
+/// Colour glyphs for a codepoint range, usually private use (U+E000 ...)
+typedef struct {
+    u16           *pixels; ///< RGB565 pixels, concatenated
+    u8            *alpha;  ///< A8 masks, concatenated (may be nullptr)
+    GFXcolorGlyph *glyph;  ///< Glyph array
+    u32            first;  ///< First codepoint
+    u32            last;   ///< Last codepoint
+} GFXcolorGlyphs;
+
 /// Data stored for FONT AS A WHOLE
 typedef struct {
     u8  *bitmap;  ///< Glyph bitmaps, concatenated
@@ -44,8 +67,438 @@ typedef struct {
     u16  first;   ///< ASCII extents (first char)
     u16  last;    ///< ASCII extents (last char)
     u8   yAdvance;///< Newline distance (y axis)
+    GFXcolorGlyphs *color; ///< Optional colour glyphs (nullptr = none)
 } GFXfont;
 
+/// Signed-distance-field glyph (metrics at the font's base size)
+typedef struct {
+    u32 sdfOffset;    ///< Offset into GFXsdfFont->sdf
+    u8  width;        ///< Field size in samples (glyph plus spread on each side)
+    u8  height;       ///< Field size in samples
+    u8  xAdvance;     ///< Distance to advance cursor (x axis)
+    s8  xOffset;      ///< X dist from cursor pos to UL corner of the field
+    s8  yOffset;      ///< Y dist from cursor pos to UL corner of the field
+} GFXsdfGlyph;
+
+/// Signed-distance-field font: one asset, drawn smoothly at any pixel size
+typedef struct {
+    u8          *sdf;      ///< 8-bit distances, row-major; 128 = edge, higher = inside
+    GFXsdfGlyph *glyph;    ///< Glyph array
+    u16  first;            ///< First codepoint
+    u16  last;             ///< Last codepoint
+    u8   yAdvance;         ///< Newline distance at the base size
+    u8   size;             ///< Base size in pixels the field was sampled at
+    u8   spread;           ///< Distance in base pixels that maps to ±127
+} GFXsdfFont;
+
+// ===== SURFACES AND CANVASES ==================================================
+
+/// Rectangle in pixel coordinates
+typedef struct {
+    int16_t x, y;     ///< Top-left corner
+    int16_t w, h;     ///< Size in pixels
+} GFXrect;
+
+/// View onto a CPU-addressable RGB565 pixel buffer
+typedef struct {
+    uint16_t *pData;  ///< First pixel of the buffer
+    int16_t   width;  ///< Width in pixels
+    int16_t   height; ///< Height in pixels
+    int32_t   stride; ///< Distance between rows, in pixels
+} GFXsurface;
+
+/// View onto a packed 1-bit buffer (MSB-first, rows padded to whole bytes)
+typedef struct {
+    uint8_t *pData;   ///< First byte of the buffer
+    int16_t  width;   ///< Width in pixels
+    int16_t  height;  ///< Height in pixels
+    int32_t  stride;  ///< Distance between rows, in bytes
+} GFXbitSurface;
+
+/// How blit() combines source and destination pixels
+enum GFXblitMode {
+    GFX_BLIT_COPY,      ///< dst = src
+    GFX_BLIT_COLORKEY,  ///< dst = src, except where src == param (transparent)
+    GFX_BLIT_XOR,       ///< dst ^= src
+    GFX_BLIT_AND,       ///< dst &= src
+    GFX_BLIT_OR,        ///< dst |= src
+    GFX_BLIT_ALPHA,     ///< dst = dst + (src - dst) * param / 255
+    GFX_BLIT_ADD,       ///< per-channel saturating add
+    GFX_BLIT_MULTIPLY   ///< per-channel multiply
+};
+
+/// Maximum number of rectangles kept in a GFXregion before they are merged
+#define GFX_REGION_MAX_RECTS 16
+
+/**
+ * @struct GFXregion
+ * @brief Small set of rectangles used for damage / dirty tracking.
+ *        Overlapping rectangles are merged on insertion; once the set is full
+ *        the new rectangle is merged into the one it grows the least.
+ */
+struct GFXregion {
+    GFXrect rects[GFX_REGION_MAX_RECTS];  ///< Disjoint-ish rectangles
+    uint8_t count;                        ///< Number of valid entries
+
+    void    clear  ()       { count = 0; }
+    boolean isEmpty() const { return count == 0; }
+    void    add    (const GFXrect &r);
+    void    add    (const GFXregion &other);
+    GFXrect bounds () const;
+    boolean intersects(const GFXrect &r) const;
+};
+
+/// Intersect two rectangles; returns false (and w = h = 0) if they do not overlap.
+boolean GFXrectIntersect(const GFXrect &a, const GFXrect &b, GFXrect *pOut);
+/// Smallest rectangle containing both (empty inputs are ignored).
+GFXrect GFXrectUnion    (const GFXrect &a, const GFXrect &b);
+
+/**
+ * @brief Raster-op blit between 1-bit surfaces using shifted byte windows.
+ *        Supports GFX_BLIT_COPY, _XOR, _AND and _OR (_COLORKEY acts as OR:
+ *        clear source bits are transparent).  Source and destination may be
+ *        the same, overlapping surface.
+ */
+void    GFXblitBits     (const GFXbitSurface &src, const GFXrect &srcRect,
+                         const GFXbitSurface &dst, int16_t dstX, int16_t dstY,
+                         GFXblitMode mode = GFX_BLIT_COPY);
+
+/**
+ * @class GFXcanvas16
+ * @brief Off-screen RGB565 drawing surface.
+ *        Bind it with CircleGFX::setDrawTarget() to draw into it with the
+ *        regular primitives, or use it as a source / target for effects.
+ */
+class GFXcanvas16 {
+public:
+    /// Allocate a canvas of w×h pixels (check getBuffer() for nullptr).
+    GFXcanvas16(int16_t w, int16_t h);
+    /// Wrap an external buffer of w×h pixels; it is not freed by the canvas.
+    GFXcanvas16(int16_t w, int16_t h, uint16_t *pBuffer);
+    ~GFXcanvas16();
+
+    GFXcanvas16(const GFXcanvas16 &) = delete;
+    GFXcanvas16 &operator=(const GFXcanvas16 &) = delete;
+
+    uint16_t  *getBuffer () const { return m_pData; }
+    int16_t    width     () const { return m_width; }
+    int16_t    height    () const { return m_height; }
+    GFXsurface getSurface() const;
+    void       fillScreen(uint16_t color);
+
+    void setPixel(int16_t x, int16_t y, uint16_t color) {
+        if (x < 0 || x >= m_width || y < 0 || y >= m_height || !m_pData) return;
+        m_pData[y * m_width + x] = color;
+    }
+    uint16_t getPixel(int16_t x, int16_t y) const {
+        if (x < 0 || x >= m_width || y < 0 || y >= m_height || !m_pData) return 0;
+        return m_pData[y * m_width + x];
+    }
+
+private:
+    uint16_t *m_pData;
+    int16_t   m_width;
+    int16_t   m_height;
+    boolean   m_bOwned;
+};
+
+// ===== INDEXED CANVASES / PALETTE ANIMATION ===================================
+
+/// Maximum number of palette cycles per GFXcanvas8
+#define GFX_MAX_PALETTE_CYCLES 8
+
+/// How a palette range is rotated
+enum GFXpaletteCycleMode {
+    GFX_CYCLE_FORWARD,   ///< Colours move towards higher indices, wrapping
+    GFX_CYCLE_BACKWARD,  ///< Colours move towards lower indices, wrapping
+    GFX_CYCLE_PINGPONG   ///< Forward, then back again
+};
+
+/// One animated palette range
+typedef struct {
+    uint8_t  first;      ///< First palette index
+    uint16_t count;      ///< Number of entries (0 = slot unused)
+    uint16_t stepMs;     ///< Time per one-entry step
+    uint8_t  mode;       ///< GFXpaletteCycleMode
+    uint32_t startMs;    ///< Time of the first update
+    int16_t  phase;      ///< Current rotation, -1 before the first update
+} GFXpaletteCycle;
+
+/**
+ * @class GFXcanvas8
+ * @brief Off-screen 8-bit indexed surface with a 256-colour RGB565 palette.
+ *        Palette ranges can be animated; CircleGFX::drawCanvas8() expands
+ *        the indices through the animated palette, so animated areas change
+ *        without redrawing their pixels.  A per-index usage map turns palette
+ *        changes into damage rectangles.
+ */
+class GFXcanvas8 {
+public:
+    GFXcanvas8(int16_t w, int16_t h);
+    ~GFXcanvas8();
+
+    GFXcanvas8(const GFXcanvas8 &) = delete;
+    GFXcanvas8 &operator=(const GFXcanvas8 &) = delete;
+
+    uint8_t *getBuffer() const { return m_pData; }
+    int16_t  width    () const { return m_width; }
+    int16_t  height   () const { return m_height; }
+
+    // ── Palette ──────────────────────────────────────────────────────────────
+    void            setPalette(uint8_t index, uint16_t color);
+    void            setPalette(const uint16_t *pColors, uint8_t first, uint16_t count);
+    uint16_t        getPalette(uint8_t index) const { return m_palette[index]; }
+    /// Palette after animation, as used for expansion
+    const uint16_t *getLUT    () const { return m_lut; }
+
+    // ── Drawing (palette indices) ────────────────────────────────────────────
+    void drawPixel    (int16_t x, int16_t y, uint8_t index);
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint8_t index);
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint8_t index);
+    void fillRect     (int16_t x, int16_t y, int16_t w, int16_t h, uint8_t index);
+    void fillScreen   (uint8_t index);
+    void drawBitmap   (int16_t x, int16_t y, const uint8_t *pIndices, int16_t w, int16_t h);
+
+    // ── Palette animation ────────────────────────────────────────────────────
+    /**
+     * @brief Animate palette entries [first, first+count).
+     * @return Cycle id, or -1 if all GFX_MAX_PALETTE_CYCLES slots are taken.
+     */
+    int8_t  addPaletteCycle   (uint8_t first, uint16_t count, uint16_t stepMs,
+                               GFXpaletteCycleMode mode = GFX_CYCLE_FORWARD);
+    void    removePaletteCycle(int8_t id);
+    /**
+     * @brief Advance all cycles to the given time (e.g. CTimer ticks / 1000).
+     * @return true if any displayed colour changed.
+     */
+    boolean updatePalette     (uint32_t nowMs);
+
+    // ── Damage (canvas coordinates) ──────────────────────────────────────────
+    /// Area whose displayed colours changed through drawing or animation
+    const GFXregion &getDamage  () const { return m_damage; }
+    void             clearDamage()       { m_damage.clear(); }
+    /// Bounding box of all pixels using a palette index (w = 0 if unused)
+    const GFXrect   &getUsage   (uint8_t index) const { return m_usage[index]; }
+
+private:
+    void _use(uint8_t index, int16_t x, int16_t y, int16_t w, int16_t h);
+    void _applyCycle(const GFXpaletteCycle &c);
+
+    uint8_t        *m_pData;
+    int16_t         m_width;
+    int16_t         m_height;
+    uint16_t        m_palette[256];   ///< Base palette
+    uint16_t        m_lut[256];       ///< Animated palette
+    GFXrect         m_usage[256];     ///< Per-index bounding boxes
+    GFXpaletteCycle m_cycles[GFX_MAX_PALETTE_CYCLES];
+    GFXregion       m_damage;
+};
+
+// ===== REGION EFFECTS =========================================================
+
+/// Number of (size, radius) shadow profiles kept by drawShadow()
+#define GFX_SHADOW_CACHE_SIZE 8
+
+/// Cached blurred edge profile of a rectangle shadow
+typedef struct {
+    int16_t  w, h;        ///< Rectangle size
+    uint8_t  radius;      ///< Blur radius
+    int16_t  extent;      ///< Distance the shadow reaches past each edge
+    uint8_t *pProfile;    ///< Horizontal (w+2*extent) then vertical (h+2*extent) coverage
+    uint32_t lastUse;     ///< LRU stamp
+} GFXshadowProfile;
+
+// ===== GLYPH CACHE ============================================================
+
+/// Glyph cache geometry: GFX_GLYPH_CACHE_SETS sets of GFX_GLYPH_CACHE_WAYS entries
+#define GFX_GLYPH_CACHE_SETS 16
+#define GFX_GLYPH_CACHE_WAYS 4
+
+/// Direction text runs in (glyphs are rotated to match)
+enum GFXtextDirection {
+    GFX_TEXT_RIGHT,       ///< Normal horizontal text
+    GFX_TEXT_DOWN,        ///< Rotated 90° clockwise, runs top to bottom
+    GFX_TEXT_LEFT,        ///< Rotated 180°, runs right to left
+    GFX_TEXT_UP           ///< Rotated 90° counter-clockwise, runs bottom to top
+};
+
+/// Text decoration drawn behind the glyphs
+enum GFXtextStyle {
+    GFX_TEXT_PLAIN,       ///< No decoration
+    GFX_TEXT_OUTLINE,     ///< Glyph dilated by a radius
+    GFX_TEXT_SHADOW       ///< Glyph offset by (dx, dy)
+};
+
+/// Pixel formats of cached glyph images
+enum GFXglyphFormat {
+    GFX_GLYPH_A8,         ///< 8-bit coverage, drawn in the text colour
+    GFX_GLYPH_RGB565,     ///< Opaque colour image
+    GFX_GLYPH_RGB565A8,   ///< Colour image followed by an 8-bit alpha plane
+    GFX_GLYPH_A8X2        ///< Glyph coverage followed by decoration coverage
+};
+
+/// Ready-to-blit glyph image
+typedef struct {
+    const void *pFont;    ///< Source glyph table (nullptr = free slot)
+    uint32_t    code;     ///< Codepoint
+    uint32_t    variant;  ///< Rendering variant: bits 0-7 x scale, 8-15 y scale,
+                          ///< 16-17 GFXtextDirection, 18-19 GFXtextStyle,
+                          ///< 20-27 style parameters, 28 fixed-size cell
+    uint8_t     format;   ///< GFXglyphFormat
+    int16_t     w, h;     ///< Image size
+    int16_t     xOffset;  ///< X dist from cursor pos to UL corner
+    int16_t     yOffset;  ///< Y dist from cursor pos to UL corner
+    uint8_t    *pData;    ///< Pixels (A8, RGB565 then A8, or A8 then A8)
+    uint32_t    lastUse;  ///< LRU stamp
+} GFXcachedGlyph;
+
+// ===== IMAGES =================================================================
+// Packed, indexed and run-length coded images, as stored in a GFXAssetPack.
+
+/// Pixel formats of a GFXimage
+enum GFXimageFormat {
+    GFX_IMAGE_RGB565,         ///< 2 bytes per pixel
+    GFX_IMAGE_INDEX8,         ///< 1 byte per pixel, through the palette
+    GFX_IMAGE_INDEX4,         ///< 2 pixels per byte, high nibble first
+    GFX_IMAGE_A8,             ///< Coverage only; decodes as grey
+    GFX_IMAGE_MASK1,          ///< 1 bit, MSB first (drawRGBBitmap() / GFXcollider masks)
+    GFX_IMAGE_RLE565,         ///< Run-length coded RGB565
+    GFX_IMAGE_RLE8            ///< Run-length coded palette indices
+};
+
+/// GFXimage flags
+#define GFX_IMAGE_KEYED 0x01  ///< Pixels of colour key are transparent
+
+/**
+ * @brief View of an image.  Unpacked formats have rows stride bytes apart
+ *        (padded to whole bytes).  RLE formats start with one uint32_t
+ *        offset per row (from pData), then per row a sequence of packets:
+ *        a control byte c < 128 followed by c + 1 literal pixels, or
+ *        c >= 128 followed by one pixel repeated c - 127 times.
+ */
+typedef struct {
+    uint8_t         format;       ///< GFXimageFormat
+    uint8_t         flags;        ///< GFX_IMAGE_*
+    uint16_t        key;          ///< Transparent colour (RGB565, after the palette)
+    int16_t         width;
+    int16_t         height;
+    int32_t         stride;       ///< Bytes per row (unpacked formats)
+    const uint16_t *pPalette;     ///< Indexed formats
+    uint16_t        paletteSize;
+    const uint8_t  *pData;
+    uint32_t        size;         ///< Bytes at pData
+} GFXimage;
+
+/**
+ * @brief Decode pixels [x, x+w) of row y of a colour image (any format)
+ *        to RGB565.  A8 decodes as grey levels, MASK1 as black and white.
+ * @return false if out of range or the image is malformed.
+ */
+boolean GFXimageRow(const GFXimage &img, int16_t y, int16_t x, int16_t w, uint16_t *pOut);
+
+// ===== PARTICLES ==============================================================
+
+/// Fractional bits of particle positions and velocities (16.16 fixed point)
+#define GFX_PARTICLE_FRAC 16
+/// Pixels (or pixels per tick) to particle fixed point
+#define GFX_PARTICLE_FIX(v) ((int32_t)((v) * (1 << GFX_PARTICLE_FRAC)))
+
+/// Ranges that GFXParticles::emit() draws new particles from
+typedef struct {
+    int32_t  x, y;                ///< Emission point (16.16)
+    int32_t  jitterX, jitterY;    ///< Position spread, ± (16.16)
+    int32_t  vx0, vx1;            ///< Velocity ranges per tick (16.16)
+    int32_t  vy0, vy1;
+    uint16_t life0, life1;        ///< Lifetime range in ticks (at least 1)
+    uint16_t color;
+} GFXemitter;
+
+/**
+ * @class GFXParticles
+ * @brief Particle storage as separate arrays per field, so update() runs
+ *        four particles per vector step through the fixed-point integration
+ *        and CircleGFX::drawParticles() streams through positions and
+ *        colours.  Dead and culled particles are removed by moving the last
+ *        one into their place.
+ */
+class GFXParticles {
+public:
+    /// Room for capacity particles (check getCapacity() for allocation)
+    GFXParticles(uint32_t capacity);
+    ~GFXParticles();
+
+    GFXParticles(const GFXParticles &) = delete;
+    GFXParticles &operator=(const GFXParticles &) = delete;
+
+    // ── Spawning ─────────────────────────────────────────────────────────────
+    /// @return false if full
+    boolean  add (int32_t x, int32_t y, int32_t vx, int32_t vy, uint16_t life, uint16_t color);
+    /// @return Number of particles added (fewer if full)
+    uint32_t emit(uint32_t count, const GFXemitter &e);
+    void     clear() { m_count = 0; }
+
+    // ── Simulation ───────────────────────────────────────────────────────────
+    /// Acceleration added to every velocity per tick (16.16)
+    void setGravity (int32_t ax, int32_t ay) { m_ax = ax; m_ay = ay; }
+    /// Velocity kept per tick in 1/256 (256 = no drag; keep |v| < 128 px/tick)
+    void setDrag    (uint16_t drag)          { m_drag = MIN(drag, (uint16_t)256); }
+    /// Particles leaving r die (w = 0: never culled)
+    void setCullRect(const GFXrect &r)       { m_cull = r; }
+    /**
+     * @brief Advance one tick: integrate, age, cull.  Also recomputes
+     *        getBounds().
+     */
+    void update();
+
+    // ── Appearance ───────────────────────────────────────────────────────────
+    /// Fade out over the last ticks of each life (0 = no fade)
+    void setFade (uint16_t ticks)            { m_fade = ticks; }
+    /// A8 image drawn (tinted) per particle, centred; nullptr = one pixel.
+    /// OpenGL ES mode uploads it again only when the pointer or size
+    /// changes, so give an edited brush a new buffer rather than changing
+    /// it in place.
+    void setBrush(const uint8_t *pAlpha, uint8_t w, uint8_t h);
+
+    // ── Access ───────────────────────────────────────────────────────────────
+    uint32_t count      () const { return m_count; }
+    uint32_t getCapacity() const { return m_capacity; }
+    /// Screen area covered by the particles as of the last update()
+    GFXrect  getBounds  () const { return m_bounds; }
+    /// Opacity (0..256) of particle i from its remaining life
+    uint16_t getFade    (uint32_t i) const {
+        return (!m_fade || m_pLife[i] >= m_fade) ? 256 : (uint16_t)((m_pLife[i] << 8) / m_fade);
+    }
+
+    const int32_t  *getX    () const { return m_pX; }
+    const int32_t  *getY    () const { return m_pY; }
+    const uint16_t *getLife () const { return m_pLife; }
+    const uint16_t *getColor() const { return m_pColor; }
+    const uint8_t  *getBrush(uint8_t *pW, uint8_t *pH) const {
+        *pW = m_brushW;
+        *pH = m_brushH;
+        return m_pBrush;
+    }
+
+private:
+    uint32_t _random(uint32_t range);
+
+    int32_t  *m_pX, *m_pY;              ///< Positions (16.16)
+    int32_t  *m_pVX, *m_pVY;            ///< Velocities per tick (16.16)
+    uint16_t *m_pLife;                  ///< Ticks left
+    uint16_t *m_pColor;
+    uint32_t  m_count;
+    uint32_t  m_capacity;
+
+    int32_t   m_ax, m_ay;
+    uint16_t  m_drag;
+    GFXrect   m_cull;
+    uint16_t  m_fade;
+    const uint8_t *m_pBrush;
+    uint8_t   m_brushW, m_brushH;
+    GFXrect   m_bounds;
+    uint32_t  m_rng;                    ///< xorshift32 state
+};
+
 // ===== MULTI-BUFFER SUPPORT (Software Renderer Only) ==========================
 
 /// Buffer index enumeration for easy reference
@@ -60,8 +513,50 @@ typedef struct {
     uint16_t *pData;      ///< Pointer to buffer data
     boolean   bOwned;     ///< Whether CircleGFX allocated this buffer
     boolean   bReady;     ///< Whether buffer is ready for display
+    uint32_t  nFrame;     ///< Frame number whose content it holds (0 = unknown)
 } FrameBuffer;
 
+/// Number of presented frames whose damage is remembered for buffer-age repair
+#define GFX_DAMAGE_HISTORY 4
+
+/// Edge length of the tiles hashed by CircleGFX::setTileDiffing()
+#define GFX_TILE_SIZE 32
+
+/// Area that changed on screen when a frame was presented
+typedef struct {
+    uint32_t  nFrame;     ///< Frame number (0 = unused slot)
+    GFXregion region;     ///< Changed area
+} FrameDamage;
+
+/// Animated change from the displayed buffer to the next one
+enum GFXtransition {
+    GFX_TRANSITION_NONE,
+    GFX_TRANSITION_SLIDE_LEFT,   ///< New screen slides in from the right, over the old one
+    GFX_TRANSITION_SLIDE_RIGHT,
+    GFX_TRANSITION_SLIDE_UP,
+    GFX_TRANSITION_SLIDE_DOWN,
+    GFX_TRANSITION_PUSH_LEFT,    ///< New screen pushes the old one out to the left
+    GFX_TRANSITION_PUSH_RIGHT,
+    GFX_TRANSITION_PUSH_UP,
+    GFX_TRANSITION_PUSH_DOWN,
+    GFX_TRANSITION_WIPE_LEFT,    ///< New screen is uncovered in place by an edge moving left
+    GFX_TRANSITION_WIPE_RIGHT,
+    GFX_TRANSITION_WIPE_UP,
+    GFX_TRANSITION_WIPE_DOWN,
+    GFX_TRANSITION_FADE,         ///< Fade out to a colour, then in to the new screen
+    GFX_TRANSITION_CROSSFADE     ///< Blend from the old screen to the new one
+};
+
+/// State of a running transition
+typedef struct {
+    uint8_t  type;        ///< GFXtransition
+    uint8_t  state;       ///< 0 idle, 1 armed for the next swap, 2 running
+    uint8_t  from, to;    ///< Buffer indices
+    uint16_t frames;      ///< Length in swapBuffers() calls
+    uint16_t frame;       ///< Current step
+    uint16_t color;       ///< Fade colour
+} Transition;
+
 /**
  * @class CircleGFX
  * @brief Adafruit GFX-compatible graphics library for Circle.
@@ -169,12 +664,89 @@ public:
     void setTextSize    (uint8_t s);
     void setTextSize    (uint8_t sx, uint8_t sy);
     void setTextWrap    (bool w);
+    /**
+     * @brief Paint the background colour behind GFXfont text, one cell of
+     *        advance × yAdvance per glyph (default off: GFXfont text is
+     *        transparent and the background colour is ignored, as in
+     *        Adafruit GFX).  The classic 5×8 font is always opaque.
+     */
+    void setTextOpaque  (boolean on);
     void drawChar       (int16_t x, int16_t y, unsigned char c,
                          uint16_t color, uint16_t bg, uint8_t size);
     void drawChar       (int16_t x, int16_t y, unsigned char c,
                          uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
+    /**
+     * @brief Write UTF-8 text at the cursor.  With a GFXfont, codepoints in
+     *        its colour-glyph range are drawn as inline icons.  Bytes that
+     *        are not valid UTF-8 are taken as Latin-1.
+     */
     void writeText      (const char *text);
+    /**
+     * @brief Select a GFXfont (nullptr = classic 5×8 font).  A font whose
+     *        glyphs all share exactly one xAdvance is detected as monospaced
+     *        and written through a fixed-cell path.  A nearly monospaced
+     *        font (hinting can round a few advances short) can be given a
+     *        pitch with setMonospace().
+     */
     void setFont        (const GFXfont *f = 0);
+    /**
+     * @brief Force a cell pitch for the current font (0 = back to what
+     *        setFont() detected).  writeText() advances every glyph by the
+     *        pitch in any direction and style.  Undecorated horizontal
+     *        writeText() also wraps by cell count, skips cells outside the
+     *        clip without looking at their glyphs and, for opaque text (see
+     *        setTextOpaque()), blits whole cells of yAdvance height.  Glyphs
+     *        are clipped to their cell there.
+     */
+    void    setMonospace(uint8_t advance);
+    uint8_t getMonospace() const { return m_monoAdvance; }
+    /**
+     * @brief Draw one glyph of the current GFXfont by codepoint (monochrome
+     *        or colour), baseline at y.
+     * @return Horizontal advance in pixels, 0 if the font lacks the glyph.
+     */
+    int16_t drawGlyph   (int16_t x, int16_t y, uint32_t code, uint16_t color,
+                         uint8_t size_x = 1, uint8_t size_y = 1);
+    /// Drop all cached glyph images (e.g. after changing font data in RAM).
+    void    flushGlyphCache();
+
+    /**
+     * @brief Set the direction writeText(), drawChar() and drawGlyph() draw
+     *        in.  Rotated glyphs are built once and cached, so any direction
+     *        draws as fast as normal text.  A newline moves one line "down"
+     *        relative to the glyphs and back to the screen edge the text
+     *        starts from.  SDF text is always horizontal.
+     */
+    void             setTextDirection(GFXtextDirection dir);
+    GFXtextDirection getTextDirection() const;
+
+    /**
+     * @brief Draw GFXfont text with an outline radius pixels wide (1..15)
+     *        in color.  The dilated mask is built once per glyph and cached
+     *        with it, so each glyph is still drawn in a single pass.  An
+     *        outline wider than the letter spacing overlaps the previous glyph.
+     */
+    void setTextOutline(uint16_t color, uint8_t radius = 1);
+    /**
+     * @brief Draw GFXfont text with a hard drop shadow offset by (dx, dy)
+     *        screen pixels (-8..7), cached like the outline.
+     */
+    void setTextShadow (uint16_t color, int8_t dx = 1, int8_t dy = 1);
+    /// Back to undecorated text.  Colour glyphs are never decorated.
+    void setTextPlain  ();
+
+    /**
+     * @brief Use a signed-distance-field font for writeText() (nullptr = off).
+     *        The text is drawn without background at sizePx pixels per
+     *        em (0 = the font's base size); setTextSize() does not apply.
+     */
+    void    setSdfFont  (const GFXsdfFont *f, uint16_t sizePx = 0);
+    /**
+     * @brief Draw one SDF glyph with anti-aliased edges, baseline at y.
+     * @return Horizontal advance in pixels at this size.
+     */
+    int16_t drawSdfChar (int16_t x, int16_t y, unsigned char c,
+                         uint16_t color, uint16_t sizePx);
 
     // ===== CONTROL API =======================================================
 
@@ -194,6 +766,155 @@ public:
     static uint16_t color565(uint8_t r, uint8_t g, uint8_t b);
     static uint16_t color565(uint32_t rgb);
 
+    // ===== DRAW TARGET API ===================================================
+
+    /**
+     * @brief Redirect all drawing to an off-screen canvas.
+     * @param pCanvas Canvas to draw into, or nullptr to draw to the screen again.
+     */
+    void setDrawTarget(GFXcanvas16 *pCanvas);
+
+    /**
+     * @brief Get the canvas currently bound as draw target.
+     * @return Bound canvas, or nullptr when drawing to the screen.
+     */
+    GFXcanvas16 *getDrawTarget() const;
+
+    /**
+     * @brief Describe the current draw target as a raw surface.
+     * @return Surface of the bound canvas or of the current draw buffer.
+     *         pData is nullptr when the target is not CPU-addressable
+     *         (the OpenGL ES frame buffer).
+     */
+    GFXsurface getDrawSurface() const;
+
+    // ===== CLIPPING API ======================================================
+
+    /**
+     * @brief Restrict all drawing and region effects to a rectangle of the
+     *        current draw target.  Reset by setDrawTarget() and clearClipRect().
+     */
+    void    setClipRect  (int16_t x, int16_t y, int16_t w, int16_t h);
+    void    clearClipRect(void);
+    GFXrect getClipRect  (void) const;
+
+    // ===== DAMAGE TRACKING API ===============================================
+    // When enabled, every primitive drawn to the screen buffer (not to a
+    // canvas) records the area it touched.
+
+    void             setDamageTracking(boolean enable);
+    boolean          isDamageTracking () const;
+    void             addDamage        (int16_t x, int16_t y, int16_t w, int16_t h);
+    /// Damage accumulated since the last clearDamage() / buffer swap.
+    const GFXregion &getDamage        (void);
+    void             clearDamage      (void);
+
+    // ===== REGION EFFECTS API ================================================
+    // Effects run on the CPU against the current draw target, so in OpenGL ES
+    // mode they only apply while a canvas is bound.
+
+    /**
+     * @brief Blur a region with running-sum box filters, O(pixels) for any radius.
+     * @param radius Box radius in pixels (window is 2*radius+1).
+     * @param passes Number of box passes (3 approximates a Gaussian).
+     */
+    void boxBlur     (int16_t x, int16_t y, int16_t w, int16_t h,
+                      uint8_t radius, uint8_t passes = 1);
+
+    /**
+     * @brief Approximate Gaussian blur (three box passes, sigma = radius / 2).
+     */
+    void gaussianBlur(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t radius);
+
+    /**
+     * @brief Draw the soft shadow of a rectangle.
+     *        The blurred edge profile is cached per (size, radius), so repeated
+     *        shadows of the same card only cost the blend.
+     * @param radius Blur radius of the shadow edge.
+     * @param alpha  Shadow opacity (0..255).
+     * @param color  Shadow colour (default black).
+     */
+    void drawShadow  (int16_t x, int16_t y, int16_t w, int16_t h,
+                      uint8_t radius, uint8_t alpha, uint16_t color = 0x0000);
+
+    // ===== BLIT API ==========================================================
+
+    /**
+     * @brief Combine a rectangle of an RGB565 surface into the draw target.
+     *        The per-row kernel is chosen once per call.  Source and
+     *        destination may overlap (e.g. scrolling within one surface).
+     * @param src     Source surface (a canvas, getDrawSurface(), getBuffer()...).
+     * @param srcRect Rectangle of src to copy.
+     * @param mode    Combine mode.
+     * @param param   Colour key for GFX_BLIT_COLORKEY, alpha (0..255) for
+     *                GFX_BLIT_ALPHA, ignored otherwise.
+     * @note In OpenGL ES mode without a bound canvas only GFX_BLIT_COPY is
+     *       available (uploaded as a texture).
+     */
+    void blit(const GFXsurface &src, const GFXrect &srcRect, int16_t dstX, int16_t dstY,
+              GFXblitMode mode = GFX_BLIT_COPY, uint16_t param = 0);
+
+    /// Blit a whole canvas.
+    void blit(const GFXcanvas16 &src, int16_t dstX, int16_t dstY,
+              GFXblitMode mode = GFX_BLIT_COPY, uint16_t param = 0);
+
+    /**
+     * @brief Expand an indexed canvas through its (animated) palette.
+     * @param pRegion Only expand these canvas rectangles, e.g.
+     *                canvas.getDamage(); nullptr for the whole canvas.
+     */
+    void drawCanvas8(int16_t x, int16_t y, const GFXcanvas8 &canvas,
+                     const GFXregion *pRegion = nullptr);
+
+    /**
+     * @brief Draw all particles into the draw target, one pixel or one
+     *        brush each, faded by their remaining life.  In OpenGL ES mode
+     *        (without a bound canvas) this is a single GL_POINTS draw, with
+     *        the brush as a square point sprite.
+     * @param mode  GFX_BLIT_ADD (saturating), GFX_BLIT_ALPHA or GFX_BLIT_COPY.
+     * @param alpha Overall opacity (0..255).
+     */
+    void drawParticles(const GFXParticles &particles, GFXblitMode mode = GFX_BLIT_ADD,
+                       uint8_t alpha = 255);
+
+    /**
+     * @brief Draw a GFXimage (e.g. from a GFXAssetPack) in any format,
+     *        decoding row by row into the draw target.
+     * @note  The colour key is honoured for CPU targets only.
+     */
+    void drawImage(int16_t x, int16_t y, const GFXimage &image);
+
+    // ===== COLOUR FILTER API ==================================================
+    // In-place filters on a region of the current draw target.  They honour
+    // the clip rectangle and report the filtered area as damage.
+
+    /**
+     * @brief Brightness / contrast around mid-grey.
+     * @param brightness Offset in 8-bit units (-255..255).
+     * @param contrast   Gain in 1/256 units (256 = unchanged, 0..1023).
+     */
+    void filterBrightnessContrast(int16_t x, int16_t y, int16_t w, int16_t h,
+                                  int16_t brightness, int16_t contrast = 256);
+    /// Move colours towards their luma by amount (255 = fully grey).
+    void filterDesaturate(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t amount = 255);
+    /// Blend towards a colour by alpha (0..255).
+    void filterTint      (int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, uint8_t alpha);
+    /// Invert all colour bits.
+    void filterInvert    (int16_t x, int16_t y, int16_t w, int16_t h);
+    /// Multiply each channel by the matching channel of color (0xFFFF = unchanged).
+    void filterMultiply  (int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    /**
+     * @brief Generic per-channel curves through lookup tables.
+     * @param curveR 32 entries, 5-bit output.
+     * @param curveG 64 entries, 6-bit output.
+     * @param curveB 32 entries, 5-bit output.
+     */
+    void filterCurves    (int16_t x, int16_t y, int16_t w, int16_t h,
+                          const uint8_t curveR[32], const uint8_t curveG[64],
+                          const uint8_t curveB[32]);
+    /// Same, with one 8-bit in/out curve applied to all channels.
+    void filterCurves    (int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t curve[256]);
+
     // ===== OPENGL ES SPECIFIC ================================================
 #ifdef GFX_USE_OPENGL_ES
     /// Call once per frame after all drawing is done to swap EGL buffers.
@@ -287,6 +1008,77 @@ public:
      */
     boolean detachExternalBuffer(uint8_t bufferIndex);
 
+    // ===== BUFFER AGE / PARTIAL REDRAW =======================================
+    // With damage tracking enabled, swapBuffers() only copies the frame's
+    // damage to the display and remembers it per frame.  A draw buffer that is
+    // reused without autoclear still holds an older frame: repaint its repair
+    // region between beginRepair() / endRepair(), then draw this frame's
+    // changes as usual.  Typical frame:
+    //
+    //     gfx.beginRepair();
+    //     redraw(gfx.getRepairRegion());   // bring the buffer up to date
+    //     gfx.endRepair();
+    //     drawChanges();                   // recorded as damage
+    //     gfx.swapBuffers(false);
+
+    /**
+     * @brief Age of the current draw buffer.
+     * @return Number of frames since its content was presented (1 = previous
+     *         frame, 2 = the one before ...), or 0 if its content is unknown.
+     */
+    uint8_t getBufferAge() const;
+
+    /**
+     * @brief Area of the current draw buffer that is out of date: the union of
+     *        everything presented since this buffer was last shown.  The whole
+     *        screen when the age is 0, autoclear was used, or the history is
+     *        too short.
+     */
+    const GFXregion &getRepairRegion() const;
+
+    /**
+     * @brief Bracket the repaint of the repair region.  Drawing in between is
+     *        not recorded as damage: those pixels already match the display,
+     *        and counting them would make the repair region grow every frame.
+     */
+    void beginRepair();
+    void endRepair();
+
+    /**
+     * @brief Hash each GFX_TILE_SIZE² tile of the frame being presented and
+     *        copy only tiles whose hash differs from the frame on screen.
+     *        Only tiles inside the frame's damage (all tiles without damage
+     *        tracking) are hashed; a frame with no changed tile is not copied
+     *        at all.  Uses the ARMv8 CRC32 instructions when available.
+     * @param enable Turn tile diffing on or off.
+     * @return false if the hash table could not be allocated.
+     */
+    boolean setTileDiffing(boolean enable);
+    boolean isTileDiffing() const;
+
+    // ===== TRANSITIONS ======================================================
+    // The screen on display and the next finished buffer are composed
+    // straight into the hardware framebuffer, one step per swapBuffers():
+    //
+    //     gfx.startTransition(GFX_TRANSITION_PUSH_LEFT, 20);
+    //     drawNextScreen();
+    //     for (int i = 0; i < 20; i++) gfx.swapBuffers(false);
+    //
+    // While it runs the old buffer is frozen and drawing goes to the new one
+    // (which may keep animating); no buffers rotate and autoclear is ignored.
+
+    /**
+     * @brief Arm a transition for the next swapBuffers().
+     * @param type   Kind of transition.
+     * @param frames Number of swapBuffers() calls it lasts; the last one
+     *               shows the new screen as usual.
+     * @param color  Colour passed through by GFX_TRANSITION_FADE.
+     * @return false without multi-buffering (needs two buffers).
+     */
+    boolean startTransition(GFXtransition type, uint16_t frames, uint16_t color = 0);
+    /// Stop a transition; the next swap presents the whole screen.
+    void    cancelTransition();
+    boolean isTransitionActive() const;
 #endif
 
 protected:
@@ -303,6 +1095,51 @@ protected:
     void drawFastVLineInternal(int16_t x, int16_t y, int16_t h, uint16_t color);
     void drawFastHLineInternal(int16_t x, int16_t y, int16_t w, uint16_t color);
 
+    // Draw target helpers
+    void _resetClip();
+    boolean _clipRegion(GFXrect &r, const GFXsurface &s) const;
+
+    // Damage helpers: primitives extend a pending box that endWrite() records
+    void _touch(int16_t x, int16_t y, int16_t w, int16_t h) {
+        if (!m_damageEnabled || m_pTarget || w <= 0 || h <= 0) return;
+        m_pending = m_pendingValid ? GFXrectUnion(m_pending, GFXrect{ x, y, w, h })
+                                   : GFXrect{ x, y, w, h };
+        m_pendingValid = true;
+    }
+    void _flushPending();
+
+    // Colour filter driver: clips, runs fn on every row, records damage
+    void _filterRegion(int16_t x, int16_t y, int16_t w, int16_t h,
+                       void (*fn)(uint16_t *row, int n, const void *pArgs),
+                       const void *pArgs);
+
+    // Region effect helpers
+    void          *_effectScratch(size_t bytes);
+    void           _blurSurface  (const GFXsurface &s, GFXrect r,
+                                  const uint8_t *radii, uint8_t passes);
+    const GFXshadowProfile *_shadowProfile(int16_t w, int16_t h, uint8_t radius);
+    void           _freeEffects  ();
+
+    // Glyph cache helpers
+    const GFXcachedGlyph *_cachedGlyph(const GFXfont *f, uint32_t code,
+                                       uint8_t size_x, uint8_t size_y, uint8_t dir = 0);
+    void           _drawCachedGlyph(const GFXcachedGlyph &g, int16_t x, int16_t y,
+                                    uint16_t color);
+    const GFXcachedGlyph *_styledGlyph(const GFXfont *f, uint32_t code,
+                                       uint8_t size_x, uint8_t size_y, uint8_t dir);
+    GFXcachedGlyph *_glyphSlot(const void *key, uint32_t code, uint32_t variant,
+                               boolean *pHit);
+    const GFXcachedGlyph *_cellGlyph(const GFXfont *f, uint32_t code,
+                                     uint8_t size_x, uint8_t size_y);
+    int16_t        _glyphAdvance (const GFXfont *f, uint32_t code) const;
+    void           _writeMono    (const char *text);
+    void           _fillTextCell (int16_t adv, int16_t lineH);
+
+    // Cursor movement in the current text direction
+    void           _advanceCursor(int16_t adv);
+    void           _newLine      (int16_t lineH);
+    boolean        _wrapNeeded   (int16_t adv) const;
+
     // ── Back-end specific members ────────────────────────────────────────────
 #ifdef GFX_USE_OPENGL_ES
     CEglRenderingContext *m_pGLContext;   ///< libgraphics OpenGL ES context
@@ -322,6 +1159,26 @@ protected:
     GLuint m_scratchTex;
     int16_t m_scratchW, m_scratchH;
 
+    // GLSL program for SDF glyphs (drawSdfChar)
+    GLuint m_shaderSdf;
+    GLuint m_uSdfMVP;       ///< uniform location
+    GLuint m_uSdfColor;     ///< uniform location
+    GLuint m_uSdfGain;      ///< uniform location
+    GLuint m_sdfTex;        ///< Texture the current glyph field is uploaded to
+
+    // GLSL program for particles (drawParticles), streamed as GL_POINTS
+    GLuint m_shaderPart;
+    GLuint m_uPartMVP;      ///< uniform location
+    GLuint m_uPartSize;     ///< uniform location
+    GLuint m_uPartBrush;    ///< uniform location
+    GLuint m_aPartColor;    ///< attribute location
+    GLuint m_vboPart;       ///< Streaming vertex buffer
+    GLuint m_partTex;       ///< Brush texture
+    const uint8_t *m_pPartBrush;  ///< Brush last uploaded to m_partTex
+    uint8_t  m_partBrushW, m_partBrushH;    ///< Its size
+    uint8_t *m_pPartVerts;  ///< Vertex staging (x, y floats + RGBA bytes)
+    uint32_t m_partVertsSize;
+
     // Private GL helpers
     GLuint  compileShader  (GLenum type, const char *src);
     GLuint  linkProgram    (GLuint vs, GLuint fs);
@@ -330,6 +1187,11 @@ protected:
                             float r, float g, float b, float a);
     void    uploadAndDrawTex(int16_t x, int16_t y, int16_t w, int16_t h,
                              const uint16_t *pixels);
+    void    drawGLSdf      (float x, float y, float w, float h,
+                            const uint8_t *field, int16_t fw, int16_t fh,
+                            uint16_t color, float gain);
+    void    drawGLParticles(const GFXParticles &particles, GFXblitMode mode, uint8_t alpha);
+    void    _glClip        (boolean on);
 
 #else
     CScreenDevice   *m_pScreen;
@@ -344,10 +1206,24 @@ protected:
     uint8_t     m_drawBufferIndex;      ///< Index of current drawing buffer
     uint8_t     m_displayBufferIndex;   ///< Index of currently displayed buffer
     boolean     m_multiBufferEnabled;   ///< Whether multi-buffering is active
+    uint32_t    m_frameCount;           ///< Number of the last presented frame
+    FrameDamage m_history[GFX_DAMAGE_HISTORY]; ///< Ring of presented-frame damage
+    GFXregion   m_repair;               ///< Out-of-date area of the draw buffer
+    boolean     m_presentAll;           ///< Next present must copy the whole screen
+    uint32_t   *m_pTileHash;            ///< Hash per tile of the frame on screen
+    uint16_t    m_tilesX, m_tilesY;     ///< Tile grid size
+    boolean     m_tileHashValid;        ///< Whether m_pTileHash matches the display
+    Transition  m_transition;           ///< Armed or running transition
 
     // Private multi-buffer helpers
     void _initializeMultiBuffer();
     void _cleanupMultiBuffer();
+    void _present(const GFXregion &region);
+    void _updateRepairRegion();
+    void _setFullScreen(GFXregion &region) const;
+    void _diffTiles(GFXregion &changed);
+    boolean _stepTransition();
+    void _composeTransition(uint16_t t);
 #endif
 
     // ── Common members ───────────────────────────────────────────────────────
@@ -358,12 +1234,995 @@ protected:
     uint16_t m_textColor, m_textBgColor;
     uint8_t  m_textSizeX, m_textSizeY;
     boolean  m_textWrap;
+    boolean  m_textOpaque;              ///< Paint GFXfont cell backgrounds
+    uint8_t  m_textDir;                 ///< GFXtextDirection
+    uint8_t  m_textStyle;               ///< GFXtextStyle
+    uint16_t m_textStyleColor;          ///< Outline / shadow colour
+    int8_t   m_textStyleA, m_textStyleB; ///< Outline radius, or shadow dx, dy
     uint8_t  m_rotation;
     boolean  m_inverted;
     boolean  m_inTransaction;
 
     const GFXfont *m_pFont;
     boolean        m_fontSizeMultiplied;
+    uint8_t        m_monoAdvance;       ///< Cell pitch, 0 = proportional font
+    uint8_t        m_monoDetected;      ///< Pitch found by setFont()
+    uint8_t        m_monoAscent;        ///< Cell top above the baseline
+    const GFXsdfFont *m_pSdfFont;       ///< Font used by writeText(), if set
+    uint16_t          m_sdfSize;        ///< Pixel size for m_pSdfFont
+
+    // ── Draw target / effects ────────────────────────────────────────────────
+    GFXcanvas16     *m_pTarget;         ///< Bound canvas, nullptr = screen
+    GFXrect          m_clip;            ///< Drawable area of the current target
+    GFXrect          m_userClip;        ///< Clip set by setClipRect()
+    boolean          m_userClipSet;     ///< Whether m_userClip applies
+    uint8_t         *m_pScratch;        ///< Grow-only scratch memory for effects
+    size_t           m_scratchSize;     ///< Size of m_pScratch in bytes
+    GFXshadowProfile m_shadowCache[GFX_SHADOW_CACHE_SIZE];
+    uint32_t         m_shadowTick;      ///< LRU clock for m_shadowCache
+    GFXcachedGlyph   m_glyphCache[GFX_GLYPH_CACHE_SETS][GFX_GLYPH_CACHE_WAYS];
+    uint32_t         m_glyphTick;       ///< LRU clock for m_glyphCache
+
+    // ── Damage tracking ──────────────────────────────────────────────────────
+    boolean          m_damageEnabled;   ///< Whether primitives record damage
+    GFXregion        m_damage;          ///< Damage of the frame being drawn
+    GFXrect          m_pending;         ///< Area touched since the last endWrite()
+    boolean          m_pendingValid;    ///< Whether m_pending holds an area
+    boolean          m_repairing;       ///< Inside beginRepair() / endRepair()
+};
+
+// ===== NUMERIC READOUT ========================================================
+
+/// Total digits of a GFXReadout (the value must fit an int32_t)
+#define GFX_READOUT_MAX_DIGITS 9
+/// Pre-rendered symbols: '0'..'9', '-', blank, '.'
+#define GFX_READOUT_SYMBOLS    13
+
+/**
+ * @class GFXReadout
+ * @brief Fixed-format number display: optional sign, integer digits,
+ *        decimal point, fraction digits and units, e.g. "-123.4 km/h".
+ *        Every symbol is rendered once into a tile, from a GFXfont or as
+ *        seven-segment digits.  draw() compares against what is on screen
+ *        and blits only the cells that changed, reporting one damage
+ *        rectangle per cell.
+ */
+class GFXReadout {
+public:
+    /**
+     * @param intDigits  Integer digits (1..9)
+     * @param fracDigits Digits after the decimal point (intDigits + fracDigits <= 9)
+     * @param bSigned    Reserve a cell for a minus sign
+     */
+    GFXReadout(uint8_t intDigits, uint8_t fracDigits = 0, boolean bSigned = false);
+    ~GFXReadout();
+
+    GFXReadout(const GFXReadout &) = delete;
+    GFXReadout &operator=(const GFXReadout &) = delete;
+
+    // ── Style (re-renders the tiles, returns false if out of memory) ─────────
+    /// Digits from a GFXfont scaled by size (nullptr = classic 5×8 font);
+    /// units use the same font.
+    boolean setFontStyle   (const GFXfont *f, uint8_t size, uint16_t color, uint16_t bg);
+    /// Seven-segment digits; unlit segments in off (= bg to hide them).
+    /// Units use the classic 5×8 font scaled to the digit height.
+    boolean setSegmentStyle(int16_t digitW, int16_t digitH, int16_t thickness,
+                            uint16_t on, uint16_t off, uint16_t bg);
+    /// Text after the number, ASCII, up to 15 characters
+    boolean setUnits       (const char *pUnits);
+    /// Show integer zeros in front of the first significant digit
+    void    setLeadingZeros(boolean on);
+    /// Top-left corner on screen
+    void    setPosition    (int16_t x, int16_t y);
+
+    // ── Value ────────────────────────────────────────────────────────────────
+    /// Value times 10^fracDigits (e.g. 1234 = "123.4"), clamped to the digits
+    void    setValue(int32_t value);
+    int32_t getValue() const { return m_value; }
+
+    // ── Output ───────────────────────────────────────────────────────────────
+    /// Redraw everything (the static parts included) on the next draw()
+    void    invalidate();
+    /**
+     * @brief Blit the cells whose symbol changed into the gfx draw target.
+     * @return Number of cells redrawn.
+     */
+    uint8_t draw(CircleGFX &gfx);
+    /// Rectangles redrawn by the last draw(), one per changed cell
+    const GFXregion &getDamage() const { return m_damage; }
+    GFXrect getBounds() const;
+
+private:
+    boolean _render ();
+    void    _symbols(uint8_t *pSym) const;
+
+    uint8_t   m_intDigits, m_fracDigits;
+    boolean   m_bSigned;
+    boolean   m_leadingZeros;
+    int16_t   m_x, m_y;
+    int32_t   m_value;
+    char      m_units[16];
+
+    // Style
+    boolean        m_segments;          ///< Seven-segment rather than font digits
+    const GFXfont *m_pFont;             ///< Font digits (nullptr = classic font)
+    uint8_t        m_size;              ///< Font scale
+    int16_t        m_segW, m_segH, m_segT; ///< Segment digit size and stroke
+    uint16_t       m_on, m_off, m_bg;   ///< Text / unlit segment / background colour
+
+    uint16_t *m_pTiles;                 ///< GFX_READOUT_SYMBOLS tiles side by side
+    uint16_t *m_pUnitTile;              ///< Rendered units, m_unitW wide
+    int16_t   m_tileW, m_tileH;         ///< Digit cell size
+    int16_t   m_pointW, m_unitW;        ///< Decimal point and units width
+    uint8_t   m_cells;                  ///< Sign + digit cells
+    int16_t   m_cellX[GFX_READOUT_MAX_DIGITS + 1];  ///< Cell offsets (sign first)
+    int16_t   m_pointX, m_unitX;        ///< Offsets of the static parts
+    uint8_t   m_shown[GFX_READOUT_MAX_DIGITS + 1];  ///< Symbols on screen, 0xFF = unknown
+    boolean   m_staticValid;            ///< Point and units on screen
+    GFXregion m_damage;
+};
+
+// ===== GAUGE ==================================================================
+
+/// Maximum number of coloured bands on a GFXGauge scale
+#define GFX_GAUGE_MAX_BANDS 4
+
+class GFXGauge;
+
+/// Extra face drawing, called by renderFace() with the face canvas bound
+typedef void (*GFXgaugePainter)(CircleGFX &gfx, const GFXGauge &gauge, void *pParam);
+
+/// Look of a GFXGauge face and needle
+typedef struct {
+    uint16_t bg;              ///< Corners outside the dial
+    uint16_t face;            ///< Dial
+    uint16_t rim;             ///< Rim, ticks and labels
+    uint16_t needle;          ///< Needle
+    uint16_t hub;             ///< Needle hub
+    uint8_t  majorTicks;      ///< Labelled intervals across the scale (0 = no ticks)
+    uint8_t  minorTicks;      ///< Minor intervals per major one
+    const GFXfont *pLabelFont; ///< Label font (nullptr = classic 5×8 font)
+    uint8_t  labelSize;       ///< Label scale (0 = no labels)
+} GFXgaugeStyle;
+
+/// Coloured arc along the scale
+typedef struct {
+    int32_t  from, to;        ///< Value range
+    uint16_t color;           ///< Band colour
+} GFXgaugeBand;
+
+/**
+ * @class GFXGauge
+ * @brief Dial gauge whose static face (dial, bands, ticks, labels) is
+ *        rendered once into a cached canvas.  Moving the needle restores
+ *        the old needle's bounding box from the cache and draws the new
+ *        anti-aliased needle, so the damage follows the needle, not the dial.
+ */
+class GFXGauge {
+public:
+    /// Dial centred on (cx, cy) with the given radius, in screen pixels
+    GFXGauge(int16_t cx, int16_t cy, int16_t radius);
+    ~GFXGauge();
+
+    GFXGauge(const GFXGauge &) = delete;
+    GFXGauge &operator=(const GFXGauge &) = delete;
+
+    // ── Face (changes apply at the next renderFace()) ────────────────────────
+    /// Map minValue..maxValue to startDeg..startDeg+sweepDeg, clockwise from 12 o'clock
+    void    setRange      (int32_t minValue, int32_t maxValue,
+                           int16_t startDeg = -135, int16_t sweepDeg = 270);
+    void    setStyle      (const GFXgaugeStyle &style);
+    /// Colour a value range of the scale (false if all bands are taken)
+    boolean addBand       (int32_t from, int32_t to, uint16_t color);
+    void    clearBands    ();
+    /// Needle length (<= radius) and width at the hub, in pixels
+    void    setNeedle     (int16_t length, uint8_t width);
+    void    setFacePainter(GFXgaugePainter pfn, void *pParam = nullptr);
+    /// Draw the face into its cache canvas (false if out of memory)
+    boolean renderFace    (CircleGFX &gfx);
+    GFXcanvas16 *getFace  () const { return m_pFace; }
+    /// Point at distance r from the centre towards value, in face coordinates
+    void    pointAt       (int32_t value, int16_t r, int16_t *pX, int16_t *pY) const;
+
+    // ── Value and output ─────────────────────────────────────────────────────
+    void    setValue  (int32_t value);
+    int32_t getValue  () const { return m_value; }
+    /// Blit the whole face again on the next draw()
+    void    invalidate();
+    /**
+     * @brief Bring the gauge on the gfx draw target up to date.  Does
+     *        nothing if the needle did not move.
+     */
+    void    draw      (CircleGFX &gfx);
+    /// Rectangles touched by the last draw()
+    const GFXregion &getDamage() const { return m_damage; }
+    GFXrect getBounds () const;
+
+private:
+    int32_t _angle     (int32_t value) const;
+    void    _point     (int32_t angle, int32_t r, int32_t *pX, int32_t *pY) const;
+    GFXrect _needleBox (int32_t angle) const;
+    void    _drawNeedle(CircleGFX &gfx, int32_t angle) const;
+
+    int16_t         m_cx, m_cy, m_radius;
+    int32_t         m_min, m_max;
+    int16_t         m_startDeg, m_sweepDeg;
+    GFXgaugeStyle   m_style;
+    GFXgaugeBand    m_bands[GFX_GAUGE_MAX_BANDS];
+    uint8_t         m_nBands;
+    int16_t         m_needleLen;
+    uint8_t         m_needleW;
+    GFXgaugePainter m_pfnPainter;
+    void           *m_pPainterParam;
+
+    GFXcanvas16    *m_pFace;            ///< Cached static face
+    int32_t         m_value;
+    int32_t         m_shownAngle;       ///< Needle on screen, 1/256 degree
+    boolean         m_faceShown;        ///< Face on screen since invalidate()
+    GFXregion       m_damage;
+};
+
+// ===== SPATIAL INDEX ==========================================================
+
+/// Default GFXSpatialGrid cell size: 1 << 5 = 32 pixels
+#define GFX_GRID_CELL_SHIFT 5
+
+/**
+ * @class GFXSpatialGrid
+ * @brief Uniform grid over screen rectangles for point and region queries.
+ *        Each item is listed in the cells its rectangle touches, so a query
+ *        only looks at the items near it, and moving an item within the same
+ *        cells costs nothing but the rectangle update.  Coordinates outside
+ *        the grid are clamped to its border cells.
+ */
+class GFXSpatialGrid {
+public:
+    GFXSpatialGrid(int16_t width, int16_t height, uint8_t cellShift = GFX_GRID_CELL_SHIFT);
+    ~GFXSpatialGrid();
+
+    GFXSpatialGrid(const GFXSpatialGrid &) = delete;
+    GFXSpatialGrid &operator=(const GFXSpatialGrid &) = delete;
+
+    /// Add an item; returns its id, or -1 if out of memory
+    int32_t        insert (void *pItem, const GFXrect &r);
+    void           update (int32_t id, const GFXrect &r);
+    void           remove (int32_t id);
+    void          *getItem(int32_t id) const { return m_pEntries[id].pItem; }
+    const GFXrect &getRect(int32_t id) const { return m_pEntries[id].rect; }
+    /// Number of items
+    uint32_t       count  () const { return m_count; }
+
+    /**
+     * @brief Items whose rectangle contains (x, y), or intersects r.
+     *        Each item is reported once, in no particular order.
+     * @return Number of items written to ppOut (at most maxOut).
+     */
+    uint16_t queryPoint(int16_t x, int16_t y, void **ppOut, uint16_t maxOut);
+    uint16_t queryRect (const GFXrect &r, void **ppOut, uint16_t maxOut);
+
+private:
+    typedef struct {
+        void    *pItem;                 ///< nullptr = free entry
+        GFXrect  rect;
+        int16_t  c0, r0, c1, r1;        ///< Cells covered (c1 < c0: none)
+        uint32_t stamp;                 ///< Last query that reported it
+        int32_t  nextFree;              ///< Free list link
+    } Entry;
+
+    typedef struct {
+        uint16_t count, capacity;
+        int32_t *pIds;
+    } Bucket;
+
+    void    _cells (const GFXrect &r, int16_t *pC0, int16_t *pR0, int16_t *pC1, int16_t *pR1) const;
+    void    _link  (int32_t id);
+    void    _unlink(int32_t id);
+
+    uint8_t  m_shift;
+    int16_t  m_cols, m_rows;
+    Bucket  *m_pBuckets;
+    Entry   *m_pEntries;
+    int32_t  m_capacity;                ///< Entries allocated
+    int32_t  m_used;                    ///< Entries ever handed out
+    int32_t  m_freeId;                  ///< Head of the free list, -1 = none
+    uint32_t m_count;
+    uint32_t m_stamp;
+};
+
+// ===== RETAINED WIDGETS =======================================================
+// Widgets keep their place on screen between frames; only areas that were
+// invalidated are repainted.  Typical frame, with damage tracking on:
+//
+//     label.setText("42");            // calls invalidate()
+//     tree.render();                  // repaints just that label
+//     gfx.swapBuffers(false);         // presents just that area
+
+class GFXWidgetTree;
+
+/**
+ * @class GFXWidget
+ * @brief Rectangle of the retained UI.  Subclasses implement paint().
+ *        Bounds are absolute screen coordinates; children are painted
+ *        after (above) their parent and clipped to it.  Among siblings,
+ *        higher z is painted later.
+ */
+class GFXWidget {
+public:
+    GFXWidget(int16_t x, int16_t y, int16_t w, int16_t h, boolean bOpaque = false);
+    /// Detaches the widget (its children become orphans, they are not deleted)
+    virtual ~GFXWidget();
+
+    GFXWidget(const GFXWidget &) = delete;
+    GFXWidget &operator=(const GFXWidget &) = delete;
+
+    /**
+     * @brief Draw the widget.  The clip rectangle is already set to the part
+     *        that needs repainting (see gfx.getClipRect()); an opaque widget
+     *        must cover every pixel of it.
+     */
+    virtual void paint(CircleGFX &gfx) = 0;
+
+    // ── Hierarchy ────────────────────────────────────────────────────────────
+    void       addChild   (GFXWidget *pChild);
+    void       removeChild(GFXWidget *pChild);
+    GFXWidget *getParent  () const { return m_pParent; }
+
+    // ── Geometry and state (each change invalidates what it affects) ────────
+    void           setBounds (int16_t x, int16_t y, int16_t w, int16_t h);
+    void           moveTo    (int16_t x, int16_t y);
+    const GFXrect &getBounds () const { return m_bounds; }
+    void           setZ      (int16_t z);
+    int16_t        getZ      () const { return m_z; }
+    void           setOpaque (boolean bOpaque);
+    boolean        isOpaque  () const { return m_bOpaque; }
+    void           setVisible(boolean bVisible);
+    boolean        isVisible () const { return m_bVisible; }
+    /// Bounds clipped by all ancestors (w = 0 if hidden or detached)
+    GFXrect        getVisibleBounds() const;
+
+    /// Mark the whole widget, or part of it (screen coordinates), for repaint
+    void invalidate();
+    void invalidate(const GFXrect &r);
+
+private:
+    friend class GFXWidgetTree;
+
+    void _link    (GFXWidget **ppFirst);
+    void _unlink  (GFXWidget **ppFirst);
+    void _setTree (GFXWidgetTree *pTree);
+
+    GFXrect        m_bounds;
+    int16_t        m_z;
+    boolean        m_bOpaque;
+    boolean        m_bVisible;
+    GFXWidget     *m_pParent;
+    GFXWidget     *m_pFirstChild;       ///< Children, ascending z
+    GFXWidget     *m_pNext;             ///< Next sibling
+    GFXWidgetTree *m_pTree;             ///< Tree the widget is attached to
+    int32_t        m_gridId;            ///< Entry in the tree's spatial index
+    uint32_t       m_order;             ///< Paint order within the tree
+};
+
+/**
+ * @class GFXWidgetTree
+ * @brief Top-level widgets of one screen and the region that needs
+ *        repainting.  render() repaints each invalid rectangle bottom to
+ *        top, clipped to it, skipping widgets hidden behind opaque ones.
+ *        All attached widgets are kept in a GFXSpatialGrid, so finding the
+ *        widgets under a touch or an invalid rectangle does not scale with
+ *        the number of widgets.
+ */
+class GFXWidgetTree {
+public:
+    explicit GFXWidgetTree(CircleGFX *pGFX);
+    /// Detaches all widgets (they are not deleted)
+    ~GFXWidgetTree();
+
+    GFXWidgetTree(const GFXWidgetTree &) = delete;
+    GFXWidgetTree &operator=(const GFXWidgetTree &) = delete;
+
+    void add   (GFXWidget *pWidget);
+    void remove(GFXWidget *pWidget);
+
+    /// Colour of areas no opaque widget covers
+    void setBackground(uint16_t color);
+
+    void             invalidate   (const GFXrect &r);
+    void             invalidateAll();
+    const GFXregion &getInvalid   () const { return m_invalid; }
+
+    /// Topmost visible widget at (x, y), or nullptr
+    GFXWidget *hitTest (int16_t x, int16_t y);
+    /**
+     * @brief Visible widgets reaching into r, in paint order.
+     * @return Number written to ppOut (at most maxOut).
+     */
+    uint16_t   findWidgets(const GFXrect &r, GFXWidget **ppOut, uint16_t maxOut);
+
+    /**
+     * @brief Repaint the invalid region.  With multi-buffering and damage
+     *        tracking, the draw buffer's repair region is brought up to date
+     *        first (between beginRepair() / endRepair()).  Call once per
+     *        frame, before swapBuffers(false).  Leaves the clip cleared.
+     * @return true if anything was painted.
+     */
+    boolean render();
+
+private:
+    friend class GFXWidget;
+
+    void     _paintRect(const GFXrect &r);
+    uint16_t _collect  (const GFXrect &r);
+    boolean  _reserve  (uint32_t n);
+    void     _renumber ();
+    uint32_t _number   (GFXWidget *pFirst, uint32_t order);
+
+    CircleGFX  *m_pGFX;
+    GFXWidget  *m_pFirst;               ///< Top-level widgets, ascending z
+    GFXSpatialGrid m_grid;              ///< Bounds of all attached widgets
+    boolean     m_orderDirty;           ///< Paint order needs renumbering
+    GFXregion   m_invalid;
+    uint16_t    m_bg;
+    GFXWidget **m_ppPaint;              ///< Paint list scratch
+    GFXrect    *m_pVisible;             ///< Visible part per paint list entry
+    uint16_t    m_paintSize;            ///< Capacity of the scratch lists
+};
+
+// ===== ANIMATION ==============================================================
+// Tweens move a value from where it is to a target over a fixed time.  Each
+// tick() writes the new values and reports where the screen changed:
+//
+//     anim.tweenMove(&button, 200, 40, 300, GFX_EASE_OUT_BACK);
+//     while (anim.isActive()) {
+//         if (anim.tick(nowMs)) tree.render();      // widgets invalidated
+//         gfx.swapBuffers(false);
+//     }
+//
+// Values that are not widget bounds are bound to a widget (invalidated when
+// they change) or to a screen area (added to getDamage()); GFXrect tweens
+// report their old and new rectangles.  Once the last tween finishes,
+// isActive() turns false and tick() stops reporting changes.
+
+/// Maximum number of tweens running in one GFXAnimator
+#define GFX_MAX_TWEENS 32
+/// setRepeat() count that never runs out
+#define GFX_TWEEN_FOREVER 0xFFFF
+
+/// Easing curves, evaluated in 16.16 fixed point
+enum GFXease {
+    GFX_EASE_LINEAR,
+    GFX_EASE_IN_QUAD,
+    GFX_EASE_OUT_QUAD,
+    GFX_EASE_IN_OUT_QUAD,
+    GFX_EASE_IN_CUBIC,
+    GFX_EASE_OUT_CUBIC,
+    GFX_EASE_IN_OUT_CUBIC,
+    GFX_EASE_SMOOTH,      ///< Smoothstep
+    GFX_EASE_OUT_BACK,    ///< Overshoots by ~10 % and settles
+    GFX_EASE_OUT_BOUNCE   ///< Bounces off the target
+};
+
+/// Kind of value a tween writes
+enum GFXtweenType {
+    GFX_TWEEN_NONE,       ///< Slot unused
+    GFX_TWEEN_INT16,
+    GFX_TWEEN_UINT8,      ///< e.g. an opacity
+    GFX_TWEEN_COLOR,      ///< RGB565, interpolated per channel
+    GFX_TWEEN_RECT,       ///< GFXrect, all four fields
+    GFX_TWEEN_WIDGET      ///< Widget bounds, through setBounds()
+};
+
+class GFXWidget;
+
+/// Called when a tween finishes (not when it is stopped)
+typedef void (*GFXtweenDone)(int8_t id, void *pParam);
+
+/// One running tween
+typedef struct {
+    uint8_t      type;        ///< GFXtweenType
+    uint8_t      ease;        ///< GFXease
+    boolean      bYoyo;       ///< Alternate direction on each repeat
+    uint8_t      state;       ///< 0 = added, 1 = delayed, 2 = running
+    uint16_t     durationMs;
+    uint16_t     delayMs;     ///< Wait after the first tick before moving
+    uint16_t     repeat;      ///< Runs left after this one
+    void        *pTarget;     ///< Value written (a GFXWidget for widget tweens)
+    GFXWidget   *pWidget;     ///< Invalidated when the value changes
+    GFXrect      area;        ///< Damage when the value changes (w = 0: none)
+    int16_t      from[4];
+    int16_t      to[4];
+    uint32_t     startMs;
+    GFXtweenDone pDone;
+    void        *pParam;
+} GFXtween;
+
+/**
+ * @class GFXAnimator
+ * @brief Fixed set of tweens advanced by tick(nowMs).  Tweens start from
+ *        the value their target holds at the first tick after they are
+ *        added, so delayed tweens chain naturally; a new tween on a target
+ *        that is already animating replaces the old one.  Targets must
+ *        outlive their tweens (see stopTarget()).
+ */
+class GFXAnimator {
+public:
+    GFXAnimator();
+
+    // ── Starting tweens ──────────────────────────────────────────────────────
+    /// @return Tween id, or -1 if all GFX_MAX_TWEENS slots are taken.
+    int8_t tweenInt   (int16_t *pValue, int16_t to, uint16_t durationMs,
+                       GFXease ease = GFX_EASE_OUT_QUAD);
+    int8_t tweenAlpha (uint8_t *pValue, uint8_t to, uint16_t durationMs,
+                       GFXease ease = GFX_EASE_LINEAR);
+    int8_t tweenColor (uint16_t *pColor, uint16_t to, uint16_t durationMs,
+                       GFXease ease = GFX_EASE_LINEAR);
+    int8_t tweenRect  (GFXrect *pRect, const GFXrect &to, uint16_t durationMs,
+                       GFXease ease = GFX_EASE_OUT_QUAD);
+    int8_t tweenBounds(GFXWidget *pWidget, const GFXrect &to, uint16_t durationMs,
+                       GFXease ease = GFX_EASE_OUT_QUAD);
+    /// Move a widget, keeping its size
+    int8_t tweenMove  (GFXWidget *pWidget, int16_t x, int16_t y, uint16_t durationMs,
+                       GFXease ease = GFX_EASE_OUT_QUAD);
+
+    // ── Options (call right after starting) ──────────────────────────────────
+    /// Repaint this widget whenever the value changes
+    void bind     (int8_t id, GFXWidget *pWidget);
+    /// Report this screen area as damage whenever the value changes
+    void bind     (int8_t id, const GFXrect &area);
+    void setDelay (int8_t id, uint16_t delayMs);
+    /// Run count more times after the first (GFX_TWEEN_FOREVER = endless)
+    void setRepeat(int8_t id, uint16_t count, boolean bYoyo = false);
+    void onDone   (int8_t id, GFXtweenDone pDone, void *pParam = nullptr);
+
+    // ── Control ──────────────────────────────────────────────────────────────
+    /// Stop a tween, leaving its value where it is or jumping to the end
+    void    stop     (int8_t id, boolean bFinish = false);
+    /// Stop whatever animates this value or widget
+    void    stopTarget(const void *pTarget, boolean bFinish = false);
+    void    stopAll  ();
+    boolean isRunning(int8_t id) const;
+    /// true while any tween is running or waiting for its delay
+    boolean isActive () const { return m_active != 0; }
+
+    /**
+     * @brief Advance all tweens to the given time (e.g. CTimer ticks / 1000)
+     *        and write their values.  Finished tweens are removed.
+     * @return true if any value changed.
+     */
+    boolean tick(uint32_t nowMs);
+
+    /// Screen areas changed through bound areas and GFXrect tweens
+    const GFXregion &getDamage  () const { return m_damage; }
+    void             clearDamage()       { m_damage.clear(); }
+
+    /// Eased progress for t in 0..65536, in 16.16 (may leave 0..65536)
+    static int32_t ease(GFXease curve, int32_t t);
+
+private:
+    int8_t  _start(GFXtweenType type, void *pTarget, uint16_t durationMs, GFXease ease);
+    void    _read (GFXtween &tw);
+    boolean _write(GFXtween &tw, int32_t e);
+    void    _free (int8_t id);
+
+    GFXtween  m_tweens[GFX_MAX_TWEENS];
+    uint8_t   m_active;                 ///< Slots in use
+    GFXregion m_damage;
+};
+
+// ===== SPRITE ENGINE ==========================================================
+// Sprites over a scrolling background, composed one scanline at a time like
+// the sprite hardware of old consoles: each changed line is built in a line
+// buffer (background, then the sprites crossing it, back to front) and
+// written to the draw target once, however many sprites overlap there.
+//
+//     GFXSpriteEngine eng(0, 0, 320, 240, 200);
+//     eng.setTilemap(tiles, 16, 16, map, 64, 64);
+//     eng.setSprite(0, sheet, GFXrect{ 0, 0, 16, 16 }, 0xF81F);
+//     for (;;) {
+//         eng.moveSprite(0, x, y);
+//         eng.draw(gfx);                  // only the areas that changed
+//         gfx.swapBuffers(false);
+//     }
+
+/// Sprite flags
+#define GFX_SPRITE_VISIBLE  0x01
+#define GFX_SPRITE_FLIP_X   0x02
+#define GFX_SPRITE_FLIP_Y   0x04
+#define GFX_SPRITE_OPAQUE   0x08   ///< No colour key: rows are copied whole
+
+/// Map entry drawn in the background colour
+#define GFX_SPRITE_NO_TILE  0xFFFF
+
+/// One sprite: a frame of a sheet, placed in engine coordinates
+typedef struct {
+    GFXsurface sheet;      ///< Image the frames are cut from
+    GFXrect    frame;      ///< Current frame within the sheet
+    int16_t    x, y;       ///< Top-left, relative to the engine viewport
+    int16_t    z;          ///< Priority: higher is drawn on top
+    uint16_t   key;        ///< Transparent colour
+    uint8_t    flags;      ///< GFX_SPRITE_*
+    boolean    bDirty;     ///< Changed since the last draw()
+    GFXrect    drawn;      ///< Screen area it covered when last drawn
+} GFXsprite;
+
+/**
+ * @class GFXSpriteEngine
+ * @brief Fixed number of sprites over a solid, image or tilemap background,
+ *        in a viewport of the screen.  draw() recomposes only the areas that
+ *        changed (old and new sprite bounds, scrolled or invalidated
+ *        background), building per-scanline sprite lists once per frame.
+ *        Images and maps are referenced, not copied.
+ */
+class GFXSpriteEngine {
+public:
+    /// Viewport x, y, w, h on screen; check getMaxSprites() for allocation
+    GFXSpriteEngine(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t maxSprites);
+    ~GFXSpriteEngine();
+
+    GFXSpriteEngine(const GFXSpriteEngine &) = delete;
+    GFXSpriteEngine &operator=(const GFXSpriteEngine &) = delete;
+
+    // ── Background ───────────────────────────────────────────────────────────
+    void setBackgroundColor(uint16_t color);
+    /// Repeat an image (e.g. a cached canvas) in both directions
+    void setBackground     (const GFXsurface &image);
+    /**
+     * @brief Repeat a map of tiles in both directions.
+     * @param tiles  Sheet of tileW×tileH tiles, numbered row by row.
+     * @param pMap   mapW×mapH tile numbers; GFX_SPRITE_NO_TILE (or a number
+     *               past the sheet) shows the background colour.
+     */
+    void setTilemap        (const GFXsurface &tiles, int16_t tileW, int16_t tileH,
+                            const uint16_t *pMap, int16_t mapW, int16_t mapH);
+    /// Background position shown at the viewport's top-left corner
+    void setScroll         (int16_t sx, int16_t sy);
+    /// Background (or map) contents changed; r is in viewport coordinates
+    void invalidate        ();
+    void invalidate        (const GFXrect &r);
+
+    // ── Sprites ──────────────────────────────────────────────────────────────
+    void setSprite  (uint16_t id, const GFXsurface &sheet, const GFXrect &frame,
+                     uint16_t key, uint8_t flags = GFX_SPRITE_VISIBLE);
+    /// Switch to another frame of the same sheet
+    void setFrame   (uint16_t id, const GFXrect &frame);
+    void moveSprite (uint16_t id, int16_t x, int16_t y);
+    void setPriority(uint16_t id, int16_t z);
+    void setFlags   (uint16_t id, uint8_t flags);
+    const GFXsprite &getSprite(uint16_t id) const { return m_pSprites[id]; }
+    uint16_t getMaxSprites() const { return m_maxSprites; }
+
+    // ── Output ───────────────────────────────────────────────────────────────
+    /**
+     * @brief Recompose the changed areas into the gfx draw target, within
+     *        its clip rectangle.  With multi-buffering and damage tracking,
+     *        the draw buffer's repair region is recomposed first.
+     * @return true if anything was drawn.
+     */
+    boolean draw(CircleGFX &gfx);
+    /// Screen rectangles composed by the last draw()
+    const GFXregion &getDamage() const { return m_damage; }
+    GFXrect getBounds() const { return m_view; }
+
+private:
+    enum { BG_COLOR, BG_IMAGE, BG_TILES };
+
+    GFXrect _screenRect(const GFXsprite &s) const;
+    boolean _buildLines();
+    void    _background(uint16_t *pLine, int16_t x, int16_t y, int16_t w) const;
+    void    _sprites   (uint16_t *pLine, int16_t x, int16_t y, int16_t w) const;
+    void    _compose   (CircleGFX &gfx, const GFXrect &r);
+
+    GFXrect         m_view;
+    uint8_t         m_bgMode;
+    uint16_t        m_bgColor;
+    GFXsurface      m_bgImage;          ///< Image, or the tile sheet
+    int16_t         m_tileW, m_tileH;
+    const uint16_t *m_pMap;
+    int16_t         m_mapW, m_mapH;
+    int16_t         m_scrollX, m_scrollY;
+
+    GFXsprite      *m_pSprites;
+    uint16_t        m_maxSprites;
+    uint16_t       *m_pOrder;           ///< Sprite ids by ascending z
+    boolean         m_orderDirty;
+
+    uint32_t       *m_pLineStart;       ///< Per viewport line: first entry
+    uint16_t       *m_pLineIds;         ///< Sprites crossing each line, back to front
+    uint32_t        m_lineIdsSize;
+    uint16_t       *m_pLine;            ///< Line buffer
+    uint16_t       *m_pStage;           ///< Whole-rectangle buffer when the
+    uint32_t        m_stageSize;        ///< target is not CPU-addressable
+
+    GFXregion       m_invalid;          ///< Screen areas to recompose
+    GFXregion       m_damage;
+};
+
+// ===== COLLISION ==============================================================
+// Pixel-exact overlap tests between 1-bit masks in the drawRGBBitmap() format
+// (MSB first, rows padded to whole bytes).  Rows are compared 32 pixels at
+// a time, after a bounding-box test; GFXcollideGrid() first narrows the
+// candidates down with a GFXSpatialGrid.
+
+/// A masked object at a screen position
+typedef struct {
+    const uint8_t *pMask;   ///< 1-bit rows; nullptr = solid rectangle
+    int32_t        stride;  ///< Bytes per row, (w + 7) / 8 for drawRGBBitmap() masks
+    int16_t        x, y;    ///< Top-left corner
+    int16_t        w, h;    ///< Size in pixels
+} GFXcollider;
+
+/**
+ * @brief Test two colliders for overlapping set pixels.
+ * @param pHit If given, receives the bounding box of all overlapping pixels
+ *             (w = 0 if none); without it the test stops at the first one.
+ */
+boolean  GFXcollide      (const GFXcollider &a, const GFXcollider &b, GFXrect *pHit = nullptr);
+
+/**
+ * @brief Colliders in grid (items must be GFXcollider pointers, inserted
+ *        with their bounds) that overlap a; a itself is skipped.
+ * @param ppHits Receives the hits; it also holds the grid candidates while
+ *               testing, so size it for everything near a.
+ * @return Number of hits.
+ */
+uint16_t GFXcollideGrid  (const GFXcollider &a, GFXSpatialGrid &grid,
+                          GFXcollider **ppHits, uint16_t maxHits);
+
+/**
+ * @brief Build a collision mask from the non-key pixels of an image, e.g. a
+ *        GFXSpriteEngine frame.  pMask needs stride * r.h bytes.
+ */
+void     GFXmaskFromKey  (const GFXsurface &src, const GFXrect &r, uint16_t key,
+                          uint8_t *pMask, int32_t stride);
+
+// ===== ASSET PACK =============================================================
+// Fonts, images, palettes and sprite atlases in one file, built on the host
+// by helper/gfxpack.py.  The file is read into memory in one go (or mmap()ed
+// on a host build) and used in place: fonts and images come back as views
+// into the pack, nothing is copied or allocated.
+//
+//     GFXAssetPack pack;
+//     pack.open(pBuffer, nSize);                  // bytes read from disk
+//     static GFXfont font;                        // must outlive its use
+//     if (pack.getFont("B612-10", &font)) gfx.setFont(&font);
+//
+// The glyph cache is keyed by the glyph data in the pack, not by the
+// GFXfont, so one struct can be refilled with another font.  Reading a
+// different pack into the same buffer needs CircleGFX::flushGlyphCache().
+//
+// Layout (little-endian): a 16-byte header holding the entry count, the
+// offset of the table of contents and the file size; the asset sections,
+// each aligned to GFX_PACK_ALIGN bytes; then the table of contents at the
+// end, sorted by name hash.
+
+#define GFX_PACK_MAGIC    0x50584647u   ///< "GFXP"
+#define GFX_PACK_VERSION  1
+#define GFX_PACK_ALIGN    16
+
+/// Kinds of asset in a pack
+enum GFXassetType {
+    GFX_ASSET_FONT     = 1,   ///< GFXfont
+    GFX_ASSET_SDF_FONT = 2,   ///< GFXsdfFont
+    GFX_ASSET_IMAGE    = 3,   ///< GFXimage
+    GFX_ASSET_PALETTE  = 4,   ///< RGB565 colours
+    GFX_ASSET_ATLAS    = 5,   ///< Named frames of an image
+    GFX_ASSET_BLOB     = 6    ///< Raw bytes
+};
+
+/// Table of contents entry
+typedef struct {
+    uint32_t hash;            ///< GFXAssetPack::hash() of the name
+    uint16_t type;            ///< GFXassetType
+    uint16_t reserved;
+    uint32_t offset;          ///< From the start of the pack
+    uint32_t size;            ///< Bytes
+} GFXassetEntry;
+
+/// Named frame of an atlas
+typedef struct {
+    uint32_t hash;                ///< GFXAssetPack::hash() of the frame name
+    int16_t  x, y, w, h;          ///< Rectangle in the atlas image
+    int16_t  pivotX, pivotY;      ///< Anchor point, relative to the frame
+} GFXatlasFrame;
+
+/// View of an atlas: frames sorted by hash, cut from one image
+typedef struct {
+    GFXimage             image;
+    const GFXatlasFrame *pFrames;
+    uint16_t             count;
+} GFXatlas;
+
+/**
+ * @class GFXAssetPack
+ * @brief Read-only index over a pack in memory.  The memory must stay valid
+ *        and be 4-byte aligned (GFX_PACK_ALIGN for best results); views
+ *        handed out point into it.
+ */
+class GFXAssetPack {
+public:
+    GFXAssetPack();
+
+    /// Validate the header and table of contents
+    boolean  open   (const void *pData, uint32_t size);
+    void     close  ();
+    boolean  isOpen () const { return m_pData != nullptr; }
+    uint16_t count  () const { return m_count; }
+    const GFXassetEntry *getEntry(uint16_t i) const { return i < m_count ? &m_pToc[i] : nullptr; }
+
+    /// 32-bit FNV-1a of a name, as used by the table of contents
+    static uint32_t hash(const char *pName);
+
+    /// Binary search by name hash; nullptr if missing
+    const GFXassetEntry *find(uint32_t hash, GFXassetType type) const;
+    const GFXassetEntry *find(const char *pName, GFXassetType type) const {
+        return find(hash(pName), type);
+    }
+
+    // ── Typed views (false / nullptr if missing or malformed) ────────────────
+    /// The GFXfont is filled in; it must outlive its use with setFont()
+    boolean     getFont   (const char *pName, GFXfont *pFont) const;
+    boolean     getSdfFont(const char *pName, GFXsdfFont *pFont) const;
+    boolean     getImage  (const char *pName, GFXimage *pImage) const;
+    boolean     getImage  (uint32_t hash, GFXimage *pImage) const;
+    boolean     getPalette(const char *pName, const uint16_t **ppColors, uint16_t *pCount) const;
+    boolean     getAtlas  (const char *pName, GFXatlas *pAtlas) const;
+    const void *getBlob   (const char *pName, uint32_t *pSize) const;
+
+    static const GFXatlasFrame *findFrame(const GFXatlas &atlas, const char *pName);
+
+private:
+    const uint8_t *_section(const GFXassetEntry *pEntry, uint32_t minSize) const;
+
+    const uint8_t       *m_pData;
+    uint32_t             m_size;
+    const GFXassetEntry *m_pToc;
+    uint16_t             m_count;
+};
+
+// ===== MONOCHROME / E-PAPER ===================================================
+// 1-bit drawing for SSD1306-class OLEDs and e-paper panels.  GFXcanvas1 keeps
+// a packed buffer (a GFXbitSurface) and draws on the bits directly; flush()
+// sends the damaged windows to a GFXDisplaySink in the layout the panel takes.
+
+/// Pixel values of a GFXcanvas1
+#define GFX_MONO_BLACK   0    ///< Bit clear
+#define GFX_MONO_WHITE   1    ///< Bit set (lit OLED pixel)
+#define GFX_MONO_INVERSE 2    ///< Bit flipped
+
+/// How colour images are reduced to 1 bit
+enum GFXdither {
+    GFX_DITHER_NONE,          ///< Threshold at 50% grey
+    GFX_DITHER_ORDERED,       ///< 8×8 Bayer matrix in canvas coordinates (stable under partial redraws)
+    GFX_DITHER_FS             ///< Floyd–Steinberg error diffusion
+};
+
+/// Byte layout a display sink takes
+enum GFXsinkLayout {
+    GFX_SINK_ROWS,            ///< Rows of bytes, MSB = leftmost pixel (e-paper)
+    GFX_SINK_PAGES            ///< Pages of 8 rows, one byte per column, LSB = top row (SSD1306)
+};
+
+/**
+ * @class GFXDisplaySink
+ * @brief Receives finished 1-bit windows for a panel; implementations wrap
+ *        the SPI / I2C transfer and the refresh command.
+ */
+class GFXDisplaySink {
+public:
+    virtual ~GFXDisplaySink() {}
+
+    virtual GFXsinkLayout getLayout    () const { return GFX_SINK_ROWS; }
+    /// Window alignment in pixels (power of two; at least 8 across rows / down pages)
+    virtual uint8_t       getAlignX    () const { return 8; }
+    virtual uint8_t       getAlignY    () const { return 8; }
+    /// Most windows per flush; more damage is sent as one bounding window
+    virtual uint8_t       getMaxWindows() const { return 1; }
+
+    /**
+     * @brief Send one window.  pData holds its rows (GFX_SINK_ROWS) or its
+     *        pages (GFX_SINK_PAGES), stride bytes apart.  x and y are
+     *        aligned; w and h too, except where the window meets the right or
+     *        bottom edge.
+     */
+    virtual void write  (const GFXrect &window, const uint8_t *pData, int32_t stride) = 0;
+    /// Called once after the windows of a flush; e-paper panels start their (partial) refresh here
+    virtual void refresh(const GFXrect &bounds, boolean bFull) { (void)bounds; (void)bFull; }
+};
+
+/**
+ * @class GFXcanvas1
+ * @brief Packed 1-bit canvas, MSB-first rows padded to 32-bit words.  Spans
+ *        are masked edge bytes around whole-word fills, text and bitmaps are
+ *        written from shifted bit windows without expanding to pixels, and
+ *        colour images are dithered on the way in.  Drawing records damage
+ *        for partial refresh.
+ */
+class GFXcanvas1 {
+public:
+    GFXcanvas1(int16_t w, int16_t h);
+    ~GFXcanvas1();
+
+    GFXcanvas1(const GFXcanvas1 &) = delete;
+    GFXcanvas1 &operator=(const GFXcanvas1 &) = delete;
+
+    uint8_t      *getBuffer () const { return m_pData; }
+    int16_t       width     () const { return m_width; }
+    int16_t       height    () const { return m_height; }
+    int32_t       getStride () const { return m_stride; }
+    GFXbitSurface getSurface() const;
+
+    // ── Drawing (GFX_MONO_*) ─────────────────────────────────────────────────
+    void    drawPixel    (int16_t x, int16_t y, uint8_t color);
+    boolean getPixel     (int16_t x, int16_t y) const;
+    void    drawFastHLine(int16_t x, int16_t y, int16_t w, uint8_t color);
+    void    drawFastVLine(int16_t x, int16_t y, int16_t h, uint8_t color);
+    void    fillRect     (int16_t x, int16_t y, int16_t w, int16_t h, uint8_t color);
+    void    fillScreen   (uint8_t color);
+    void    drawLine     (int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t color);
+    void    drawRect     (int16_t x, int16_t y, int16_t w, int16_t h, uint8_t color);
+    /// 1-bit bitmap (MSB first, rows padded to bytes); set bits are drawn in color
+    void    drawBitmap   (int16_t x, int16_t y, const uint8_t *pBits, int16_t w, int16_t h, uint8_t color);
+    /// Raster-op copy from another 1-bit surface (see GFXblitBits())
+    void    blit         (const GFXbitSurface &src, const GFXrect &srcRect, int16_t x, int16_t y,
+                          GFXblitMode mode = GFX_BLIT_COPY);
+    /// Colour image reduced to 1 bit by luminance; keyed pixels are left alone
+    void    drawImage    (int16_t x, int16_t y, const GFXimage &image,
+                          GFXdither dither = GFX_DITHER_ORDERED);
+    void    drawRGBBitmap(int16_t x, int16_t y, const uint16_t *pPixels, int16_t w, int16_t h,
+                          GFXdither dither = GFX_DITHER_ORDERED);
+
+    // ── Text (transparent background) ────────────────────────────────────────
+    void    setFont     (const GFXfont *pFont) { m_pFont = pFont; }
+    void    setCursor   (int16_t x, int16_t y) { m_cursorX = x; m_cursorY = y; }
+    int16_t getCursorX  () const { return m_cursorX; }
+    int16_t getCursorY  () const { return m_cursorY; }
+    void    setTextColor(uint8_t color) { m_textColor = color; }
+    /// One glyph with its origin at (x, y) (baseline for a GFXfont, top for
+    /// the built-in 5×8 font); returns the advance
+    int16_t drawChar    (int16_t x, int16_t y, uint32_t code, uint8_t color);
+    /// UTF-8 text at the cursor; '\n' starts a new line
+    void    writeText   (const char *pText);
+
+    // ── Damage and output ────────────────────────────────────────────────────
+    const GFXregion &getDamage  () const { return m_damage; }
+    void             clearDamage()       { m_damage.clear(); }
+    /**
+     * @brief Windows a partial refresh needs: the damage grown to the
+     *        alignment and merged, or its bounds if more than maxWindows
+     *        remain.
+     * @return Number of windows written to pOut
+     */
+    uint8_t getRefreshWindows(uint8_t alignX, uint8_t alignY, uint8_t maxWindows,
+                              GFXrect *pOut) const;
+    /**
+     * @brief Send the damaged windows (or the whole canvas) to a sink, then
+     *        clear the damage.
+     * @return Number of windows sent
+     */
+    uint8_t flush(GFXDisplaySink &sink, boolean bFull = false);
+
+private:
+    void     _plot  (int16_t x, int16_t y, uint8_t color);
+    void     _span  (int16_t x, int16_t y, int16_t w, uint8_t color);
+    void     _bits  (int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t *pSrc,
+                     int32_t rowBits, int32_t srcBytes, uint8_t color);
+    void     _damage(int16_t x, int16_t y, int16_t w, int16_t h);
+    void    *_grow  (void **ppBuf, size_t *pSize, size_t bytes);
+
+    uint8_t        *m_pData;
+    int16_t         m_width;
+    int16_t         m_height;
+    int32_t         m_stride;       ///< Bytes per row, a multiple of 4
+    const GFXfont  *m_pFont;
+    int16_t         m_cursorX;
+    int16_t         m_cursorY;
+    uint8_t         m_textColor;
+    GFXregion       m_damage;
+
+    void           *m_pScratch;     ///< Decoded image row and Floyd–Steinberg errors
+    size_t          m_scratchSize;
+    void           *m_pPages;       ///< Page-layout staging for flush()
+    size_t          m_pagesSize;
 };
 
 #endif // GFX_H
\ No newline at end of file
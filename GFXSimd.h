@@ -0,0 +1,83 @@
+#ifndef GFXSIMD_H
+#define GFXSIMD_H
+
+#include <cstdint>
+#include <cstring>
+
+// ─── Portable SIMD helpers ────────────────────────────────────────────────────
+// GCC generic vector types.  With the Circle tool-chains these lower to NEON
+// (always on AArch64, with -mfpu=neon on AArch32); on other targets GCC falls
+// back to whatever the host offers, so the kernels stay correct everywhere.
+// Internal header – only included by the CircleGFX translation units.
+// ─────────────────────────────────────────────────────────────────────────────
+
+typedef uint16_t gfx_u16x8 __attribute__((vector_size(16)));
+typedef int16_t  gfx_s16x8 __attribute__((vector_size(16)));
+typedef uint32_t gfx_u32x4 __attribute__((vector_size(16)));
+typedef uint32_t gfx_u32x8 __attribute__((vector_size(32)));
+typedef uint8_t  gfx_u8x8  __attribute__((vector_size(8)));
+typedef int32_t  gfx_s32x4 __attribute__((vector_size(16)));
+
+/// Unaligned load / store of 8 RGB565 pixels
+static inline gfx_u16x8 gfxLoad8(const uint16_t *p) {
+    gfx_u16x8 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void gfxStore8(uint16_t *p, gfx_u16x8 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+/// Unaligned load / store of 4 signed 32-bit lanes
+static inline gfx_s32x4 gfxLoadS32x4(const int32_t *p) {
+    gfx_s32x4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void gfxStoreS32x4(int32_t *p, gfx_s32x4 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+/// Load 8 bytes, zero-extended to signed 16-bit lanes
+static inline gfx_s16x8 gfxLoadU8x8(const uint8_t *p) {
+    gfx_u8x8 v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, gfx_s16x8);
+}
+
+/// Broadcast a scalar into all lanes
+static inline gfx_u16x8 gfxSplat8(uint16_t x) {
+    return (gfx_u16x8){x, x, x, x, x, x, x, x};
+}
+
+/// Clamp every lane into [lo, hi]
+static inline gfx_s16x8 gfxClamp8(gfx_s16x8 v, int16_t lo, int16_t hi) {
+    v = (v < lo) ? (gfx_s16x8){lo, lo, lo, lo, lo, lo, lo, lo} : v;
+    v = (v > hi) ? (gfx_s16x8){hi, hi, hi, hi, hi, hi, hi, hi} : v;
+    return v;
+}
+
+/// Blend one RGB565 pixel towards src by a (0..256)
+static inline uint16_t gfxBlend565(uint16_t d, uint16_t s, uint16_t a) {
+    int dr = d >> 11, dg = (d >> 5) & 0x3F, db = d & 0x1F;
+    int sr = s >> 11, sg = (s >> 5) & 0x3F, sb = s & 0x1F;
+    dr += ((sr - dr) * (int)a) >> 8;
+    dg += ((sg - dg) * (int)a) >> 8;
+    db += ((sb - db) * (int)a) >> 8;
+    return (uint16_t)((dr << 11) | (dg << 5) | db);
+}
+
+/// Blend 8 RGB565 pixels towards src by per-lane a (0..256)
+static inline gfx_u16x8 gfxBlend565x8(gfx_u16x8 d, gfx_u16x8 s, gfx_u16x8 a) {
+    gfx_s16x8 av = (gfx_s16x8)a;
+    gfx_s16x8 dr = (gfx_s16x8)(d >> 11), dg = (gfx_s16x8)((d >> 5) & 0x3F), db = (gfx_s16x8)(d & 0x1F);
+    gfx_s16x8 sr = (gfx_s16x8)(s >> 11), sg = (gfx_s16x8)((s >> 5) & 0x3F), sb = (gfx_s16x8)(s & 0x1F);
+    dr += ((sr - dr) * av) >> 8;
+    dg += ((sg - dg) * av) >> 8;
+    db += ((sb - db) * av) >> 8;
+    return (gfx_u16x8)((dr << 11) | (dg << 5) | db);
+}
+
+#endif // GFXSIMD_H
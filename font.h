@@ -140,7 +140,8 @@ const GFXfont B612MREG10pt = {
     (GFXglyph *)B612MREG10ptGlyphs,
     0x20,   // first codepoint
     0x7E,   // last  codepoint
-    12     // y advance (line height)
+    12,    // y advance (line height)
+    nullptr  // colour glyphs
 };
 
 // Approx. 1078 bytes
@@ -0,0 +1,278 @@
+#!/usr/bin/env python3
+"""
+gfxpack.py — Build and inspect CircleGFX asset packs (GFXAssetPack).
+
+A pack bundles fonts, SDF fonts, images, palettes, sprite atlases and raw
+blobs in one file that the target reads into memory and uses in place.
+
+Usage:
+    python3 gfxpack.py list <pack.bin>
+
+As a module:
+    from gfxpack import PackWriter
+    pack = PackWriter.load('assets.bin')         # or PackWriter()
+    pack.add_font('B612-10', bitmaps, glyphs, 0x20, 0x7E, y_advance)
+    pack.add_image('logo', w, h, 'rgb565', pixels)
+    pack.write('assets.bin')
+
+Layout (little-endian, every section aligned to 16 bytes):
+    header   u32 magic "GFXP", u16 version, u16 entries, u32 TOC offset,
+             u32 file size
+    sections see the add_* methods
+    TOC      entries of u32 name hash (FNV-1a), u16 type, u16 0,
+             u32 offset, u32 size — sorted by (hash, type)
+
+Names are only stored as hashes; two names with the same hash and type are
+rejected when the second one is added.
+"""
+
+import sys
+import struct
+
+MAGIC   = 0x50584647
+VERSION = 1
+ALIGN   = 16
+
+FONT, SDF_FONT, IMAGE, PALETTE, ATLAS, BLOB = 1, 2, 3, 4, 5, 6
+TYPE_NAMES = {FONT: 'font', SDF_FONT: 'sdf-font', IMAGE: 'image',
+              PALETTE: 'palette', ATLAS: 'atlas', BLOB: 'blob'}
+
+# GFXimageFormat
+FORMATS = {'rgb565': 0, 'index8': 1, 'index4': 2, 'a8': 3, 'mask1': 4,
+           'rle565': 5, 'rle8': 6}
+KEYED   = 0x01
+
+
+def fnv1a(name):
+    """32-bit FNV-1a of a UTF-8 name, matching GFXAssetPack::hash()."""
+    h = 0x811C9DC5
+    for b in name.encode('utf-8'):
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def _pad(data, align=4):
+    return data + b'\0' * (-len(data) % align)
+
+
+# ---------------------------------------------------------------------------
+# Pixel packing
+# ---------------------------------------------------------------------------
+
+def _rle_row(values):
+    """
+    Encode one row as packets: a control byte c < 128 is followed by c + 1
+    literal pixels, c >= 128 repeats the next pixel c - 127 times.
+    Returns a list of (control, [pixels]).
+    """
+    packets = []
+    literal = []
+    i, n = 0, len(values)
+    while i < n:
+        run = 1
+        while i + run < n and run < 128 and values[i + run] == values[i]:
+            run += 1
+        if run >= 3:
+            if literal:
+                packets.append((len(literal) - 1, literal))
+                literal = []
+            packets.append((127 + run, [values[i]]))
+            i += run
+            continue
+        literal.append(values[i])
+        i += 1
+        if len(literal) == 128:
+            packets.append((127, literal))
+            literal = []
+    if literal:
+        packets.append((len(literal) - 1, literal))
+    return packets
+
+
+def pack_pixels(w, h, fmt, pixels):
+    """
+    Pack a row-major list of w * h values (RGB565 colours, palette indices,
+    alpha bytes or 0/1 mask bits depending on fmt) into image data bytes.
+    """
+    if len(pixels) != w * h:
+        raise ValueError(f"expected {w * h} pixels, got {len(pixels)}")
+    out = bytearray()
+    rows = [pixels[y * w:(y + 1) * w] for y in range(h)]
+
+    if fmt == 'rgb565':
+        for row in rows:
+            out += struct.pack(f'<{w}H', *row)
+    elif fmt in ('index8', 'a8'):
+        for row in rows:
+            out += bytes(row)
+    elif fmt == 'index4':
+        for row in rows:
+            for x in range(0, w, 2):
+                hi = row[x] & 0x0F
+                lo = row[x + 1] & 0x0F if x + 1 < w else 0
+                out.append((hi << 4) | lo)
+    elif fmt == 'mask1':
+        for row in rows:
+            for x in range(0, w, 8):
+                b = 0
+                for i, v in enumerate(row[x:x + 8]):
+                    if v:
+                        b |= 0x80 >> i
+                out.append(b)
+    elif fmt in ('rle565', 'rle8'):
+        body = bytearray()
+        offsets = []
+        for row in rows:
+            offsets.append(4 * h + len(body))
+            for control, vals in _rle_row(row):
+                body.append(control)
+                if fmt == 'rle565':
+                    body += struct.pack(f'<{len(vals)}H', *vals)
+                else:
+                    body += bytes(vals)
+        out += struct.pack(f'<{h}I', *offsets) + body
+    else:
+        raise ValueError(f"unknown image format '{fmt}'")
+    return bytes(out)
+
+
+# ---------------------------------------------------------------------------
+# Writer
+# ---------------------------------------------------------------------------
+
+class PackWriter:
+    """Collects named assets and writes them as one pack."""
+
+    def __init__(self):
+        # (hash, type) -> (name, section bytes)
+        self.assets = {}
+
+    @classmethod
+    def load(cls, path):
+        """Read an existing pack so assets can be added or replaced."""
+        pack = cls()
+        with open(path, 'rb') as f:
+            data = f.read()
+        magic, version, count, toc, size = struct.unpack_from('<IHHII', data, 0)
+        if magic != MAGIC or version != VERSION or size != len(data):
+            raise ValueError(f"'{path}' is not a version {VERSION} asset pack")
+        for i in range(count):
+            h, t, _, off, n = struct.unpack_from('<IHHII', data, toc + 16 * i)
+            pack.assets[(h, t)] = (None, data[off:off + n])
+        return pack
+
+    def _add(self, name, kind, section):
+        key = (fnv1a(name), kind)
+        old = self.assets.get(key)
+        if old and old[0] not in (None, name):
+            raise ValueError(f"'{name}' and '{old[0]}' hash to the same value")
+        self.assets[key] = (name, bytes(section))
+
+    def add_font(self, name, bitmaps, glyphs, first, last, y_advance):
+        """
+        Add a GFXfont from render_font() output.  Section: u16 first,
+        u16 last, u8 yAdvance, 3 spare, u32 bitmap bytes, 4 spare, then one
+        8-byte GFXglyph per codepoint and the bitmaps.
+        """
+        sec = struct.pack('<HHB3xI4x', first, last, y_advance, len(bitmaps))
+        for g in glyphs:
+            sec += struct.pack('<HBBBbbx', *g[:6])
+        self._add(name, FONT, sec + bytes(bitmaps))
+
+    def add_sdf_font(self, name, fields, glyphs, first, last, y_advance, size, spread):
+        """
+        Add a GFXsdfFont from render_sdf_font() output.  Section: u16 first,
+        u16 last, u8 yAdvance, u8 size, u8 spread, 1 spare, u32 field bytes,
+        4 spare, then one 12-byte GFXsdfGlyph per codepoint and the fields.
+        """
+        sec = struct.pack('<HHBBBxI4x', first, last, y_advance, size, spread, len(fields))
+        for g in glyphs:
+            sec += struct.pack('<IBBBbbxxx', *g[:6])
+        self._add(name, SDF_FONT, sec + bytes(fields))
+
+    def add_image(self, name, w, h, fmt, pixels, palette=None, key=None):
+        """
+        Add a GFXimage.  pixels are w * h values for fmt (see pack_pixels());
+        palette is a list of RGB565 colours for the indexed formats and key
+        an optional transparent colour.  Section: u16 width, u16 height,
+        u8 format, u8 flags, u16 key, u16 palette entries, 2 spare, u32 data
+        bytes, then the palette (padded to 4 bytes) and the data.
+        """
+        palette = list(palette or [])
+        if fmt in ('index8', 'index4', 'rle8') and not palette:
+            raise ValueError(f"image '{name}': format '{fmt}' needs a palette")
+        if not (0 < w < 32768 and 0 < h < 32768):
+            raise ValueError(f"image '{name}': bad size {w}x{h}")
+        data  = pack_pixels(w, h, fmt, pixels)
+        flags = KEYED if key is not None else 0
+        sec   = struct.pack('<HHBBHH2xI', w, h, FORMATS[fmt], flags, key or 0,
+                            len(palette), len(data))
+        sec  += _pad(struct.pack(f'<{len(palette)}H', *palette))
+        self._add(name, IMAGE, sec + data)
+
+    def add_palette(self, name, colors):
+        """Add RGB565 colours.  Section: u16 entries, 2 spare, colours."""
+        self._add(name, PALETTE,
+                  struct.pack(f'<H2x{len(colors)}H', len(colors), *colors))
+
+    def add_atlas(self, name, image_name, frames):
+        """
+        Add named frames of an image added with add_image().  frames is a
+        list of (name, x, y, w, h, pivot_x, pivot_y).  Section: u32 image
+        name hash, u16 frames, 2 spare, then 16-byte GFXatlasFrames sorted
+        by name hash.
+        """
+        rows = sorted((fnv1a(f[0]),) + tuple(f[1:7]) for f in frames)
+        for a, b in zip(rows, rows[1:]):
+            if a[0] == b[0]:
+                raise ValueError(f"atlas '{name}': two frame names hash to 0x{a[0]:08X}")
+        sec = struct.pack('<IH2x', fnv1a(image_name), len(rows))
+        for r in rows:
+            sec += struct.pack('<I6h', *r)
+        self._add(name, ATLAS, sec)
+
+    def add_blob(self, name, data):
+        self._add(name, BLOB, data)
+
+    def build(self):
+        """Return the pack as bytes."""
+        body  = bytearray(b'\0' * ALIGN)            # header, filled in last
+        toc   = []
+        for (h, t) in sorted(self.assets):
+            sec = self.assets[(h, t)][1]
+            toc.append((h, t, len(body), len(sec)))
+            body += _pad(sec, ALIGN)
+        toc_offset = len(body)
+        for entry in toc:
+            body += struct.pack('<IHHII', entry[0], entry[1], 0, entry[2], entry[3])
+        struct.pack_into('<IHHII', body, 0, MAGIC, VERSION, len(toc),
+                         toc_offset, len(body))
+        return bytes(body)
+
+    def write(self, path):
+        data = self.build()
+        with open(path, 'wb') as f:
+            f.write(data)
+        return len(data)
+
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+
+def main():
+    if len(sys.argv) != 3 or sys.argv[1] != 'list':
+        print(__doc__.strip().split('\n\n')[1], file=sys.stderr)
+        sys.exit(1)
+    try:
+        pack = PackWriter.load(sys.argv[2])
+    except (OSError, ValueError, struct.error) as e:
+        print(f"ERROR: {e}", file=sys.stderr)
+        sys.exit(1)
+    for (h, t), (_, sec) in sorted(pack.assets.items()):
+        print(f"0x{h:08X}  {TYPE_NAMES.get(t, str(t)):8}  {len(sec):8} bytes")
+    print(f"{len(pack.assets)} assets", file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,534 @@
+#!/usr/bin/env python3
+"""
+png_to_gfx.py — Convert PNG images to CircleGFX GFXimage / GFXatlas data.
+
+Standard library only.
+
+Usage:
+    python3 png_to_gfx.py <image.png> [<image.png> ...] [options]
+
+Options:
+    -f, --format <fmt>        rgb565, index8, index4, a8, mask1, rle565 or rle8
+                                                                 (default: rgb565)
+    -d, --dither <mode>       none, ordered (4x4 Bayer) or fs (Floyd-Steinberg)
+                              when reducing to RGB565 or a palette (default: none)
+    -c, --colors <n>          Palette size for index8 / index4 / rle8
+                              (default: 256, at most 16 for index4)
+    --mask                    Also emit a 1-bit mask of each image as <name>_mask
+                              (opaque pixels set), e.g. for GFXcollider
+    --atlas                   Pack all images into one atlas named --name, with
+                              one frame per input named after the file
+    --atlas-width <px>        Maximum atlas width           (default: 512)
+    --padding <px>            Empty pixels between atlas frames (default: 1)
+    --pivot-center            Atlas frame pivots at the frame centre (default: top left)
+    -n, --name <identifier>   C identifier / pack name (default: derived from
+                              the file name; required with --atlas)
+    -o, --output <file>       Output header (default: stdout)
+    --pack <file>             Add the images to an asset pack (see gfxpack.py)
+                              instead of writing a header
+
+Examples:
+    python3 png_to_gfx.py logo.png -o logo.h
+    python3 png_to_gfx.py bg.png -f index8 -d fs -o bg.h
+    python3 png_to_gfx.py ship.png -f rle565 --mask --pack assets.bin
+    python3 png_to_gfx.py sprites/*.png --atlas -n Sprites -f rle8 -c 64 -o sprites.h
+
+Pixels with alpha below 128 are transparent.  Images that have any become
+keyed: an RGB565 colour the image does not use is picked as GFXimage.key
+(and gets its own palette slot in the indexed formats), so drawImage() and
+the RLE formats skip them without an alpha channel.  a8 stores the alpha
+channel (or the grey level of an opaque image); mask1 stores alpha >= 128
+(or grey >= 128).  PNG files must be 8-bit, non-interlaced.
+"""
+
+import sys
+import os
+import re
+import argparse
+import datetime
+import struct
+import zlib
+
+from gfxpack import PackWriter, FORMATS, fnv1a, pack_pixels
+
+
+# ---------------------------------------------------------------------------
+# Argument parsing
+# ---------------------------------------------------------------------------
+
+def safe_identifier(path):
+    """Derive a C-safe identifier from a filename."""
+    name = os.path.splitext(os.path.basename(path))[0]
+    name = re.sub(r'[^A-Za-z0-9_]', '_', name)
+    if name and name[0].isdigit():
+        name = '_' + name
+    return name
+
+
+def parse_args():
+    p = argparse.ArgumentParser(
+        description='Convert PNG images to CircleGFX GFXimage / GFXatlas data.')
+    p.add_argument('images',         nargs='+',
+                   help='Input .png files')
+    p.add_argument('-f', '--format', choices=sorted(FORMATS), default='rgb565',
+                   help='Pixel format (default: rgb565)')
+    p.add_argument('-d', '--dither', choices=('none', 'ordered', 'fs'), default='none',
+                   help='Dithering when reducing colours (default: none)')
+    p.add_argument('-c', '--colors', type=int,            default=256,
+                   help='Palette size for indexed formats (default: 256)')
+    p.add_argument('--mask',         action='store_true',
+                   help='Also emit a 1-bit mask of each image as <name>_mask')
+    p.add_argument('--atlas',        action='store_true',
+                   help='Pack all images into one atlas')
+    p.add_argument('--atlas-width',  type=int,            default=512,
+                   help='Maximum atlas width (default: 512)')
+    p.add_argument('--padding',      type=int,            default=1,
+                   help='Pixels between atlas frames (default: 1)')
+    p.add_argument('--pivot-center', action='store_true',
+                   help='Put atlas frame pivots at the frame centre')
+    p.add_argument('-n', '--name',   type=str,            default=None,
+                   help='C identifier / pack name (default: derived from filename)')
+    p.add_argument('-o', '--output', type=str,            default=None,
+                   help='Output file path (default: stdout)')
+    p.add_argument('--pack',         type=str,            default=None,
+                   help='Add the images to this asset pack (created if missing)')
+    return p.parse_args()
+
+
+# ---------------------------------------------------------------------------
+# PNG decoding
+# ---------------------------------------------------------------------------
+
+def read_png(path):
+    """
+    Decode an 8-bit, non-interlaced PNG with zlib only.
+    Returns (width, height, pixels) with pixels a flat list of (r, g, b, a).
+    """
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('not a PNG file')
+
+    pos, idat, palette, trns = 8, b'', None, None
+    while pos < len(data):
+        length, ctype = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos  += 12 + length
+        if ctype == b'IHDR':
+            w, h, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif ctype == b'PLTE':
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, len(chunk), 3)]
+        elif ctype == b'tRNS':
+            trns = chunk
+        elif ctype == b'IDAT':
+            idat += chunk
+        elif ctype == b'IEND':
+            break
+    if depth != 8 or interlace:
+        raise ValueError('only 8-bit non-interlaced PNGs are supported')
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+
+    raw    = zlib.decompress(idat)
+    stride = w * channels
+    prev   = bytearray(stride)
+    pixels = []
+    for y in range(h):
+        ftype = raw[y * (stride + 1)]
+        line  = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                p  = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pr = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + pr) & 0xFF
+        prev = line
+        for x in range(w):
+            px = line[x * channels:(x + 1) * channels]
+            if color == 0:
+                pixels.append((px[0], px[0], px[0], 255))
+            elif color == 2:
+                pixels.append((px[0], px[1], px[2], 255))
+            elif color == 3:
+                r, g, b = palette[px[0]]
+                a = trns[px[0]] if trns and px[0] < len(trns) else 255
+                pixels.append((r, g, b, a))
+            elif color == 4:
+                pixels.append((px[0], px[0], px[0], px[1]))
+            else:
+                pixels.append(tuple(px))
+    return w, h, pixels
+
+
+# ---------------------------------------------------------------------------
+# Colour reduction
+# ---------------------------------------------------------------------------
+
+BAYER4 = [[0, 8, 2, 10], [12, 4, 14, 6], [3, 11, 1, 9], [15, 7, 13, 5]]
+
+
+def to565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def from565(c):
+    r, g, b = c >> 11, (c >> 5) & 0x3F, c & 0x1F
+    return (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)
+
+
+def pick_key(used):
+    """An RGB565 colour not in `used`, magenta first."""
+    for c in [0xF81F] + list(range(0x10000)):
+        if c not in used:
+            return c
+    raise ValueError('image uses every RGB565 colour; no colour key is free')
+
+
+def median_cut(colors, n):
+    """
+    Reduce a {(r, g, b): count} histogram to at most n colours by
+    repeatedly splitting the box with the widest channel at its median.
+    """
+    boxes = [list(colors.items())]
+    while len(boxes) < n:
+        best, axis, span = None, 0, 0
+        for i, box in enumerate(boxes):
+            if len(box) < 2:
+                continue
+            for a in range(3):
+                vals = [c[0][a] for c in box]
+                if max(vals) - min(vals) > span:
+                    best, axis, span = i, a, max(vals) - min(vals)
+        if best is None:
+            break
+        box = sorted(boxes.pop(best), key=lambda c: c[0][axis])
+        half, acc = sum(c[1] for c in box) / 2, 0
+        for cut in range(1, len(box)):
+            acc += box[cut - 1][1]
+            if acc >= half:
+                break
+        boxes += [box[:cut], box[cut:]]
+
+    palette = []
+    for box in boxes:
+        total = sum(c[1] for c in box)
+        palette.append(tuple((sum(c[0][a] * c[1] for c in box) + total // 2) // total
+                             for a in range(3)))
+    return palette
+
+
+def nearest(palette, r, g, b):
+    best, dist = 0, None
+    for i, (pr, pg, pb) in enumerate(palette):
+        d = 2 * (pr - r) ** 2 + 4 * (pg - g) ** 2 + 3 * (pb - b) ** 2
+        if dist is None or d < dist:
+            best, dist = i, d
+    return best
+
+
+def reduce_colors(w, h, pixels, dither, quantize, spread):
+    """
+    Map every opaque pixel through quantize((r, g, b)) -> (value, (r, g, b))
+    with optional dithering; transparent pixels (alpha < 128) map to None.
+    spread is the ordered-dither amplitude per channel.
+    """
+    out = [None] * (w * h)
+    err = [[0.0, 0.0, 0.0] for _ in range(w * h)] if dither == 'fs' else None
+    for y in range(h):
+        for x in range(w):
+            i = y * w + x
+            r, g, b, a = pixels[i]
+            if a < 128:
+                continue
+            v = [r, g, b]
+            if dither == 'ordered':
+                t = (BAYER4[y & 3][x & 3] + 0.5) / 16 - 0.5
+                v = [v[k] + t * spread[k] for k in range(3)]
+            elif dither == 'fs':
+                v = [v[k] + err[i][k] for k in range(3)]
+            v = [min(255, max(0, int(round(c)))) for c in v]
+            value, got = quantize(tuple(v))
+            out[i] = value
+            if dither == 'fs':
+                e = [v[k] - got[k] for k in range(3)]
+                for dx, dy, f in ((1, 0, 7), (-1, 1, 3), (0, 1, 5), (1, 1, 1)):
+                    if 0 <= x + dx < w and y + dy < h and pixels[i + dy * w + dx][3] >= 128:
+                        n = err[i + dy * w + dx]
+                        for k in range(3):
+                            n[k] += e[k] * f / 16
+    return out
+
+
+def convert(w, h, pixels, fmt, dither, ncolors):
+    """
+    Returns (values, palette, key): values ready for pack_pixels(), the
+    RGB565 palette of indexed formats and the colour key (or None).
+    """
+    transparent = any(p[3] < 128 for p in pixels)
+
+    if fmt in ('a8', 'mask1'):
+        if transparent or any(p[3] < 255 for p in pixels):
+            level = [p[3] for p in pixels]
+        else:
+            level = [(r * 77 + g * 150 + b * 29) >> 8 for (r, g, b, _) in pixels]
+        if fmt == 'mask1':
+            level = [1 if v >= 128 else 0 for v in level]
+        return level, None, None
+
+    if fmt in ('rgb565', 'rle565'):
+        cache = {}
+
+        def quantize(c):
+            if c not in cache:
+                v = to565(*c)
+                cache[c] = (v, from565(v))
+            return cache[c]
+
+        values = reduce_colors(w, h, pixels, dither, quantize, (8, 4, 8))
+        key = pick_key(set(values)) if transparent else None
+        return [key if v is None else v for v in values], None, key
+
+    limit = 16 if fmt == 'index4' else 256
+    if not 2 <= ncolors <= limit:
+        raise ValueError(f"--colors must be 2..{limit} for {fmt}")
+    if transparent:
+        ncolors -= 1                       # slot for the colour key
+    hist = {}
+    for (r, g, b, a) in pixels:
+        if a >= 128:
+            hist[(r, g, b)] = hist.get((r, g, b), 0) + 1
+    rgb = median_cut(hist, ncolors) if hist else [(0, 0, 0)]
+    cache = {}
+
+    def quantize(c):
+        if c not in cache:
+            i = nearest(rgb, *c)
+            cache[c] = (i, rgb[i])
+        return cache[c]
+
+    # Ordered dither over about half the spacing of the palette colours
+    spread  = 128 / len(rgb) ** (1 / 3)
+    values  = reduce_colors(w, h, pixels, dither, quantize, (spread,) * 3)
+    palette = [to565(*c) for c in rgb]
+    key = None
+    if transparent:
+        key = pick_key(set(palette))
+        values = [len(palette) if v is None else v for v in values]
+        palette.append(key)
+    return values, palette, key
+
+
+# ---------------------------------------------------------------------------
+# Atlas packing
+# ---------------------------------------------------------------------------
+
+def pack_atlas(sizes, max_width, padding):
+    """
+    Shelf-pack (w, h) rectangles, tallest first, into rows no wider than
+    max_width.  Returns (atlas_w, atlas_h, [(x, y)] in input order).
+    """
+    order = sorted(range(len(sizes)), key=lambda i: (-sizes[i][1], -sizes[i][0]))
+    pos = [None] * len(sizes)
+    x = y = shelf = width = 0
+    for i in order:
+        w, h = sizes[i]
+        if w > max_width:
+            raise ValueError(f"a {w}px wide frame does not fit --atlas-width {max_width}")
+        if x and x + w > max_width:
+            x, y, shelf = 0, y + shelf + padding, 0
+        pos[i] = (x, y)
+        x     += w + padding
+        shelf  = max(shelf, h)
+        width  = max(width, x - padding)
+    return width, y + shelf, pos
+
+
+def build_atlas(images, max_width, padding, pivot_center):
+    """
+    Blit the (name, w, h, pixels) images into one atlas.  Returns
+    (w, h, pixels, frames) with frames as gfxpack.PackWriter.add_atlas() takes.
+    """
+    aw, ah, pos = pack_atlas([(im[1], im[2]) for im in images], max_width, padding)
+    atlas  = [(0, 0, 0, 0)] * (aw * ah)
+    frames = []
+    for (name, w, h, px), (x0, y0) in zip(images, pos):
+        for y in range(h):
+            atlas[(y0 + y) * aw + x0:(y0 + y) * aw + x0 + w] = px[y * w:(y + 1) * w]
+        pivot = (w // 2, h // 2) if pivot_center else (0, 0)
+        frames.append((name, x0, y0, w, h) + pivot)
+    return aw, ah, atlas, frames
+
+
+# ---------------------------------------------------------------------------
+# C header generation
+# ---------------------------------------------------------------------------
+
+def hex_rows(values, width, cols):
+    return [f'    ' + ', '.join(f'0x{v:0{width}X}' for v in values[i:i + cols]) + ','
+            for i in range(0, len(values), cols)]
+
+
+def image_lines(name, w, h, fmt, values, palette, key):
+    """C arrays and the GFXimage initialiser (without declaration) of one image."""
+    data  = pack_pixels(w, h, fmt, values)
+    lines = []
+    if palette:
+        lines.append(f'const uint16_t {name}Palette[] = {{')
+        lines += hex_rows(palette, 4, 12)
+        lines.append('};')
+        lines.append('')
+    lines.append(f'const uint8_t {name}Data[] __attribute__((aligned(4))) = {{')
+    lines += hex_rows(list(data), 2, 16)
+    lines.append('};')
+    lines.append('')
+
+    stride = {'rgb565': w * 2, 'index8': w, 'a8': w,
+              'index4': (w + 1) // 2, 'mask1': (w + 7) // 8}.get(fmt, 0)
+    init = [
+        f'GFX_IMAGE_{fmt.upper()},',
+        f'{"GFX_IMAGE_KEYED" if key is not None else "0"},   // flags',
+        f'0x{key or 0:04X},   // colour key',
+        f'{w}, {h},   // width, height',
+        f'{stride},   // stride',
+        f'{name + "Palette" if palette else "nullptr"}, {len(palette or [])},',
+        f'{name}Data, sizeof({name}Data)',
+    ]
+    return lines, init, len(data) + 2 * len(palette or [])
+
+
+def generate_header(entries, atlas, sources, fmt):
+    """
+    entries are (name, w, h, values, palette, key, fmt) images; atlas is
+    (name, frames) to wrap the single entry in a GFXatlas, or None.
+    """
+    lines = []
+    now   = datetime.datetime.now().strftime('%Y-%m-%d %H:%M')
+    lines.append(f'#pragma once')
+    lines.append(f'#include "GFX.h"')
+    lines.append(f'')
+    lines.append(f'// Generated by png_to_gfx.py on {now}')
+    lines.append(f'// Source : {", ".join(os.path.basename(s) for s in sources)}')
+    lines.append(f'// Format : {fmt}')
+    lines.append(f'')
+
+    total = 0
+    for i, (name, w, h, values, palette, key, efmt) in enumerate(entries):
+        body, init, size = image_lines(name, w, h, efmt, values, palette, key)
+        total += size
+        lines.append(f'// ---- {name}: {w}x{h} {efmt}, {size} bytes')
+        lines += body
+        if atlas and i == 0:
+            aname, frames = atlas
+            rows = sorted((fnv1a(f[0]),) + tuple(f) for f in frames)
+            for j, r in enumerate(rows):
+                lines.append(f'#define {aname.upper()}_{safe_identifier(r[1]).upper()} {j}')
+            lines.append('')
+            lines.append(f'const GFXatlasFrame {aname}Frames[] = {{')
+            lines.append(f'    // hash, x, y, w, h, pivotX, pivotY')
+            for r in rows:
+                lines.append(f'    {{0x{r[0]:08X}, {r[2]:4d}, {r[3]:4d}, {r[4]:4d}, {r[5]:4d}, '
+                             f'{r[6]:4d}, {r[7]:4d}}},  // {r[1]}')
+            lines.append('};')
+            lines.append('')
+            lines.append(f'const GFXatlas {aname} = {{')
+            lines.append(f'    {{')
+            lines += [f'        {s}' for s in init]
+            lines.append(f'    }},')
+            lines.append(f'    {aname}Frames, {len(rows)}')
+            lines.append('};')
+            total += 16 * len(rows)
+        else:
+            lines.append(f'const GFXimage {name} = {{')
+            lines += [f'    {s}' for s in init]
+            lines.append('};')
+        lines.append('')
+    lines.append(f'// {total} bytes of image data')
+    lines.append('')
+    return '\n'.join(lines)
+
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+
+def main():
+    args = parse_args()
+
+    if args.pack and args.output:
+        print("ERROR: --pack cannot be combined with --output", file=sys.stderr)
+        sys.exit(1)
+    if args.atlas and not args.name:
+        print("ERROR: --atlas needs --name", file=sys.stderr)
+        sys.exit(1)
+    if args.name and len(args.images) > 1 and not args.atlas:
+        print("ERROR: --name only applies to a single image or an --atlas", file=sys.stderr)
+        sys.exit(1)
+
+    images = []
+    for path in args.images:
+        try:
+            w, h, px = read_png(path)
+        except (OSError, ValueError, KeyError, zlib.error) as e:
+            print(f"ERROR: reading '{path}': {e}", file=sys.stderr)
+            sys.exit(1)
+        name = args.name if args.name and not args.atlas else safe_identifier(path)
+        images.append((name, w, h, px))
+
+    atlas = None
+    if args.atlas:
+        try:
+            aw, ah, apx, frames = build_atlas(images, args.atlas_width, args.padding,
+                                              args.pivot_center)
+        except ValueError as e:
+            print(f"ERROR: {e}", file=sys.stderr)
+            sys.exit(1)
+        atlas  = (args.name, frames)
+        images = [(args.name + 'Image' if not args.pack else args.name, aw, ah, apx)]
+        print(f"Atlas '{args.name}': {len(frames)} frames in {aw}x{ah}", file=sys.stderr)
+
+    entries = []
+    try:
+        for (name, w, h, px) in images:
+            values, palette, key = convert(w, h, px, args.format, args.dither, args.colors)
+            entries.append((name, w, h, values, palette, key, args.format))
+            if args.mask:
+                mask, _, _ = convert(w, h, px, 'mask1', 'none', 0)
+                entries.append((name + '_mask', w, h, mask, None, None, 'mask1'))
+    except ValueError as e:
+        print(f"ERROR: {e}", file=sys.stderr)
+        sys.exit(1)
+
+    if args.pack:
+        try:
+            pack = PackWriter.load(args.pack) if os.path.isfile(args.pack) else PackWriter()
+            for (name, w, h, values, palette, key, efmt) in entries:
+                pack.add_image(name, w, h, efmt, values, palette, key)
+            if atlas:
+                pack.add_atlas(atlas[0], entries[0][0], atlas[1])
+            size = pack.write(args.pack)
+        except (OSError, ValueError, struct.error) as e:
+            print(f"ERROR: updating pack '{args.pack}': {e}", file=sys.stderr)
+            sys.exit(1)
+        print(f"Added {len(entries)} image(s) to '{args.pack}'  (pack {size} bytes)",
+              file=sys.stderr)
+        return
+
+    header = generate_header(entries, atlas, args.images, args.format)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(header)
+        print(f"Written to '{args.output}'  ({len(entries)} image(s))", file=sys.stderr)
+    else:
+        print(header)
+
+
+if __name__ == '__main__':
+    main()
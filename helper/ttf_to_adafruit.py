@@ -6,6 +6,7 @@ Requires: freetype-py  (pip install freetype-py)
 
 Usage:
     python3 ttf_to_adafruit.py <font.ttf> [options]
+    python3 ttf_to_adafruit.py --batch <fonts.json> [-j <n>] [--force]
 
 Options:
     -s, --size   <px>         Pixel height to render at         (default: 16)
@@ -13,11 +14,64 @@ Options:
     -l, --last   <code>       Last  Unicode codepoint to include (default: 0x7E)
     -n, --name   <identifier> C variable name prefix             (default: derived from filename)
     -o, --output <file>       Output file (default: stdout)
+    --sdf                     Emit a signed-distance-field GFXsdfFont instead;
+                              -s is then the base size the field is sampled at
+    --spread <px>             SDF: distance range in base pixels   (default: 4)
+    --upsample <n>            SDF: supersampling of the outline    (default: 8)
+    --icons <dir>             Add every *.png in <dir> as a colour glyph
+    --icon-first <code>       First icon codepoint                 (default: 0xE000)
+    --icon-descent <px>       Pixels icons extend below the baseline (default: 0)
+    --pack <file>             Add the font to an asset pack (see gfxpack.py)
+                              under --name instead of writing a header
+    --subset-text <text>      Only render the glyphs used in <text> (repeatable)
+    --subset-file <file>      Only render the glyphs used in <file> (repeatable):
+                              string and character literals of C/C++ sources,
+                              the whole text of any other file
+    --batch <manifest>        Build every font / size listed in a JSON manifest
+    -j, --jobs <n>            Batch: worker processes       (default: CPU count)
+    --force                   Batch: rebuild outputs even if their inputs are unchanged
 
 Examples:
     python3 ttf_to_adafruit.py MyFont.ttf -s 12
     python3 ttf_to_adafruit.py MyFont.ttf -s 24 -n MyFont24 -o MyFont24.h
     python3 ttf_to_adafruit.py MyFont.ttf -s 16 -f 0x20 -l 0xFF -o out.h
+    python3 ttf_to_adafruit.py MyFont.ttf -s 32 --sdf -n MyFontSdf -o MyFontSdf.h
+    python3 ttf_to_adafruit.py MyFont.ttf -s 16 --icons icons/ -o MyFont16.h
+    python3 ttf_to_adafruit.py MyFont.ttf -s 12 -n MyFont12 --pack assets.bin
+    python3 ttf_to_adafruit.py MyFont.ttf -s 64 --subset-text "0123456789.:%" -o Big.h
+    python3 ttf_to_adafruit.py MyFont.ttf -s 48 --subset-file ../src/dashboard.cpp -o Dash.h
+
+A batch manifest lists fonts with the same settings as the options above;
+paths are relative to the manifest and {size} in a name is replaced:
+
+    {
+      "output_dir": "fonts",
+      "pack":       "assets.bin",
+      "defaults":   {"first": "0x20", "last": "0x7E"},
+      "fonts": [
+        {"font": "B612Mono-Regular.ttf", "sizes": [8, 10, 12], "name": "B612M{size}"},
+        {"font": "Icons.ttf", "sizes": [16], "icons": "icons/"},
+        {"font": "Inter.ttf", "sizes": [32], "sdf": true, "spread": 6},
+        {"font": "Inter.ttf", "sizes": [96], "name": "Clock{size}",
+         "subset_text": ["0123456789:"], "subset_files": ["../src/clock.cpp"]}
+      ]
+    }
+
+Each font / size becomes {output_dir}/{name}.h, or an entry in "pack" when
+that is given (icons need header output).  Fonts render in parallel, and
+a hash of each job's inputs (font file, settings, icons and this script)
+is kept in <manifest>.cache so unchanged outputs are skipped.
+
+A subset keeps the glyph table contiguous, as GFXfont indexes it by code:
+the range shrinks to the first..last used codepoint, and unused codes in
+between become empty glyphs that still advance the cursor, costing one
+glyph entry but no bitmap.  The bytes saved are reported.
+
+Icons are assigned consecutive codepoints in file-name order, and for each
+one the header defines its codepoint and a UTF-8 string literal, e.g.
+NAME_ICON_WIFI "\\xEE\\x80\\x80", so it can be embedded in writeText() strings.
+PNG files must be 8-bit, non-interlaced (grey, grey+alpha, RGB, RGBA or
+palette); they are decoded with the standard library only.
 """
 
 import sys
@@ -25,6 +79,12 @@ import os
 import re
 import argparse
 import datetime
+import hashlib
+import json
+import multiprocessing
+import struct
+
+from png_to_gfx import read_png
 
 try:
     import freetype
@@ -54,7 +114,8 @@ def safe_identifier(path):
 def parse_args():
     p = argparse.ArgumentParser(
         description='Convert a TTF/OTF font file to an Adafruit GFX C font header.')
-    p.add_argument('font',           help='Path to .ttf or .otf font file')
+    p.add_argument('font',           nargs='?',
+                   help='Path to .ttf or .otf font file')
     p.add_argument('-s', '--size',   type=int,            default=16,
                    help='Render height in pixels (default: 16)')
     p.add_argument('-f', '--first',  type=parse_codepoint, default=0x20,
@@ -65,6 +126,30 @@ def parse_args():
                    help='C identifier prefix (default: derived from filename)')
     p.add_argument('-o', '--output', type=str,            default=None,
                    help='Output file path (default: stdout)')
+    p.add_argument('--sdf',          action='store_true',
+                   help='Emit a signed-distance-field font (GFXsdfFont)')
+    p.add_argument('--spread',       type=int,            default=4,
+                   help='SDF distance range in base pixels (default: 4)')
+    p.add_argument('--upsample',     type=int,            default=8,
+                   help='SDF outline supersampling factor (default: 8)')
+    p.add_argument('--icons',        type=str,            default=None,
+                   help='Directory of PNG icons to add as colour glyphs')
+    p.add_argument('--icon-first',   type=parse_codepoint, default=0xE000,
+                   help='First icon codepoint (default: 0xE000, private use)')
+    p.add_argument('--icon-descent', type=int,            default=0,
+                   help='Pixels icons extend below the baseline (default: 0)')
+    p.add_argument('--pack',         type=str,            default=None,
+                   help='Add the font to this asset pack (created if missing)')
+    p.add_argument('--subset-text',  type=str,            action='append', default=[],
+                   help='Only render glyphs used in this text (repeatable)')
+    p.add_argument('--subset-file',  type=str,            action='append', default=[],
+                   help='Only render glyphs used in this file (repeatable)')
+    p.add_argument('--batch',        type=str,            default=None,
+                   help='Build every font listed in a JSON manifest')
+    p.add_argument('-j', '--jobs',   type=int,            default=None,
+                   help='Batch worker processes (default: CPU count)')
+    p.add_argument('--force',        action='store_true',
+                   help='Batch: rebuild even unchanged outputs')
     return p.parse_args()
 
 
@@ -72,10 +157,29 @@ def parse_args():
 # Rendering
 # ---------------------------------------------------------------------------
 
-def render_font(font_path, size_px, first_code, last_code):
+def pack_mono(buffer, pitch, w, h):
     """
-    Render all codepoints in [first_code, last_code] using FreeType in
-    monochrome mode and return:
+    Pack a FreeType MONO bitmap (rows `pitch` bytes apart, MSB-first, only
+    the first w bits of a row valid) into w*h bits, MSB-first, without row
+    padding.  Each row is handled as one integer rather than bit by bit.
+    """
+    if not w or not h:
+        return []
+    row_bytes = (w + 7) >> 3
+    data      = bytes(buffer)
+    acc       = 0
+    for row in range(h):
+        bits = int.from_bytes(data[row * pitch:row * pitch + row_bytes], 'big')
+        acc  = (acc << w) | (bits >> (row_bytes * 8 - w))
+    total = w * h
+    acc <<= -total % 8                           # flush remaining bits
+    return list(acc.to_bytes((total + 7) >> 3, 'big'))
+
+
+def render_font(font_path, size_px, first_code, last_code, keep=None):
+    """
+    Render all codepoints in [first_code, last_code] (only those in the set
+    `keep`, if given) using FreeType in monochrome mode and return:
         bitmaps  — flat list of uint8 values (Adafruit GFX compact format)
         glyphs   — list of (offset, w, h, xAdvance, xOffset, yOffset, code, char)
         y_advance — recommended line height in pixels
@@ -91,6 +195,7 @@ def render_font(font_path, size_px, first_code, last_code):
     bitmaps       = []
     glyphs        = []
     bitmap_offset = 0
+    space_advance = None
 
     for code in range(first_code, last_code + 1):
         # Check whether the font has a glyph for this codepoint
@@ -99,8 +204,15 @@ def render_font(font_path, size_px, first_code, last_code):
         if glyph_index == 0:
             # No glyph — emit a zero-size placeholder that still advances
             # the cursor so character indices stay correct.
-            face.load_char(ord(' '),
-                           freetype.FT_LOAD_RENDER | freetype.FT_LOAD_TARGET_MONO)
+            if space_advance is None:
+                face.load_char(ord(' '), freetype.FT_LOAD_TARGET_MONO)
+                space_advance = face.glyph.advance.x >> 6
+            glyphs.append((bitmap_offset, 0, 0, space_advance, 0, 0, code, chr(code)))
+            continue
+
+        if keep is not None and code not in keep:
+            # Not in the subset: keep the advance, drop the bitmap
+            face.load_glyph(glyph_index, freetype.FT_LOAD_TARGET_MONO)
             xa = face.glyph.advance.x >> 6
             glyphs.append((bitmap_offset, 0, 0, xa, 0, 0, code, chr(code)))
             continue
@@ -119,27 +231,7 @@ def render_font(font_path, size_px, first_code, last_code):
         yo = -slot.bitmap_top
         xa = slot.advance.x >> 6  # horizontal advance in pixels
 
-        # --- Pack w×h bits, MSB-first, into bytes (no row padding) ----------
-        # FreeType MONO bitmaps: each row is `pitch` bytes, bits are MSB-first,
-        # only the first `w` bits of each row are valid.
-        packed       = []
-        acc          = 0
-        bits_in_acc  = 0
-
-        for row in range(h):
-            for col in range(w):
-                byte_idx = row * bm.pitch + (col >> 3)
-                bit      = (bm.buffer[byte_idx] >> (7 - (col & 7))) & 1
-                acc      = (acc << 1) | bit
-                bits_in_acc += 1
-                if bits_in_acc == 8:
-                    packed.append(acc)
-                    acc         = 0
-                    bits_in_acc = 0
-
-        if bits_in_acc:                          # flush remaining bits
-            packed.append(acc << (8 - bits_in_acc))
-
+        packed = pack_mono(bm.buffer, bm.pitch, w, h)
         bitmaps.extend(packed)
         glyphs.append((bitmap_offset, w, h, xa, xo, yo, code, chr(code)))
         bitmap_offset += len(packed)
@@ -147,12 +239,224 @@ def render_font(font_path, size_px, first_code, last_code):
     return bitmaps, glyphs, y_advance
 
 
+# ---------------------------------------------------------------------------
+# Signed distance fields
+# ---------------------------------------------------------------------------
+
+INF = 1e20
+
+
+def edt_1d(f):
+    """
+    Squared Euclidean distance transform of a sampled function
+    (Felzenszwalb & Huttenlocher): d[q] = min_p (q - p)^2 + f[p].
+    """
+    n = len(f)
+    d = [0.0] * n
+    v = [0] * n
+    z = [0.0] * (n + 1)
+    k = 0
+    z[0], z[1] = -INF, INF
+    for q in range(1, n):
+        s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k])
+        while s <= z[k]:
+            k -= 1
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k])
+        k += 1
+        v[k] = q
+        z[k], z[k + 1] = s, INF
+    k = 0
+    for q in range(n):
+        while z[k + 1] < q:
+            k += 1
+        d[q] = (q - v[k]) ** 2 + f[v[k]]
+    return d
+
+
+def edt_2d(mask, w, h):
+    """Distance from every pixel to the nearest pixel where mask is true."""
+    grid = [0.0 if m else INF for m in mask]
+    for x in range(w):
+        col = edt_1d(grid[x::w])
+        for y in range(h):
+            grid[y * w + x] = col[y]
+    for y in range(h):
+        grid[y * w:(y + 1) * w] = edt_1d(grid[y * w:(y + 1) * w])
+    return [g ** 0.5 for g in grid]
+
+
+def render_sdf_font(font_path, size_px, first_code, last_code, spread, upsample,
+                    keep=None):
+    """
+    Render every codepoint at size_px * upsample, compute the signed distance
+    to the outline there, and sample it once per base pixel over the glyph
+    box grown by `spread` on each side.  Returns (fields, glyphs, y_advance)
+    with the same glyph tuple layout as render_font(); a field byte is
+    128 + distance * 127 / spread, inside positive.  Codepoints outside the
+    set `keep` (if given) get empty fields.
+    """
+    face = freetype.Face(font_path)
+    face.set_pixel_sizes(0, size_px * upsample)
+
+    y_advance = (face.size.height >> 6) // upsample
+    if y_advance == 0:
+        y_advance = size_px
+    if y_advance > 255:
+        raise ValueError(f'line height {y_advance} does not fit GFXsdfFont.yAdvance')
+
+    fields = []
+    glyphs = []
+    offset = 0
+    pad    = spread * upsample
+
+    for code in range(first_code, last_code + 1):
+        glyph_index = face.get_char_index(code)
+        if keep is not None and code not in keep:
+            face.load_glyph(glyph_index or face.get_char_index(ord(' ')),
+                            freetype.FT_LOAD_DEFAULT)
+            xa = (face.glyph.advance.x >> 6) // upsample
+            glyphs.append((offset, 0, 0, xa, 0, 0, code, chr(code)))
+            continue
+        face.load_glyph(glyph_index or face.get_char_index(ord(' ')),
+                        freetype.FT_LOAD_RENDER)
+        slot = face.glyph
+        bm   = slot.bitmap
+        xa   = (slot.advance.x >> 6) // upsample
+        if glyph_index == 0 or bm.width == 0 or bm.rows == 0:
+            glyphs.append((offset, 0, 0, xa, 0, 0, code, chr(code)))
+            continue
+
+        # Glyph box in base pixels relative to the pen, grown by the spread
+        left, top = slot.bitmap_left, -slot.bitmap_top
+        bx0 = left // upsample - spread
+        by0 = top // upsample - spread
+        bw  = -(-(left + bm.width) // upsample) + spread - bx0
+        bh  = -(-(top + bm.rows) // upsample) + spread - by0
+        if bw > 255 or bh > 255 or xa > 255 or not (-128 <= bx0 <= 127 and -128 <= by0 <= 127):
+            raise ValueError(f'glyph 0x{code:02X}: field {bw}x{bh} at ({bx0}, {by0}), '
+                             f'advance {xa} does not fit GFXsdfGlyph '
+                             f'(use a smaller size or spread)')
+
+        # Supersampled coverage with `pad` empty pixels around it
+        hw, hh = bm.width + 2 * pad, bm.rows + 2 * pad
+        inside = [False] * (hw * hh)
+        for row in range(bm.rows):
+            base = (row + pad) * hw + pad
+            for col in range(bm.width):
+                inside[base + col] = bm.buffer[row * bm.pitch + col] >= 128
+        to_inside  = edt_2d(inside, hw, hh)
+        to_outside = edt_2d([not m for m in inside], hw, hh)
+
+        # One sample at the centre of every base pixel of the box
+        field = []
+        for j in range(bh):
+            hy = int((by0 + j + 0.5) * upsample) - top + pad
+            hy = min(max(hy, 0), hh - 1)
+            for i in range(bw):
+                hx = int((bx0 + i + 0.5) * upsample) - left + pad
+                hx = min(max(hx, 0), hw - 1)
+                k  = hy * hw + hx
+                d  = (to_outside[k] - 0.5) if inside[k] else -(to_inside[k] - 0.5)
+                v  = int(round(128 + d / upsample * 127 / spread))
+                field.append(min(max(v, 0), 255))
+
+        fields.extend(field)
+        glyphs.append((offset, bw, bh, xa, bx0, by0, code, chr(code)))
+        offset += len(field)
+
+    return fields, glyphs, y_advance
+
+
+# ---------------------------------------------------------------------------
+# Colour glyphs (PNG icons)
+# ---------------------------------------------------------------------------
+
+def load_icons(icon_dir, descent):
+    """
+    Read every *.png in icon_dir (sorted by name) and return
+        pixels — flat list of RGB565 values
+        alpha  — flat list of A8 values (only icons with transparency)
+        icons  — list of (pixelOffset, alphaOffset, w, h, xAdvance, xOffset,
+                          yOffset, identifier); alphaOffset None when opaque
+    Icons sit on the baseline (minus `descent`) with one pixel of spacing.
+    """
+    pixels, alpha, icons = [], [], []
+    for fname in sorted(os.listdir(icon_dir)):
+        if not fname.lower().endswith('.png'):
+            continue
+        w, h, px = read_png(os.path.join(icon_dir, fname))
+        # GFXcolorGlyph: u8 width, height and xAdvance (w + 1), s8 yOffset
+        if w > 254 or h > 255:
+            raise ValueError(f'{fname}: icons are limited to 254x255 pixels')
+        if not -128 <= descent - h <= 127:
+            raise ValueError(f'{fname}: yOffset {descent - h} (descent {descent} minus '
+                             f'height {h}) does not fit GFXcolorGlyph')
+        opaque = all(a == 255 for (_, _, _, a) in px)
+        poff   = len(pixels)
+        aoff   = None if opaque else len(alpha)
+        for (r, g, b, a) in px:
+            pixels.append(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3))
+            if not opaque:
+                alpha.append(a)
+        ident = safe_identifier(fname).upper()
+        icons.append((poff, aoff, w, h, w + 1, 0, descent - h, ident))
+    return pixels, alpha, icons
+
+
+def utf8_literal(code):
+    return ''.join(f'\\x{b:02X}' for b in chr(code).encode('utf-8'))
+
+
+def generate_icons(pixels, alpha, icons, name, icon_first):
+    """C arrays for a GFXcolorGlyphs set named {name}Icons."""
+    lines = []
+    lines.append(f'// ---- Colour glyphs: U+{icon_first:04X} to U+{icon_first + len(icons) - 1:04X}')
+    for i, icon in enumerate(icons):
+        code  = icon_first + i
+        macro = f'{name.upper()}_ICON_{icon[7]}'
+        lines.append(f'#define {macro}_CODE 0x{code:04X}')
+        lines.append(f'#define {macro} "{utf8_literal(code)}"')
+    lines.append('')
+
+    lines.append(f'const uint16_t {name}IconPixels[] = {{')
+    COLS = 12
+    for i in range(0, len(pixels), COLS):
+        lines.append('    ' + ', '.join(f'0x{v:04X}' for v in pixels[i:i + COLS]) + ',')
+    lines.append('};')
+    lines.append('')
+    if alpha:
+        lines.append(f'const uint8_t {name}IconAlpha[] = {{')
+        COLS = 16
+        for i in range(0, len(alpha), COLS):
+            lines.append('    ' + ', '.join(f'0x{v:02X}' for v in alpha[i:i + COLS]) + ',')
+        lines.append('};')
+        lines.append('')
+
+    lines.append(f'const GFXcolorGlyph {name}IconGlyphs[] = {{')
+    lines.append(f'    // pixelOffset, alphaOffset, width, height, xAdvance, xOffset, yOffset')
+    for (poff, aoff, w, h, xa, xo, yo, ident) in icons:
+        a = 'GFX_GLYPH_OPAQUE' if aoff is None else f'{aoff}'
+        lines.append(f'    {{{poff:6d}, {a:>16}, {w:3d}, {h:3d}, {xa:3d}, {xo:4d}, {yo:4d}}},  // {ident}')
+    lines.append('};')
+    lines.append('')
+
+    lines.append(f'const GFXcolorGlyphs {name}Icons = {{')
+    lines.append(f'    (uint16_t      *){name}IconPixels,')
+    lines.append(f'    (uint8_t       *){name + "IconAlpha" if alpha else "nullptr"},')
+    lines.append(f'    (GFXcolorGlyph *){name}IconGlyphs,')
+    lines.append(f'    0x{icon_first:04X},   // first codepoint')
+    lines.append(f'    0x{icon_first + len(icons) - 1:04X}    // last  codepoint')
+    lines.append('};')
+    lines.append('')
+    return lines
+
+
 # ---------------------------------------------------------------------------
 # C header generation
 # ---------------------------------------------------------------------------
 
 def generate_header(bitmaps, glyphs, y_advance, name, first_code, last_code,
-                    font_path, size_px):
+                    font_path, size_px, icons=None, icon_first=0xE000):
     lines = []
     now   = datetime.datetime.now().strftime('%Y-%m-%d %H:%M')
 
@@ -193,14 +497,76 @@ def generate_header(bitmaps, glyphs, y_advance, name, first_code, last_code,
     lines.append('};')
     lines.append('')
 
-    # ---- Font struct ---------------------------------------------------------
+    # ---- Colour glyphs -------------------------------------------------------
     total_bytes = len(bitmaps) + len(glyphs) * 7 + 6  # rough estimate
+    if icons and icons[2]:
+        pixels, alpha, icon_list = icons
+        lines.extend(generate_icons(pixels, alpha, icon_list, name, icon_first))
+        total_bytes += len(pixels) * 2 + len(alpha) + len(icon_list) * 13 + 16
+
+    # ---- Font struct ---------------------------------------------------------
+    color = f'(GFXcolorGlyphs *)&{name}Icons' if icons and icons[2] else 'nullptr'
     lines.append(f'const GFXfont {name} = {{')
     lines.append(f'    (uint8_t  *){name}Bitmaps,')
     lines.append(f'    (GFXglyph *){name}Glyphs,')
     lines.append(f'    0x{first_code:02X},   // first codepoint')
     lines.append(f'    0x{last_code:02X},   // last  codepoint')
-    lines.append(f'    {y_advance}     // y advance (line height)')
+    lines.append(f'    {y_advance},    // y advance (line height)')
+    lines.append(f'    {color}  // colour glyphs')
+    lines.append('};')
+    lines.append('')
+    lines.append(f'// Approx. {total_bytes} bytes')
+    lines.append('')
+
+    return '\n'.join(lines)
+
+
+def generate_sdf_header(fields, glyphs, y_advance, name, first_code, last_code,
+                        font_path, size_px, spread):
+    lines = []
+    now   = datetime.datetime.now().strftime('%Y-%m-%d %H:%M')
+
+    lines.append(f'#pragma once')
+    lines.append(f'#include "GFX.h"')
+    lines.append(f'')
+    lines.append(f'// {name} signed-distance-field font')
+    lines.append(f'// Generated by ttf_to_adafruit.py --sdf on {now}')
+    lines.append(f'// Source : {os.path.basename(font_path)}')
+    lines.append(f'// Base   : {size_px}px, spread {spread}px')
+    lines.append(f'// Range  : 0x{first_code:02X} ({chr(first_code)}) to 0x{last_code:02X} ({chr(last_code)})')
+    lines.append(f'')
+
+    # ---- Field array --------------------------------------------------------
+    lines.append(f'const uint8_t {name}Sdf[] = {{')
+    COLS = 16
+    for i in range(0, len(fields), COLS):
+        chunk = fields[i:i + COLS]
+        lines.append('    ' + ', '.join(f'0x{b:02X}' for b in chunk) + ',')
+    lines.append('};')
+    lines.append('')
+
+    # ---- Glyph array --------------------------------------------------------
+    lines.append(f'const GFXsdfGlyph {name}Glyphs[] = {{')
+    lines.append(f'    // sdfOffset, width, height, xAdvance, xOffset, yOffset')
+    for (offset, w, h, xa, xo, yo, code, ch) in glyphs:
+        safe_ch = repr(ch) if (0x20 <= code <= 0x7E) else f'U+{code:04X}'
+        lines.append(
+            f'    {{{offset:6d}, {w:3d}, {h:3d}, {xa:3d}, {xo:4d}, {yo:4d}}},'
+            f'  // 0x{code:02X} {safe_ch}'
+        )
+    lines.append('};')
+    lines.append('')
+
+    # ---- Font struct ---------------------------------------------------------
+    total_bytes = len(fields) + len(glyphs) * 9 + 12  # rough estimate
+    lines.append(f'const GFXsdfFont {name} = {{')
+    lines.append(f'    (uint8_t     *){name}Sdf,')
+    lines.append(f'    (GFXsdfGlyph *){name}Glyphs,')
+    lines.append(f'    0x{first_code:02X},   // first codepoint')
+    lines.append(f'    0x{last_code:02X},   // last  codepoint')
+    lines.append(f'    {y_advance},     // y advance at the base size')
+    lines.append(f'    {size_px},     // base size')
+    lines.append(f'    {spread}      // spread')
     lines.append('};')
     lines.append('')
     lines.append(f'// Approx. {total_bytes} bytes')
@@ -209,6 +575,374 @@ def generate_header(bitmaps, glyphs, y_advance, name, first_code, last_code,
     return '\n'.join(lines)
 
 
+# ---------------------------------------------------------------------------
+# Subsetting
+# ---------------------------------------------------------------------------
+
+C_SOURCES    = ('.c', '.cc', '.cpp', '.cxx', '.h', '.hh', '.hpp', '.ino')
+# One left-to-right pass over C source: comments, numbers (whose digit
+# separators look like quotes), character and string literals, in the order
+# they start, so a quote inside one of them never opens another
+C_TOKEN      = re.compile(r"//[^\n]*|/\*.*?(?:\*/|$)|(?<![\w.])\d[\w.']*"
+                          r"|'((?:[^'\\\n]|\\.)*)'"
+                          r'|"((?:[^"\\\n]|\\.)*)"', re.S)
+C_ESCAPES    = {'n': 10, 't': 9, 'r': 13, 'a': 7, 'b': 8, 'f': 12, 'v': 11, 'e': 27}
+
+
+def c_unescape(body):
+    """Bytes of the body of a C string literal (escapes resolved)."""
+    out = bytearray()
+    i   = 0
+    while i < len(body):
+        ch = body[i]
+        if ch != '\\' or i + 1 == len(body):
+            out += ch.encode('utf-8')
+            i   += 1
+            continue
+        nxt = body[i + 1]
+        if nxt == 'x':
+            m = re.match(r'[0-9A-Fa-f]+', body[i + 2:])
+            if m:
+                out.append(int(m.group(0), 16) & 0xFF)
+            i += 2 + (len(m.group(0)) if m else 0)
+        elif nxt in '01234567':
+            m = re.match(r'[0-7]{1,3}', body[i + 1:])
+            out.append(int(m.group(0), 8) & 0xFF)
+            i += 1 + len(m.group(0))
+        elif nxt in 'uU':
+            n = 4 if nxt == 'u' else 8
+            try:
+                out += chr(int(body[i + 2:i + 2 + n], 16)).encode('utf-8')
+            except ValueError:
+                pass
+            i += 2 + n
+        else:
+            out.append(C_ESCAPES.get(nxt, ord(nxt) if ord(nxt) < 128 else 0x3F))
+            i += 2
+    return bytes(out)
+
+
+def collect_codepoints(texts, files):
+    """
+    Codepoints used by the given strings and files.  In C sources only
+    string and character literals count, comments are skipped.  Adjacent
+    string literals are joined first, so UTF-8 sequences split across them
+    (as in "\\xEE\\x80" "\\x80") decode correctly.
+    """
+    codes = set()
+    for text in texts:
+        codes.update(map(ord, text))
+    for path in files:
+        with open(path, encoding='utf-8', errors='replace') as f:
+            src = f.read()
+        if not path.lower().endswith(C_SOURCES):
+            codes.update(map(ord, src))
+            continue
+        def flush():
+            codes.update(map(ord, run.decode('utf-8', errors='ignore')))
+
+        run, end = None, 0                  # adjacent string literals so far
+        for tok in C_TOKEN.finditer(src):
+            if run is not None and src[end:tok.start()].strip():
+                flush()
+                run = None
+            if tok.group(0).startswith(('//', '/*')):
+                end = tok.end()             # comments may sit between literals
+            elif tok.group(2) is not None:
+                run = (run or b'') + c_unescape(tok.group(2))
+                end = tok.end()
+            else:
+                if run is not None:
+                    flush()
+                    run = None
+                if tok.group(1) is not None:
+                    codes.update(map(ord, c_unescape(tok.group(1)).decode('utf-8',
+                                                                          errors='ignore')))
+        if run is not None:
+            flush()
+    return codes
+
+
+def subset_range(keep, first_code, last_code):
+    """The narrowest range inside [first_code, last_code] covering keep."""
+    used = [c for c in keep if first_code <= c <= last_code]
+    if not used:
+        raise ValueError(f'no subset character lies in 0x{first_code:02X}–0x{last_code:02X}')
+    return min(used), max(used)
+
+
+def dropped_bytes(font_path, size_px, codes, sdf, spread, upsample):
+    """
+    Approximate bitmap / field bytes the given codepoints would take, from
+    the glyph metrics (no rendering).
+    """
+    scale = upsample if sdf else 1
+    face  = freetype.Face(font_path)
+    face.set_pixel_sizes(0, size_px * scale)
+    total = 0
+    for code in codes:
+        glyph_index = face.get_char_index(code)
+        if glyph_index == 0:
+            continue
+        face.load_glyph(glyph_index, freetype.FT_LOAD_DEFAULT)
+        m = face.glyph.metrics
+        w = -(-m.width // (64 * scale))
+        h = -(-m.height // (64 * scale))
+        if not w or not h:
+            continue
+        total += (w + 2 * spread) * (h + 2 * spread) if sdf else (w * h + 7) >> 3
+    return total
+
+
+def subset_savings(font_path, size_px, keep, full, bitmaps, glyphs, sdf, spread, upsample):
+    """
+    Measure a subset against the full range.  Returns (glyphs kept, glyphs
+    in the full range, subset bytes, bytes saved).
+    """
+    codes   = set(range(full[0], full[1] + 1))
+    dropped = codes - (keep & codes)
+    entry   = 12 if sdf else 8
+    size    = len(bitmaps) + len(glyphs) * entry
+    saved   = (dropped_bytes(font_path, size_px, dropped, sdf, spread, upsample) +
+               (len(codes) - len(glyphs)) * entry)
+    return len(codes) - len(dropped), len(codes), size, saved
+
+
+def report_subset(subset, savings, label='Subset'):
+    """Print how much the subset saves over the full range."""
+    kept, total, size, saved = savings
+    print(f"{label}: {kept} of {total} glyphs, "
+          f"0x{subset[0]:02X}–0x{subset[1]:02X}, {size} bytes; "
+          f"saves about {saved} bytes ({100 * saved // max(1, size + saved)}%)",
+          file=sys.stderr)
+
+
+# ---------------------------------------------------------------------------
+# Asset pack output
+# ---------------------------------------------------------------------------
+
+def write_pack(path, name, bitmaps, glyphs, y_advance, args):
+    """Add (or replace) the font in the pack at path, creating it if needed."""
+    sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+    from gfxpack import PackWriter
+
+    try:
+        pack = PackWriter.load(path) if os.path.isfile(path) else PackWriter()
+        if args.sdf:
+            pack.add_sdf_font(name, bitmaps, glyphs, args.first, args.last,
+                              y_advance, args.size, args.spread)
+        else:
+            pack.add_font(name, bitmaps, glyphs, args.first, args.last, y_advance)
+        size = pack.write(path)
+    except (OSError, ValueError, struct.error) as e:
+        print(f"ERROR: updating pack '{path}': {e}", file=sys.stderr)
+        sys.exit(1)
+    print(f"Added '{name}' to '{path}'  "
+          f"({len(bitmaps)} bitmap bytes, {len(glyphs)} glyphs, pack {size} bytes)",
+          file=sys.stderr)
+
+
+# ---------------------------------------------------------------------------
+# Batch build
+# ---------------------------------------------------------------------------
+
+def file_digest(path):
+    with open(path, 'rb') as f:
+        return hashlib.sha256(f.read()).hexdigest()
+
+
+def load_manifest(path):
+    """
+    Expand a manifest into one job dict per font / size, with paths made
+    absolute and a content hash of everything the output depends on.
+    """
+    with open(path) as f:
+        manifest = json.load(f)
+    base     = os.path.dirname(os.path.abspath(path))
+    out_dir  = os.path.join(base, manifest.get('output_dir', '.'))
+    pack     = manifest.get('pack')
+    defaults = {'first': 0x20, 'last': 0x7E, 'sdf': False, 'spread': 4, 'upsample': 8,
+                'icons': None, 'icon_first': 0xE000, 'icon_descent': 0,
+                'subset_text': [], 'subset_files': []}
+    defaults.update(manifest.get('defaults', {}))
+    script = file_digest(os.path.abspath(__file__))
+
+    jobs, digests = [], {}
+    for entry in manifest['fonts']:
+        opts = dict(defaults, **entry)
+        font = os.path.join(base, opts['font'])
+        if font not in digests:
+            digests[font] = file_digest(font)
+        keep = None
+        if opts['subset_text'] or opts['subset_files']:
+            texts = opts['subset_text']
+            keep  = sorted(collect_codepoints(
+                [texts] if isinstance(texts, str) else texts,
+                [os.path.join(base, f) for f in opts['subset_files']]))
+        for size in opts.get('sizes', [opts.get('size', 16)]):
+            name = opts.get('name', safe_identifier(font) + '{size}').replace('{size}', str(size))
+            job  = {
+                'font':  font, 'size': size, 'name': name,
+                'first': parse_codepoint(str(opts['first'])),
+                'last':  parse_codepoint(str(opts['last'])),
+                'sdf':   bool(opts['sdf']), 'spread': opts['spread'], 'upsample': opts['upsample'],
+                'icons': os.path.join(base, opts['icons']) if opts['icons'] else None,
+                'icon_first':   parse_codepoint(str(opts['icon_first'])),
+                'icon_descent': opts['icon_descent'],
+                'output': None if pack else os.path.join(out_dir, name + '.h'),
+                'keep':  keep,
+            }
+            if job['first'] > job['last']:
+                raise ValueError(f"{name}: first must be <= last")
+            job['full'] = [job['first'], job['last']]
+            if keep is not None:
+                job['first'], job['last'] = subset_range(keep, job['first'], job['last'])
+            if job['icons'] and (job['sdf'] or pack):
+                raise ValueError(f"{name}: icons need a non-SDF font and header output")
+            h = hashlib.sha256(script.encode())
+            h.update(digests[font].encode())
+            h.update(json.dumps({k: v for k, v in job.items() if k != 'font'},
+                                sort_keys=True).encode())
+            if job['icons']:
+                for fname in sorted(os.listdir(job['icons'])):
+                    if fname.lower().endswith('.png'):
+                        h.update(fname.encode())
+                        h.update(file_digest(os.path.join(job['icons'], fname)).encode())
+            job['hash'] = h.hexdigest()
+            jobs.append(job)
+
+    names = [j['name'] for j in jobs]
+    if len(set(names)) != len(names):
+        raise ValueError('two manifest entries produce the same name')
+    return jobs, os.path.join(base, pack) if pack else None
+
+
+def build_job(job):
+    """
+    Render one font / size (in a worker process); returns (job, result,
+    subset savings or None).
+    """
+    keep = set(job['keep']) if job['keep'] is not None else None
+    if job['sdf']:
+        bitmaps, glyphs, y_advance = render_sdf_font(
+            job['font'], job['size'], job['first'], job['last'],
+            job['spread'], job['upsample'], keep)
+    else:
+        bitmaps, glyphs, y_advance = render_font(
+            job['font'], job['size'], job['first'], job['last'], keep)
+    savings = None
+    if keep is not None:
+        savings = subset_savings(job['font'], job['size'], keep, job['full'], bitmaps,
+                                 glyphs, job['sdf'], job['spread'], job['upsample'])
+
+    if not job['output']:
+        return job, (bitmaps, glyphs, y_advance), savings
+
+    if job['sdf']:
+        header = generate_sdf_header(
+            bitmaps, glyphs, y_advance, job['name'], job['first'], job['last'],
+            job['font'], job['size'], job['spread'])
+    else:
+        icons = load_icons(job['icons'], job['icon_descent']) if job['icons'] else None
+        header = generate_header(
+            bitmaps, glyphs, y_advance, job['name'], job['first'], job['last'],
+            job['font'], job['size'], icons, job['icon_first'])
+    os.makedirs(os.path.dirname(job['output']), exist_ok=True)
+    with open(job['output'], 'w') as f:
+        f.write(header)
+    return job, None, savings
+
+
+def run_batch(args):
+    try:
+        jobs, pack_path = load_manifest(args.batch)
+    except (OSError, ValueError, KeyError, TypeError) as e:
+        print(f"ERROR: reading manifest '{args.batch}': {e}", file=sys.stderr)
+        sys.exit(1)
+
+    cache_path = args.batch + '.cache'
+    cache = {}
+    if not args.force and os.path.isfile(cache_path):
+        with open(cache_path) as f:
+            cache = json.load(f)
+
+    def up_to_date(job):
+        if cache.get(job['name']) != job['hash']:
+            return False
+        return os.path.isfile(job['output'] or pack_path)
+
+    todo = [j for j in jobs if not up_to_date(j)]
+    print(f"{len(jobs)} fonts, {len(jobs) - len(todo)} up to date, "
+          f"building {len(todo)} ...", file=sys.stderr)
+    if not todo:
+        return
+
+    pack = None
+    if pack_path:
+        from gfxpack import PackWriter
+        try:
+            pack = PackWriter.load(pack_path) if os.path.isfile(pack_path) else PackWriter()
+        except (OSError, ValueError, struct.error) as e:
+            print(f"ERROR: reading pack '{pack_path}': {e}", file=sys.stderr)
+            sys.exit(1)
+
+    # The pack and the cache entries of the fonts in it are only written once
+    # every job has succeeded; headers that were written stay cached
+    workers = min(args.jobs or os.cpu_count() or 1, len(todo))
+    packed  = []
+    ok      = True
+    subset  = [0, 0, 0]                 # fonts, bytes, bytes saved
+    try:
+        with multiprocessing.Pool(workers) as pool:
+            for job, result, savings in pool.imap_unordered(build_job, todo):
+                if pack is not None:
+                    bitmaps, glyphs, y_advance = result
+                    if job['sdf']:
+                        pack.add_sdf_font(job['name'], bitmaps, glyphs, job['first'],
+                                          job['last'], y_advance, job['size'], job['spread'])
+                    else:
+                        pack.add_font(job['name'], bitmaps, glyphs, job['first'],
+                                      job['last'], y_advance)
+                    packed.append(job)
+                else:
+                    cache[job['name']] = job['hash']
+                print(f"  {job['name']}", file=sys.stderr)
+                if savings:
+                    report_subset((job['first'], job['last']), savings, '    subset')
+                    subset = [subset[0] + 1, subset[1] + savings[2], subset[2] + savings[3]]
+    except (OSError, ValueError, KeyError, struct.error,
+            freetype.ft_errors.FT_Exception) as e:
+        print(f"ERROR: {e}", file=sys.stderr)
+        ok = False
+
+    if subset[0] > 1:
+        print(f"Subsets: {subset[0]} fonts, {subset[1]} bytes; saves about "
+              f"{subset[2]} bytes ({100 * subset[2] // max(1, subset[1] + subset[2])}%)",
+              file=sys.stderr)
+
+    if ok and pack is not None:
+        tmp_path = pack_path + '.tmp'
+        try:
+            pack.write(tmp_path)
+            os.replace(tmp_path, pack_path)
+        except (OSError, ValueError, struct.error) as e:
+            print(f"ERROR: writing pack '{pack_path}': {e}", file=sys.stderr)
+            if os.path.exists(tmp_path):
+                os.remove(tmp_path)
+            ok = False
+        else:
+            for job in packed:
+                cache[job['name']] = job['hash']
+
+    try:
+        with open(cache_path, 'w') as f:
+            json.dump(cache, f, indent=1, sort_keys=True)
+    except OSError as e:
+        print(f"ERROR: writing cache '{cache_path}': {e}", file=sys.stderr)
+        ok = False
+    if not ok:
+        sys.exit(1)
+
 # ---------------------------------------------------------------------------
 # Main
 # ---------------------------------------------------------------------------
@@ -216,6 +950,13 @@ def generate_header(bitmaps, glyphs, y_advance, name, first_code, last_code,
 def main():
     args = parse_args()
 
+    if args.batch:
+        run_batch(args)
+        return
+    if not args.font:
+        print("ERROR: a font file or --batch is required", file=sys.stderr)
+        sys.exit(1)
+
     if not os.path.isfile(args.font):
         print(f"ERROR: Font file not found: {args.font}", file=sys.stderr)
         sys.exit(1)
@@ -224,6 +965,15 @@ def main():
         print("ERROR: --first must be <= --last", file=sys.stderr)
         sys.exit(1)
 
+    keep, full = None, (args.first, args.last)
+    if args.subset_text or args.subset_file:
+        try:
+            keep = collect_codepoints(args.subset_text, args.subset_file)
+            args.first, args.last = subset_range(keep, args.first, args.last)
+        except (OSError, ValueError) as e:
+            print(f"ERROR: subset: {e}", file=sys.stderr)
+            sys.exit(1)
+
     name = args.name if args.name else safe_identifier(args.font)
 
     print(f"Rendering '{os.path.basename(args.font)}' at {args.size}px, "
@@ -231,16 +981,57 @@ def main():
           f"name='{name}' ...",
           file=sys.stderr)
 
+    if args.pack and (args.icons or args.output):
+        print("ERROR: --pack cannot be combined with --icons or --output", file=sys.stderr)
+        sys.exit(1)
+
+    icons = None
+    if args.icons:
+        if args.sdf:
+            print("ERROR: --icons cannot be combined with --sdf", file=sys.stderr)
+            sys.exit(1)
+        try:
+            icons = load_icons(args.icons, args.icon_descent)
+        except (OSError, ValueError, KeyError) as e:
+            print(f"ERROR: reading icons from '{args.icons}': {e}", file=sys.stderr)
+            sys.exit(1)
+
+    if args.sdf and (args.spread < 1 or args.spread > 32 or args.upsample < 1):
+        print("ERROR: --spread must be 1..32 and --upsample >= 1", file=sys.stderr)
+        sys.exit(1)
+
     try:
-        bitmaps, glyphs, y_advance = render_font(
-            args.font, args.size, args.first, args.last)
+        if args.sdf:
+            bitmaps, glyphs, y_advance = render_sdf_font(
+                args.font, args.size, args.first, args.last,
+                args.spread, args.upsample, keep)
+        else:
+            bitmaps, glyphs, y_advance = render_font(
+                args.font, args.size, args.first, args.last, keep)
+        if keep is not None:
+            report_subset((args.first, args.last),
+                          subset_savings(args.font, args.size, keep, full, bitmaps, glyphs,
+                                         args.sdf, args.spread, args.upsample))
     except freetype.ft_errors.FT_Exception as e:
         print(f"ERROR: FreeType failed to load '{args.font}': {e}", file=sys.stderr)
         sys.exit(1)
+    except ValueError as e:
+        print(f"ERROR: {e}", file=sys.stderr)
+        sys.exit(1)
 
-    header = generate_header(
-        bitmaps, glyphs, y_advance, name,
-        args.first, args.last, args.font, args.size)
+    if args.pack:
+        write_pack(args.pack, name, bitmaps, glyphs, y_advance, args)
+        return
+
+    if args.sdf:
+        header = generate_sdf_header(
+            bitmaps, glyphs, y_advance, name,
+            args.first, args.last, args.font, args.size, args.spread)
+    else:
+        header = generate_header(
+            bitmaps, glyphs, y_advance, name,
+            args.first, args.last, args.font, args.size,
+            icons, args.icon_first)
 
     if args.output:
         with open(args.output, 'w') as f: